@@ -0,0 +1,318 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <string.h>
+#include "asyncbackend.hpp"
+#include "ledmgr_types.hpp"
+#include "eventrecorder.hpp"
+
+static void * io_thread(void *context)
+{
+	((asyncBackend *)context)->run();
+	return NULL;
+}
+
+static unsigned int latency_bucket(uint64_t duration_us)
+{
+	unsigned int bucket = 0;
+	uint64_t limit = 100;
+	while((HAL_LATENCY_BUCKETS - 1 > bucket) && (duration_us >= limit))
+	{
+		bucket++;
+		limit *= 10;
+	}
+	return bucket;
+}
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+asyncBackend::asyncBackend(ledBackend &backend) : m_backend(backend)
+{
+	m_thread_running = false;
+	m_stopping = false;
+	m_sequence = 0;
+	m_num_pending = 0;
+	m_num_handles = 0;
+	memset(m_mailboxes, 0, sizeof(m_mailboxes));
+	memset(&m_stats, 0, sizeof(m_stats));
+	REPORT_IF_UNEQUAL(0, pthread_mutex_init(&m_mutex, NULL));
+	REPORT_IF_UNEQUAL(0, pthread_cond_init(&m_cond, NULL));
+}
+
+/**
+ * @brief Stops the I/O thread once every pending write has been made.
+ */
+asyncBackend::~asyncBackend()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	m_stopping = true;
+	REPORT_IF_UNEQUAL(0, pthread_cond_signal(&m_cond));
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	if(m_thread_running)
+	{
+		REPORT_IF_UNEQUAL(0, pthread_join(m_thread, NULL));
+	}
+	pthread_cond_destroy(&m_cond);
+	pthread_mutex_destroy(&m_mutex);
+}
+
+/**
+ * @brief This API opens the indicator on the wrapped backend. The I/O thread is started with the first
+ * indicator, so nothing runs until there is something to drive.
+ *
+ * @param[in] name   indicator name.
+ *
+ * @return  Returns handle for the indicator or -1 on failure.
+ */
+int asyncBackend::open(const std::string &name)
+{
+	int handle = m_backend.open(name);
+	if((0 > handle) || (MAX_LED_HANDLES <= handle))
+	{
+		return -1;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	if(m_num_handles <= handle)
+	{
+		m_num_handles = handle + 1;
+	}
+	if(!m_thread_running)
+	{
+		if(0 == pthread_create(&m_thread, NULL, io_thread, this))
+		{
+			m_thread_running = true;
+		}
+		else
+		{
+			ERROR("Could not start the LED I/O thread!\n");
+			handle = -1;
+		}
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return handle;
+}
+
+/**
+ * @brief Enumeration and capabilities come from the wrapped backend, which finds them out once at
+ * startup; no I/O thread round trip is needed.
+ */
+int asyncBackend::listIndicators(std::vector<std::string> &names)
+{
+	return m_backend.listIndicators(names);
+}
+
+int asyncBackend::getCapabilities(int handle, ledCapabilities_t &capabilities)
+{
+	return m_backend.getCapabilities(handle, capabilities);
+}
+
+int asyncBackend::setState(int handle, bool enable)
+{
+	return post(handle, MAILBOX_STATE, (enable ? 1 : 0));
+}
+
+int asyncBackend::setBrightness(int handle, unsigned int intensity)
+{
+	return post(handle, MAILBOX_BRIGHTNESS, intensity);
+}
+
+int asyncBackend::getBrightness(int handle, unsigned int &intensity)
+{
+	return read(handle, MAILBOX_BRIGHTNESS, intensity);
+}
+
+int asyncBackend::setColor(int handle, unsigned int color)
+{
+	return post(handle, MAILBOX_COLOR, color);
+}
+
+int asyncBackend::getColor(int handle, unsigned int &color)
+{
+	return read(handle, MAILBOX_COLOR, color);
+}
+
+void asyncBackend::getStats(asyncBackendStats_t &stats)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	stats = m_stats;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+void asyncBackend::diagnostics()
+{
+	asyncBackendStats_t stats;
+	getStats(stats);
+	INFO("LED I/O: %llu writes requested, %llu made, %llu overwritten, %llu failed; max HAL call %u us\n",
+		stats.submitted, stats.written, stats.overwritten, stats.failed, stats.max_latency_us);
+	INFO("HAL call durations: <100us %llu, <1ms %llu, <10ms %llu, <100ms %llu, <1s %llu, >=1s %llu\n",
+		stats.latency[0], stats.latency[1], stats.latency[2], stats.latency[3], stats.latency[4], stats.latency[5]);
+}
+
+/**
+ * @brief Body of the I/O thread: makes the pending writes, oldest first, until the backend is destroyed.
+ */
+void asyncBackend::run()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	while(true)
+	{
+		int handle;
+		mailboxAttribute_t attribute;
+		unsigned int value;
+		if(!takeOldestLocked(handle, attribute, value))
+		{
+			if(m_stopping)
+			{
+				break;
+			}
+			REPORT_IF_UNEQUAL(0, pthread_cond_wait(&m_cond, &m_mutex));
+			continue;
+		}
+		REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+
+		uint64_t start_us = get_monotonic_time_us();
+		int ret;
+		switch(attribute)
+		{
+			case MAILBOX_STATE:
+				ret = m_backend.setState(handle, (0 != value));
+				break;
+			case MAILBOX_BRIGHTNESS:
+				ret = m_backend.setBrightness(handle, value);
+				break;
+			default:
+				ret = m_backend.setColor(handle, value);
+				break;
+		}
+		uint64_t duration_us = get_monotonic_time_us() - start_us;
+
+		REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+		m_stats.written++;
+		m_stats.latency[latency_bucket(duration_us)]++;
+		if(m_stats.max_latency_us < duration_us)
+		{
+			m_stats.max_latency_us = (unsigned int)duration_us;
+		}
+		if(0 != ret)
+		{
+			m_stats.failed++;
+			ERROR("Write %d to LED handle %d failed!\n", (int)attribute, handle);
+		}
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+int asyncBackend::post(int handle, mailboxAttribute_t attribute, unsigned int value)
+{
+	int ret = -1;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	if((0 <= handle) && (m_num_handles > handle))
+	{
+		ledMailbox_t &mailbox = m_mailboxes[handle];
+		m_stats.submitted++;
+		if(mailbox.pending[attribute])
+		{
+			m_stats.overwritten++;
+		}
+		else
+		{
+			mailbox.pending[attribute] = true;
+			m_num_pending++;
+		}
+		mailbox.known[attribute] = true;
+		mailbox.value[attribute] = value;
+		mailbox.sequence[attribute] = m_sequence++;
+		REPORT_IF_UNEQUAL(0, pthread_cond_signal(&m_cond));
+		ret = 0;
+	}
+	else
+	{
+		ERROR("Invalid handle %d!\n", handle);
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return ret;
+}
+
+/*Answers from the latest requested value, so a read never waits for the I/O thread. Only the first read
+ * of an attribute that was never written goes to the wrapped backend.*/
+int asyncBackend::read(int handle, mailboxAttribute_t attribute, unsigned int &value)
+{
+	if((0 > handle) || (MAX_LED_HANDLES <= handle))
+	{
+		ERROR("Invalid handle %d!\n", handle);
+		return -1;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	ledMailbox_t &mailbox = m_mailboxes[handle];
+	bool known = mailbox.known[attribute];
+	value = mailbox.value[attribute];
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	if(known)
+	{
+		return 0;
+	}
+
+	int ret = (MAILBOX_BRIGHTNESS == attribute) ? m_backend.getBrightness(handle, value) : m_backend.getColor(handle, value);
+	if(0 == ret)
+	{
+		REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+		if(!mailbox.known[attribute])
+		{
+			mailbox.known[attribute] = true;
+			mailbox.value[attribute] = value;
+		}
+		REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	}
+	return ret;
+}
+
+/*Picks the pending value submitted first and clears it from its mailbox. Called with m_mutex held.*/
+bool asyncBackend::takeOldestLocked(int &handle, mailboxAttribute_t &attribute, unsigned int &value)
+{
+	if(0 == m_num_pending)
+	{
+		return false;
+	}
+	ledMailbox_t *oldest = NULL;
+	int oldest_attribute = 0;
+	for(int i = 0; i < m_num_handles; i++)
+	{
+		ledMailbox_t &mailbox = m_mailboxes[i];
+		for(int j = 0; j < MAILBOX_ATTRIBUTES; j++)
+		{
+			/*Sequence numbers wrap; compare by distance.*/
+			if(mailbox.pending[j] && ((NULL == oldest) ||
+				(0 > (int)(mailbox.sequence[j] - oldest->sequence[oldest_attribute]))))
+			{
+				oldest = &mailbox;
+				oldest_attribute = j;
+				handle = i;
+			}
+		}
+	}
+	attribute = (mailboxAttribute_t)oldest_attribute;
+	value = oldest->value[oldest_attribute];
+	oldest->pending[oldest_attribute] = false;
+	m_num_pending--;
+	return true;
+}
+
+/** @} */  //END OF GROUP LED_APIS
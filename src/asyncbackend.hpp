@@ -0,0 +1,102 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef ASYNCBACKEND_H
+#define ASYNCBACKEND_H
+#include "ledbackend.hpp"
+#include "pthread.h"
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+#define HAL_LATENCY_BUCKETS 6	/**< <100us, <1ms, <10ms, <100ms, <1s, >=1s */
+
+typedef enum
+{
+	MAILBOX_STATE = 0,
+	MAILBOX_BRIGHTNESS,
+	MAILBOX_COLOR,
+	MAILBOX_ATTRIBUTES,
+}mailboxAttribute_t;
+
+typedef struct
+{
+	bool pending[MAILBOX_ATTRIBUTES];	/**< Value not yet handed to the wrapped backend */
+	bool known[MAILBOX_ATTRIBUTES];		/**< Value was written or read at least once */
+	unsigned int value[MAILBOX_ATTRIBUTES];	/**< Latest value requested */
+	unsigned int sequence[MAILBOX_ATTRIBUTES];	/**< Submission order of the pending values */
+}ledMailbox_t;
+
+typedef struct
+{
+	unsigned long long submitted;	/**< Writes requested by indicators */
+	unsigned long long written;	/**< Writes made to the wrapped backend */
+	unsigned long long overwritten;	/**< Writes replaced by a newer value before they were made */
+	unsigned long long failed;
+	unsigned long long latency[HAL_LATENCY_BUCKETS];	/**< Durations of the writes made */
+	unsigned int max_latency_us;
+}asyncBackendStats_t;
+
+/* @} */ // End of group LED_TYPES
+
+/*Moves hardware writes off the callers' threads. Each handle has one mailbox slot per attribute;
+ * a write only updates the slot and wakes the I/O thread, which replays the latest values in the order
+ * they were submitted. A newer value replaces an unsent older one, so a slow HAL never builds a backlog
+ * and indicator timing never waits on it. Reads are answered from the latest requested value.
+ *
+ * Write failures can only be reported by the I/O thread; they are logged and counted.*/
+class asyncBackend : public ledBackend
+{
+	private:
+		ledBackend &m_backend;
+		pthread_mutex_t m_mutex;
+		pthread_cond_t m_cond;
+		pthread_t m_thread;
+		bool m_thread_running;
+		bool m_stopping;
+		unsigned int m_sequence;
+		unsigned int m_num_pending;
+		int m_num_handles;
+		ledMailbox_t m_mailboxes[MAX_LED_HANDLES];
+		asyncBackendStats_t m_stats;
+
+		asyncBackend(const asyncBackend &);
+		asyncBackend& operator=(const asyncBackend &);
+
+	public:
+		asyncBackend(ledBackend &backend);
+		~asyncBackend();
+		virtual int open(const std::string &name);
+		virtual int setState(int handle, bool enable);
+		virtual int setBrightness(int handle, unsigned int intensity);
+		virtual int getBrightness(int handle, unsigned int &intensity);
+		virtual int setColor(int handle, unsigned int color);
+		virtual int getColor(int handle, unsigned int &color);
+		virtual void diagnostics();
+		virtual int listIndicators(std::vector<std::string> &names);
+		virtual int getCapabilities(int handle, ledCapabilities_t &capabilities);
+		void getStats(asyncBackendStats_t &stats);
+		void run();
+	private:
+		int post(int handle, mailboxAttribute_t attribute, unsigned int value);
+		int read(int handle, mailboxAttribute_t attribute, unsigned int &value);
+		bool takeOldestLocked(int &handle, mailboxAttribute_t &attribute, unsigned int &value);
+};
+
+#endif /*ASYNCBACKEND_H*/
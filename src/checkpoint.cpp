@@ -0,0 +1,167 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "checkpoint.hpp"
+
+static checkpointSegment_t *g_checkpoint = NULL;
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+/**
+ * @brief This API maps the checkpoint segment, creating it if needed. A segment left behind by a
+ * previous instance is kept if its header matches this build; anything else is wiped.
+ *
+ * @return  Returns 1 if the segment holds state to resume from, 0 if it is fresh, -1 on error.
+ */
+int open_checkpoint()
+{
+	if(NULL != g_checkpoint)
+	{
+		return 0;
+	}
+	int fd = shm_open(CHECKPOINT_SHM_NAME, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+	if(0 > fd)
+	{
+		ERROR("Could not open checkpoint segment!\n");
+		return -1;
+	}
+	struct stat info;
+	bool existing = ((0 == fstat(fd, &info)) && (sizeof(checkpointSegment_t) == (size_t)info.st_size));
+	if(!existing && (0 != ftruncate(fd, sizeof(checkpointSegment_t))))
+	{
+		ERROR("Could not size checkpoint segment!\n");
+		close(fd);
+		return -1;
+	}
+	void *mapping = mmap(NULL, sizeof(checkpointSegment_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(MAP_FAILED == mapping)
+	{
+		ERROR("Could not map checkpoint segment!\n");
+		return -1;
+	}
+	g_checkpoint = (checkpointSegment_t *)mapping;
+
+	if(existing && (CHECKPOINT_MAGIC == g_checkpoint->magic) && (CHECKPOINT_VERSION == g_checkpoint->version) &&
+		(sizeof(checkpointSegment_t) == g_checkpoint->size))
+	{
+		INFO("Found checkpoint from a previous instance.\n");
+		return 1;
+	}
+	memset(g_checkpoint, 0, sizeof(checkpointSegment_t));
+	g_checkpoint->version = CHECKPOINT_VERSION;
+	g_checkpoint->size = sizeof(checkpointSegment_t);
+	__atomic_store_n(&g_checkpoint->magic, CHECKPOINT_MAGIC, __ATOMIC_RELEASE);
+	return 0;
+}
+
+/**
+ * @brief This API unmaps the checkpoint segment.
+ *
+ * @param[in] discard   remove the segment as well, so the next instance starts afresh. Used on clean exit.
+ */
+void close_checkpoint(bool discard)
+{
+	if(NULL != g_checkpoint)
+	{
+		munmap(g_checkpoint, sizeof(checkpointSegment_t));
+		g_checkpoint = NULL;
+	}
+	if(discard)
+	{
+		shm_unlink(CHECKPOINT_SHM_NAME);
+	}
+}
+
+/**
+ * @brief This API returns the mapped checkpoint segment, or NULL if checkpointing is off.
+ */
+checkpointSegment_t * get_checkpoint()
+{
+	return g_checkpoint;
+}
+
+/**
+ * @brief This API returns the slot recorded for the named indicator, claiming a free one if there is none.
+ *
+ * @return  Returns the slot, or NULL if checkpointing is off or all slots are taken.
+ */
+checkpointSlot_t * claim_checkpoint_slot(const std::string &name)
+{
+	if(NULL == g_checkpoint)
+	{
+		return NULL;
+	}
+	checkpointSlot_t *free_slot = NULL;
+	for(unsigned int i = 0; i < MAX_INDICATORS; i++)
+	{
+		checkpointSlot_t *slot = &g_checkpoint->slots[i];
+		if(!slot->in_use)
+		{
+			if(NULL == free_slot)
+			{
+				free_slot = slot;
+			}
+		}
+		else if(0 == strncmp(slot->name, name.c_str(), CHECKPOINT_NAME_LENGTH))
+		{
+			return slot;
+		}
+	}
+	if(NULL != free_slot)
+	{
+		begin_checkpoint_update(&free_slot->generation);
+		strncpy(free_slot->name, name.c_str(), CHECKPOINT_NAME_LENGTH - 1);
+		free_slot->name[CHECKPOINT_NAME_LENGTH - 1] = '\0';
+		free_slot->active.state = STATE_STEADY_OFF;
+		free_slot->saved_valid = false;
+		free_slot->in_use = true;
+		end_checkpoint_update(&free_slot->generation);
+	}
+	return free_slot;
+}
+
+/**
+ * @brief Marks the start of an update. A crash before the matching end_checkpoint_update() leaves the
+ * generation odd, and the next instance ignores the record.
+ */
+void begin_checkpoint_update(uint32_t *generation)
+{
+	__atomic_store_n(generation, *generation | 0x01, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void end_checkpoint_update(uint32_t *generation)
+{
+	__atomic_store_n(generation, (*generation | 0x01) + 1, __ATOMIC_RELEASE);
+}
+
+bool is_checkpoint_consistent(const uint32_t *generation)
+{
+	return (0 == (__atomic_load_n(generation, __ATOMIC_ACQUIRE) & 0x01));
+}
+
+/** @} */  //END OF GROUP LED_APIS
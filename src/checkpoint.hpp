@@ -0,0 +1,93 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+#include <stdint.h>
+#include <string>
+#include "ledmgr_types.hpp"
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+#define CHECKPOINT_SHM_NAME "/ledmgr_checkpoint"	/**< Appears as /dev/shm/ledmgr_checkpoint */
+#define CHECKPOINT_MAGIC 0x4B43444C	/**< "LDCK" */
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_NAME_LENGTH 32
+
+typedef enum
+{
+	CHECKPOINT_PATTERN_NONE = 0,
+	CHECKPOINT_PATTERN_KEYFRAME,	/**< Pattern known to ledMgrBase by id */
+	CHECKPOINT_PATTERN_LEGACY,	/**< OEM-owned on/off pattern; cannot be looked up again */
+}checkpointPatternSource_t;
+
+/* One layer of logical indicator state. For a blinking layer the fields describe the keyframe that
+ * was being displayed, so the timeline can be walked forward from it.*/
+typedef struct
+{
+	uint8_t state;			/**< indicatorState_t */
+	uint8_t pattern_source;		/**< checkpointPatternSource_t */
+	uint16_t reserved;
+	uint32_t pattern_id;
+	uint32_t num_keyframes;		/**< Guards against an id that changed meaning across versions */
+	uint32_t sequence_offset;	/**< Keyframe being displayed */
+	int32_t repetitions;		/**< Repetitions left when that keyframe started, -1 for indefinite */
+	uint32_t intensity;		/**< Saved layer only */
+	uint32_t color;			/**< Saved layer only */
+	uint32_t reserved2;
+	uint64_t keyframe_start_us;	/**< CLOCK_MONOTONIC when that keyframe started */
+}checkpointLayer_t;
+
+typedef struct
+{
+	uint32_t generation;		/**< Odd while the slot is being written */
+	uint8_t in_use;
+	uint8_t saved_valid;
+	uint16_t reserved;
+	char name[CHECKPOINT_NAME_LENGTH];
+	checkpointLayer_t active;
+	checkpointLayer_t saved;	/**< Layer stashed by indicator::saveState() */
+}checkpointSlot_t;
+
+/* Fixed layout, host byte order. The segment lives on tmpfs, so it never outlives a reboot and
+ * CLOCK_MONOTONIC timestamps stay comparable across daemon restarts.*/
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t reserved;
+	uint32_t size;			/**< sizeof(checkpointSegment_t) */
+	uint32_t generation;		/**< Odd while the fields below are being written */
+	uint32_t error_flags;
+	int32_t power_state;
+	checkpointSlot_t slots[MAX_INDICATORS];
+}checkpointSegment_t;
+
+/* @} */ // End of group LED_TYPES
+
+int open_checkpoint();
+void close_checkpoint(bool discard);
+checkpointSegment_t * get_checkpoint();
+checkpointSlot_t * claim_checkpoint_slot(const std::string &name);
+void begin_checkpoint_update(uint32_t *generation);
+void end_checkpoint_update(uint32_t *generation);
+bool is_checkpoint_consistent(const uint32_t *generation);
+
+#endif /*CHECKPOINT_H*/
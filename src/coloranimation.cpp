@@ -0,0 +1,187 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <math.h>
+#include "ledmgr_types.hpp"
+#include "coloranimation.hpp"
+
+typedef struct
+{
+	double L;
+	double a;
+	double b;
+}labColor_t;
+
+static double srgb_to_linear(double c)
+{
+	return (c <= 0.04045) ? (c / 12.92) : pow((c + 0.055) / 1.055, 2.4);
+}
+
+static double linear_to_srgb(double c)
+{
+	c = (c < 0.0) ? 0.0 : ((c > 1.0) ? 1.0 : c);
+	return (c <= 0.0031308) ? (c * 12.92) : (1.055 * pow(c, 1.0 / 2.4) - 0.055);
+}
+
+/*OKLab conversions, see https://bottosson.github.io/posts/oklab/ */
+static labColor_t rgb_to_oklab(uint32_t color)
+{
+	double r = srgb_to_linear(((color >> 16) & 0xFF) / 255.0);
+	double g = srgb_to_linear(((color >> 8) & 0xFF) / 255.0);
+	double b = srgb_to_linear((color & 0xFF) / 255.0);
+
+	double l = cbrt(0.4122214708 * r + 0.5363325363 * g + 0.0514459929 * b);
+	double m = cbrt(0.2119034982 * r + 0.6806995451 * g + 0.1073969566 * b);
+	double s = cbrt(0.0883024619 * r + 0.2817188376 * g + 0.6299787005 * b);
+
+	labColor_t lab;
+	lab.L = 0.2104542553 * l + 0.7936177850 * m - 0.0040720468 * s;
+	lab.a = 1.9779984951 * l - 2.4285922050 * m + 0.4505937099 * s;
+	lab.b = 0.0259040371 * l + 0.7827717662 * m - 0.8086757660 * s;
+	return lab;
+}
+
+static uint32_t oklab_to_rgb(const labColor_t &lab)
+{
+	double l = lab.L + 0.3963377774 * lab.a + 0.2158037573 * lab.b;
+	double m = lab.L - 0.1055613458 * lab.a - 0.0638541728 * lab.b;
+	double s = lab.L - 0.0894841775 * lab.a - 1.2914855480 * lab.b;
+	l = l * l * l;
+	m = m * m * m;
+	s = s * s * s;
+
+	/*Out-of-gamut values are clipped per channel.*/
+	uint32_t r = (uint32_t)lround(linear_to_srgb(4.0767416621 * l - 3.3077115913 * m + 0.2309699292 * s) * 255.0);
+	uint32_t g = (uint32_t)lround(linear_to_srgb(-1.2684380046 * l + 2.6097574011 * m - 0.3413193965 * s) * 255.0);
+	uint32_t b = (uint32_t)lround(linear_to_srgb(-0.0041960863 * l - 0.7034186147 * m + 1.7076147010 * s) * 255.0);
+	return (r << 16) | (g << 8) | b;
+}
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+colorAnimation::colorAnimation()
+{
+	m_frame_ms = DEFAULT_COLOR_FRAME_MS;
+}
+
+void colorAnimation::appendFrame(uint32_t color)
+{
+	if(!m_steps.empty() && (color == m_steps.back().color) && (0xFFFF > m_steps.back().hold_frames))
+	{
+		m_steps.back().hold_frames++;
+	}
+	else
+	{
+		colorStep_t step = {color, 1};
+		m_steps.push_back(step);
+	}
+}
+
+/**
+ * @brief This API builds a transition from one color to another, interpolated in OKLab.
+ *
+ * @param[in] from		start color (0xRRGGBB).
+ * @param[in] to		end color (0xRRGGBB).
+ * @param[in] duration_ms	length of the transition.
+ * @param[in] frame_ms		interval between frames.
+ *
+ * @return  Returns status of the operation.
+ */
+int colorAnimation::buildTransition(uint32_t from, uint32_t to, unsigned int duration_ms, unsigned int frame_ms)
+{
+	if((0 == frame_ms) || (frame_ms > duration_ms))
+	{
+		ERROR("Bad inputs!\n");
+		return -1;
+	}
+	unsigned int num_frames = duration_ms / frame_ms;
+	labColor_t start = rgb_to_oklab(from);
+	labColor_t end = rgb_to_oklab(to);
+
+	m_frame_ms = frame_ms;
+	m_steps.clear();
+	m_steps.reserve(num_frames + 1);
+	for(unsigned int i = 0; i <= num_frames; i++)
+	{
+		double t = (double)i / num_frames;
+		labColor_t lab;
+		lab.L = start.L + (end.L - start.L) * t;
+		lab.a = start.a + (end.a - start.a) * t;
+		lab.b = start.b + (end.b - start.b) * t;
+		appendFrame(oklab_to_rgb(lab));
+	}
+	INFO("Built transition 0x%06x -> 0x%06x: %u frames, %zu steps\n", from, to, num_frames + 1, m_steps.size());
+	return 0;
+}
+
+/**
+ * @brief This API builds a full hue rotation at the lightness and chroma of the base color.
+ *
+ * @param[in] base_color	color the cycle starts and ends at (0xRRGGBB).
+ * @param[in] period_ms		length of one rotation.
+ * @param[in] frame_ms		interval between frames.
+ *
+ * @return  Returns status of the operation.
+ */
+int colorAnimation::buildHueCycle(uint32_t base_color, unsigned int period_ms, unsigned int frame_ms)
+{
+	if((0 == frame_ms) || (frame_ms > period_ms))
+	{
+		ERROR("Bad inputs!\n");
+		return -1;
+	}
+	unsigned int num_frames = period_ms / frame_ms;
+	labColor_t base = rgb_to_oklab(base_color);
+	double chroma = sqrt(base.a * base.a + base.b * base.b);
+	double hue = atan2(base.b, base.a);
+
+	m_frame_ms = frame_ms;
+	m_steps.clear();
+	m_steps.reserve(num_frames);
+	for(unsigned int i = 0; i < num_frames; i++)
+	{
+		double angle = hue + (2.0 * M_PI * i) / num_frames;
+		labColor_t lab;
+		lab.L = base.L;
+		lab.a = chroma * cos(angle);
+		lab.b = chroma * sin(angle);
+		appendFrame(oklab_to_rgb(lab));
+	}
+	INFO("Built hue cycle from 0x%06x: %u frames, %zu steps\n", base_color, num_frames, m_steps.size());
+	return 0;
+}
+
+unsigned int colorAnimation::getNumSteps() const
+{
+	return m_steps.size();
+}
+
+const colorStep_t& colorAnimation::getStep(unsigned int index) const
+{
+	return m_steps[index];
+}
+
+unsigned int colorAnimation::getFrameInterval() const
+{
+	return m_frame_ms;
+}
+
+/** @} */  //END OF GROUP LED_APIS
@@ -0,0 +1,58 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef COLORANIMATION_H
+#define COLORANIMATION_H
+#include <vector>
+#include <stdint.h>
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+#define DEFAULT_COLOR_FRAME_MS 40	/**< 25 frames per second */
+
+typedef struct
+{
+	uint32_t color;		/**< 0xRRGGBB as written to the device */
+	uint16_t hold_frames;	/**< Consecutive frames that quantized to this color */
+}colorStep_t;
+
+/* @} */ // End of group LED_TYPES
+
+/*Color animation precomputed into a lookup table. Gradients are interpolated in the OKLab space when
+ * the table is built; playback is a table index plus a write per step with no floating-point work.
+ * Frames that quantize to the same device color are merged into a single step.*/
+class colorAnimation
+{
+	private:
+		std::vector <colorStep_t> m_steps;
+		unsigned int m_frame_ms;
+
+	public:
+		colorAnimation();
+		int buildTransition(uint32_t from, uint32_t to, unsigned int duration_ms, unsigned int frame_ms = DEFAULT_COLOR_FRAME_MS);
+		int buildHueCycle(uint32_t base_color, unsigned int period_ms, unsigned int frame_ms = DEFAULT_COLOR_FRAME_MS);
+		unsigned int getNumSteps() const;
+		const colorStep_t& getStep(unsigned int index) const;
+		unsigned int getFrameInterval() const;
+	private:
+		void appendFrame(uint32_t color);
+};
+
+#endif /*COLORANIMATION_H*/
@@ -0,0 +1,315 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+#include "ledmgr_types.hpp"
+#include "ledloop.hpp"
+#include "commandring.hpp"
+
+/*One connected client: its ring, the eventfd it signals and the connection whose closure releases both.
+ * Everything here runs on the main loop, so no locking is needed.*/
+typedef struct
+{
+	int socket;
+	int eventfd;
+	ledmgr_ring_t *ring;
+	guint socket_source;
+	guint eventfd_source;
+}ringClient_t;
+
+static int g_listen_socket = -1;
+static guint g_listen_source = 0;
+static ringClient_t g_clients[MAX_RING_CLIENTS];
+static char g_indicator_names[LEDMGR_RING_MAX_INDICATORS][LEDMGR_RING_NAME_LENGTH];
+static uint32_t g_num_indicators = 0;
+static ringCommandHandler_t g_handler = NULL;
+static void *g_handler_context = NULL;
+
+/*Runs the client's pending commands in order, straight from the slots. A slot is handed back to the
+ * client only after its command has run. At most one ring's worth is run per call so that a busy client
+ * can't starve the main loop; the rest is picked up on the next iteration.*/
+static void drain_ring(ringClient_t *client)
+{
+	ledmgr_ring_t *ring = client->ring;
+	uint32_t tail = ring->tail;
+	uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	if(LEDMGR_RING_SLOTS < (uint32_t)(head - tail))
+	{
+		ERROR("Ring head 0x%x is corrupt, dropping pending commands.\n", head);
+		__atomic_store_n(&ring->rejected, ring->rejected + 1, __ATOMIC_RELAXED);
+		__atomic_store_n(&ring->tail, head, __ATOMIC_RELEASE);
+		return;
+	}
+	for(unsigned int run = 0; (tail != head) && (run < LEDMGR_RING_SLOTS); run++)
+	{
+		const ledmgr_ring_command_t &command = ring->slots[tail & (LEDMGR_RING_SLOTS - 1)];
+		if(0 == g_handler(command, g_handler_context))
+		{
+			__atomic_store_n(&ring->completed, ring->completed + 1, __ATOMIC_RELAXED);
+		}
+		else
+		{
+			__atomic_store_n(&ring->rejected, ring->rejected + 1, __ATOMIC_RELAXED);
+		}
+		tail++;
+		__atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+	}
+	if(tail != head)
+	{
+		eventfd_write(client->eventfd, 1);
+	}
+}
+
+static gboolean ring_signalled(gint fd, GIOCondition condition, gpointer user_data)
+{
+	eventfd_t count;
+	eventfd_read(fd, &count);
+	drain_ring((ringClient_t *)user_data);
+	return G_SOURCE_CONTINUE;
+}
+
+/*Commands committed just before the client went away still run.*/
+static void release_client(ringClient_t *client)
+{
+	drain_ring(client);
+	led_fd_remove(client->eventfd_source);
+	if(0 != client->socket_source)
+	{
+		led_fd_remove(client->socket_source);
+	}
+	munmap(client->ring, sizeof(ledmgr_ring_t));
+	close(client->eventfd);
+	close(client->socket);
+	client->ring = NULL;
+	client->socket = -1;
+	INFO("Released command ring %d\n", (int)(client - g_clients));
+}
+
+/*Clients never write to the connection; readable means hung up (or misbehaving).*/
+static gboolean client_hangup(gint fd, GIOCondition condition, gpointer user_data)
+{
+	ringClient_t *client = (ringClient_t *)user_data;
+	client->socket_source = 0;	/*Removed on return*/
+	release_client(client);
+	return G_SOURCE_REMOVE;
+}
+
+/*Private, anonymous shared memory, sealed at its size before the client gets it: a client that could
+ * shrink it would make the daemon fault on its next read of the ring.*/
+static ledmgr_ring_t * create_ring(int &fd)
+{
+	fd = memfd_create("ledmgr_ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if(0 > fd)
+	{
+		return NULL;
+	}
+	void *mapping = MAP_FAILED;
+	if((0 == ftruncate(fd, sizeof(ledmgr_ring_t))) && (0 == fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL)))
+	{
+		mapping = mmap(NULL, sizeof(ledmgr_ring_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	if(MAP_FAILED == mapping)
+	{
+		close(fd);
+		return NULL;
+	}
+	ledmgr_ring_t *ring = (ledmgr_ring_t *)mapping;
+	ring->version = LEDMGR_RING_VERSION;
+	ring->num_slots = LEDMGR_RING_SLOTS;
+	ring->size = sizeof(ledmgr_ring_t);
+	ring->num_indicators = g_num_indicators;
+	memcpy(ring->indicators, g_indicator_names, sizeof(ring->indicators));
+	ring->magic = LEDMGR_RING_MAGIC;
+	return ring;
+}
+
+/*Sends the ring's memory and eventfd to the client.*/
+static int send_ring(int socket, int ring_fd, int event_fd)
+{
+	uint32_t version = LEDMGR_RING_VERSION;
+	struct iovec payload = {&version, sizeof(version)};
+	union
+	{
+		char buffer[CMSG_SPACE(2 * sizeof(int))];
+		struct cmsghdr align;
+	}control;
+	memset(&control, 0, sizeof(control));
+	struct msghdr message;
+	memset(&message, 0, sizeof(message));
+	message.msg_iov = &payload;
+	message.msg_iovlen = 1;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+	struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+	header->cmsg_level = SOL_SOCKET;
+	header->cmsg_type = SCM_RIGHTS;
+	header->cmsg_len = CMSG_LEN(2 * sizeof(int));
+	int fds[2] = {ring_fd, event_fd};
+	memcpy(CMSG_DATA(header), fds, sizeof(fds));
+	return (sizeof(version) == sendmsg(socket, &message, MSG_NOSIGNAL)) ? 0 : -1;
+}
+
+static gboolean client_connected(gint fd, GIOCondition condition, gpointer user_data)
+{
+	int socket = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if(0 > socket)
+	{
+		return G_SOURCE_CONTINUE;
+	}
+	struct ucred peer;
+	socklen_t peer_length = sizeof(peer);
+	if((0 != getsockopt(socket, SOL_SOCKET, SO_PEERCRED, &peer, &peer_length)) || ((0 != peer.uid) && (geteuid() != peer.uid)))
+	{
+		ERROR("Refusing command ring client!\n");
+		close(socket);
+		return G_SOURCE_CONTINUE;
+	}
+	ringClient_t *client = NULL;
+	for(unsigned int i = 0; i < MAX_RING_CLIENTS; i++)
+	{
+		if(NULL == g_clients[i].ring)
+		{
+			client = &g_clients[i];
+			break;
+		}
+	}
+	if(NULL == client)
+	{
+		ERROR("Too many command ring clients!\n");
+		close(socket);
+		return G_SOURCE_CONTINUE;
+	}
+
+	int ring_fd = -1;
+	ledmgr_ring_t *ring = create_ring(ring_fd);
+	int event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if((NULL == ring) || (0 > event_fd) || (0 != send_ring(socket, ring_fd, event_fd)))
+	{
+		ERROR("Could not set up a command ring!\n");
+		if(NULL != ring)
+		{
+			munmap(ring, sizeof(ledmgr_ring_t));
+			close(ring_fd);
+		}
+		if(0 <= event_fd)
+		{
+			close(event_fd);
+		}
+		close(socket);
+		return G_SOURCE_CONTINUE;
+	}
+	close(ring_fd);
+
+	client->socket = socket;
+	client->eventfd = event_fd;
+	client->ring = ring;
+	client->eventfd_source = led_fd_add(event_fd, G_IO_IN, ring_signalled, client);
+	client->socket_source = led_fd_add(socket, (GIOCondition)(G_IO_IN | G_IO_HUP | G_IO_ERR), client_hangup, client);
+	INFO("Opened command ring %d\n", (int)(client - g_clients));
+	return G_SOURCE_CONTINUE;
+}
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+/**
+ * @brief This API starts accepting command ring clients (see ledmgr_ring.h) on the main loop.
+ *
+ * @param[in] indicator_names  Indicators addressable from a ring, in the order of their ring index.
+ * @param[in] handler          Runs each command.
+ * @param[in] context          Passed to the handler.
+ *
+ * @return  Returns status of the operation.
+ */
+int open_command_rings(const std::vector <std::string> &indicator_names, ringCommandHandler_t handler, void *context)
+{
+	if(0 <= g_listen_socket)
+	{
+		return 0;
+	}
+	memset(g_indicator_names, 0, sizeof(g_indicator_names));
+	g_num_indicators = 0;
+	for(unsigned int i = 0; (i < indicator_names.size()) && (i < LEDMGR_RING_MAX_INDICATORS); i++)
+	{
+		strncpy(g_indicator_names[i], indicator_names[i].c_str(), LEDMGR_RING_NAME_LENGTH - 1);
+		g_num_indicators++;
+	}
+	for(unsigned int i = 0; i < MAX_RING_CLIENTS; i++)
+	{
+		g_clients[i].socket = -1;
+		g_clients[i].ring = NULL;
+	}
+	g_handler = handler;
+	g_handler_context = context;
+
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	memcpy(address.sun_path + 1, LEDMGR_RING_SOCKET_NAME, sizeof(LEDMGR_RING_SOCKET_NAME) - 1);
+	socklen_t address_length = offsetof(struct sockaddr_un, sun_path) + sizeof(LEDMGR_RING_SOCKET_NAME);
+
+	g_listen_socket = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(0 > g_listen_socket)
+	{
+		ERROR("Could not create command ring socket!\n");
+		return -1;
+	}
+	if((0 != bind(g_listen_socket, (struct sockaddr *)&address, address_length)) ||
+		(0 != listen(g_listen_socket, MAX_RING_CLIENTS)))
+	{
+		ERROR("Could not listen on @%s!\n", LEDMGR_RING_SOCKET_NAME);
+		close(g_listen_socket);
+		g_listen_socket = -1;
+		return -1;
+	}
+	g_listen_source = led_fd_add(g_listen_socket, G_IO_IN, client_connected, NULL);
+	INFO("Accepting command ring clients on @%s\n", LEDMGR_RING_SOCKET_NAME);
+	return 0;
+}
+
+/**
+ * @brief This API stops accepting clients and releases every ring, after running what is already queued.
+ */
+void close_command_rings()
+{
+	if(0 > g_listen_socket)
+	{
+		return;
+	}
+	led_fd_remove(g_listen_source);
+	close(g_listen_socket);
+	g_listen_socket = -1;
+	for(unsigned int i = 0; i < MAX_RING_CLIENTS; i++)
+	{
+		if(NULL != g_clients[i].ring)
+		{
+			release_client(&g_clients[i]);
+		}
+	}
+}
+
+/** @} */  //END OF GROUP LED_APIS
@@ -0,0 +1,39 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef COMMANDRING_H
+#define COMMANDRING_H
+#include <string>
+#include <vector>
+#include "ledmgr_ring.h"
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+#define MAX_RING_CLIENTS 8
+
+/** Runs one ring command, reading it in place. Returns 0 on success. */
+typedef int (*ringCommandHandler_t)(const ledmgr_ring_command_t &command, void *context);
+
+/* @} */ // End of group LED_TYPES
+
+int open_command_rings(const std::vector <std::string> &indicator_names, ringCommandHandler_t handler, void *context);
+void close_command_rings();
+
+#endif /*COMMANDRING_H*/
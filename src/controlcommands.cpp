@@ -0,0 +1,588 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libIBus.h"
+#include "sysMgr.h"
+#include "libIBusDaemon.h"
+#include "irMgr.h"
+#include "pwrMgr.h"
+
+#include "ledmgr_types.hpp"
+#include "ledmgr.hpp"
+#include "ledmgr_ipc.h"
+#include "eventhandlers.hpp"
+#include "controlsocket.hpp"
+#include "controlcommands.hpp"
+
+#define COLOR_CYCLE_PERIOD_MS 6000
+
+typedef struct
+{
+	const char *name;
+	int value;
+}controlName_t;
+
+typedef int (*controlVerbFunction_t)(int argc, char *argv[], bool execute, char *reply, size_t reply_length);
+
+typedef struct
+{
+	const char *verb;
+	int min_words;		/**< Verb included */
+	int max_words;
+	const char *usage;
+	controlVerbFunction_t function;
+}controlVerb_t;
+
+static const controlName_t g_pattern_names[] = {
+	{"slow", STATE_SLOW_BLINK},
+	{"double", STATE_DOUBLE_BLINK},
+	{"fast", STATE_FAST_BLINK},
+};
+
+static const controlName_t g_power_names[] = {
+	{"on", IARM_BUS_PWRMGR_POWERSTATE_ON},
+	{"standby", IARM_BUS_PWRMGR_POWERSTATE_STANDBY},
+	{"light-sleep", IARM_BUS_PWRMGR_POWERSTATE_STANDBY_LIGHT_SLEEP},
+	{"deep-sleep", IARM_BUS_PWRMGR_POWERSTATE_STANDBY_DEEP_SLEEP},
+	{"off", IARM_BUS_PWRMGR_POWERSTATE_OFF},
+};
+
+static const controlName_t g_mode_names[] = {
+	{"normal", IARM_BUS_SYS_MODE_NORMAL},
+	{"eas", IARM_BUS_SYS_MODE_EAS},
+	{"warehouse", IARM_BUS_SYS_MODE_WAREHOUSE},
+};
+
+static const controlName_t g_easing_names[] = {
+	{"step", EASING_STEP},
+	{"linear", EASING_LINEAR},
+	{"in", EASING_IN},
+	{"out", EASING_OUT},
+};
+
+static const controlName_t g_switch_names[] = {
+	{"on", 1},
+	{"off", 0},
+};
+
+/*What the indicator must support for each indicator command, so that batches are rejected up front.*/
+static const controlName_t g_required_capabilities[] = {
+	{"state", LED_CAP_STATE},
+	{"blink", LED_CAP_BLINK},
+	{"play", LED_CAP_BLINK},
+	{"cycle", LED_CAP_COLOR},
+	{"color", LED_CAP_COLOR},
+	{"flare", LED_CAP_BRIGHTNESS},
+};
+
+#define NAMES(table) table, (sizeof(table) / sizeof(table[0]))
+
+static int fail(char *reply, size_t reply_length, const char *format, const char *word)
+{
+	snprintf(reply, reply_length, format, word);
+	return -1;
+}
+
+static bool parse_number(const char *word, long min, long max, long &value)
+{
+	char *end = NULL;
+	value = strtol(word, &end, 0);
+	return ('\0' != word[0]) && ('\0' == *end) && (min <= value) && (max >= value);
+}
+
+static bool parse_name(const char *word, const controlName_t *names, size_t num_names, int &value)
+{
+	for(size_t i = 0; i < num_names; i++)
+	{
+		if(0 == strcmp(word, names[i].name))
+		{
+			value = names[i].value;
+			return true;
+		}
+	}
+	return false;
+}
+
+/*Keyframe brightness: off, on (brightness left alone) or a percentage.*/
+static bool parse_level(const char *word, long &level)
+{
+	if(0 == strcmp(word, "off"))
+	{
+		level = LEDMGR_KEYFRAME_OFF;
+		return true;
+	}
+	if(0 == strcmp(word, "on"))
+	{
+		level = LEDMGR_KEYFRAME_ON;
+		return true;
+	}
+	return parse_number(word, 1, 100, level);
+}
+
+/*Optional repetition count, defaulting to looping. Zero is refused here, as the indicator would refuse it
+ * anyway, so that a batch holding it fails its check rather than half-way through.*/
+static bool parse_repetitions(int argc, char *argv[], int index, int &repetitions)
+{
+	long value = -1;
+	if((index < argc) && (!parse_number(argv[index], -1, 0xFFFF, value) || (0 == value)))
+	{
+		return false;
+	}
+	repetitions = (int)value;
+	return true;
+}
+
+static int control_list(int argc, char *argv[], bool execute, char *reply, size_t reply_length)
+{
+	size_t length = 0;
+	indicator *led = NULL;
+	reply[0] = '\0';
+	for(unsigned int i = 0; (NULL != (led = ledMgr::getInstance().findIndicatorAt(i))) && (length < reply_length); i++)
+	{
+		length += snprintf(reply + length, reply_length - length, "%s%s", (0 == i) ? "" : " ", led->getName().c_str());
+	}
+	return 0;
+}
+
+/*Indicator commands: <verb> <indicator> ...*/
+static int control_indicator(int argc, char *argv[], bool execute, char *reply, size_t reply_length)
+{
+	indicator *led = ledMgr::getInstance().findIndicator(argv[1]);
+	if(NULL == led)
+	{
+		return fail(reply, reply_length, "no indicator %s", argv[1]);
+	}
+	const char *verb = argv[0];
+	int value = 0;
+	if(parse_name(verb, NAMES(g_required_capabilities), value) && (0 == (led->getCapabilities().mask & value)))
+	{
+		return fail(reply, reply_length, "%s does not support that", argv[1]);
+	}
+	int repetitions = -1;
+	long number = 0;
+	long length_ms = 0;
+	if(0 == strcmp(verb, "state"))
+	{
+		if((3 != argc) || !parse_name(argv[2], NAMES(g_switch_names), value))
+		{
+			return fail(reply, reply_length, "bad state %s", (3 == argc) ? argv[2] : "");
+		}
+		return execute ? led->setState(value ? STATE_STEADY_ON : STATE_STEADY_OFF) : 0;
+	}
+	if(0 == strcmp(verb, "blink"))
+	{
+		if((3 > argc) || !parse_name(argv[2], NAMES(g_pattern_names), value))
+		{
+			return fail(reply, reply_length, "bad pattern %s", (3 <= argc) ? argv[2] : "");
+		}
+		if(!parse_repetitions(argc, argv, 3, repetitions))
+		{
+			return fail(reply, reply_length, "bad repetitions %s", argv[3]);
+		}
+		return execute ? led->setBlink(ledMgr::getInstance().getPattern((blinkPatternType_t)value), repetitions) : 0;
+	}
+	if(0 == strcmp(verb, "play"))
+	{
+		if((3 > argc) || !parse_number(argv[2], 1, 0xFFFFFFFFL, number))
+		{
+			return fail(reply, reply_length, "bad handle %s", (3 <= argc) ? argv[2] : "");
+		}
+		if(!parse_repetitions(argc, argv, 3, repetitions))
+		{
+			return fail(reply, reply_length, "bad repetitions %s", argv[3]);
+		}
+		return execute ? ledMgr::getInstance().playPattern(argv[1], (unsigned int)number, repetitions) : 0;
+	}
+	if(0 == strcmp(verb, "cycle"))
+	{
+		static colorAnimation hue_cycle;
+		if(!parse_repetitions(argc, argv, 2, repetitions))
+		{
+			return fail(reply, reply_length, "bad repetitions %s", argv[2]);
+		}
+		if(!execute)
+		{
+			return 0;
+		}
+		if(0 == hue_cycle.getNumSteps())
+		{
+			hue_cycle.buildHueCycle(0xFF0000, COLOR_CYCLE_PERIOD_MS);
+		}
+		return led->setColorAnimation(&hue_cycle, repetitions);
+	}
+	if(0 == strcmp(verb, "color"))
+	{
+		if((3 != argc) || !parse_number(argv[2], 0, 0xFFFFFF, number))
+		{
+			return fail(reply, reply_length, "bad color %s", (3 == argc) ? argv[2] : "");
+		}
+		return execute ? led->setColor((unsigned int)number) : 0;
+	}
+	if(0 == strcmp(verb, "flare"))
+	{
+		if((4 != argc) || !parse_number(argv[2], 1, 100, number) || !parse_number(argv[3], 1, 60000, length_ms))
+		{
+			return fail(reply, reply_length, "%s", "usage: flare <indicator> <percent> <ms>");
+		}
+		if(execute)
+		{
+			led->executeFlare((unsigned int)number, (unsigned int)length_ms);
+		}
+		return 0;
+	}
+	if(execute && (0 == strcmp(verb, "push")))
+	{
+		led->saveState();
+	}
+	else if(execute)
+	{
+		led->restoreState();
+	}
+	return 0;
+}
+
+/*register <ms>:<brightness>[:<color index>[:<easing>]]... [palette <0xRRGGBB>...]*/
+static int control_register(int argc, char *argv[], bool execute, char *reply, size_t reply_length)
+{
+	IARM_Bus_LEDMgr_RegisterPattern_Param_t param;
+	memset(&param, 0, sizeof(param));
+	int i = 1;
+	for(; (i < argc) && (0 != strcmp(argv[i], "palette")); i++)
+	{
+		if(LEDMGR_MAX_PATTERN_KEYFRAMES == param.num_keyframes)
+		{
+			return fail(reply, reply_length, "%s", "too many keyframes");
+		}
+		char field[4][16];
+		memset(field, 0, sizeof(field));
+		int num_fields = sscanf(argv[i], "%15[^:]:%15[^:]:%15[^:]:%15s", field[0], field[1], field[2], field[3]);
+		IARM_Bus_LEDMgr_Keyframe_t &keyframe = param.keyframes[param.num_keyframes++];
+		long duration = 0;
+		long brightness = 0;
+		long color_index = 0;
+		int easing = EASING_STEP;
+		if((2 > num_fields) || !parse_number(field[0], 1, 0xFFFF, duration) || !parse_level(field[1], brightness) ||
+			((3 <= num_fields) && !parse_number(field[2], 0, LEDMGR_MAX_PATTERN_COLORS, color_index)) ||
+			((4 == num_fields) && !parse_name(field[3], NAMES(g_easing_names), easing)))
+		{
+			return fail(reply, reply_length, "bad keyframe %s", argv[i]);
+		}
+		keyframe.duration = (uint16_t)duration;
+		keyframe.brightness = (uint8_t)brightness;
+		keyframe.color_index = (uint8_t)color_index;
+		keyframe.easing = (uint8_t)easing;
+	}
+	for(i++; i < argc; i++)
+	{
+		long color = 0;
+		if((LEDMGR_MAX_PATTERN_COLORS == param.num_colors) || !parse_number(argv[i], 0, 0xFFFFFF, color))
+		{
+			return fail(reply, reply_length, "bad palette color %s", argv[i]);
+		}
+		param.palette[param.num_colors++] = (uint32_t)color;
+	}
+	if(0 == param.num_keyframes)
+	{
+		return fail(reply, reply_length, "%s", "no keyframes");
+	}
+	if(!execute)
+	{
+		return 0;
+	}
+	registerPatternHandler(&param);
+	if(0 != param.result)
+	{
+		return fail(reply, reply_length, "%s", "pattern refused");
+	}
+	snprintf(reply, reply_length, "%u", param.handle);
+	return 0;
+}
+
+static int control_release(int argc, char *argv[], bool execute, char *reply, size_t reply_length)
+{
+	long handle = 0;
+	if(!parse_number(argv[1], 1, 0xFFFFFFFFL, handle))
+	{
+		return fail(reply, reply_length, "bad handle %s", argv[1]);
+	}
+	return execute ? ledMgr::getInstance().releasePattern((unsigned int)handle) : 0;
+}
+
+static int control_error(int argc, char *argv[], bool execute, char *reply, size_t reply_length)
+{
+	long position = 0;
+	int value = 0;
+	if(!parse_number(argv[1], 0, 31, position) || !parse_name(argv[2], NAMES(g_switch_names), value))
+	{
+		return fail(reply, reply_length, "%s", "usage: error <0-31> on|off");
+	}
+	if(execute && ledMgr::getInstance().setError((unsigned int)position, (1 == value)))
+	{
+		snprintf(reply, reply_length, "transition");
+	}
+	return 0;
+}
+
+static int control_power(int argc, char *argv[], bool execute, char *reply, size_t reply_length)
+{
+	int state = 0;
+	if(!parse_name(argv[1], NAMES(g_power_names), state))
+	{
+		return fail(reply, reply_length, "bad power state %s", argv[1]);
+	}
+	if(execute)
+	{
+		IARM_Bus_PWRMgr_EventData_t event;
+		memset(&event, 0, sizeof(event));
+		event.data.state.curState = (IARM_Bus_PowerState_t)ledMgr::getInstance().getPowerState();
+		event.data.state.newState = (IARM_Bus_PowerState_t)state;
+		powerEventHandler(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_EVENT_MODECHANGED, &event, sizeof(event));
+	}
+	return 0;
+}
+
+static int control_mode(int argc, char *argv[], bool execute, char *reply, size_t reply_length)
+{
+	int mode = 0;
+	if(!parse_name(argv[1], NAMES(g_mode_names), mode))
+	{
+		return fail(reply, reply_length, "bad mode %s", argv[1]);
+	}
+	if(execute)
+	{
+		IARM_Bus_CommonAPI_SysModeChange_Param_t param;
+		memset(&param, 0, sizeof(param));
+		param.newMode = (IARM_Bus_Daemon_SysMode_t)mode;
+		modeChangeHandler(&param);
+	}
+	return 0;
+}
+
+/*sysstate <state ID> <state> [error]*/
+static int control_sysstate(int argc, char *argv[], bool execute, char *reply, size_t reply_length)
+{
+	long state_id = 0;
+	long state = 0;
+	long error = 0;
+	if(!parse_number(argv[1], 0, 0xFFFF, state_id) || !parse_number(argv[2], -0x7FFFFFFFL, 0x7FFFFFFFL, state) ||
+		((4 == argc) && !parse_number(argv[3], -0x7FFFFFFFL, 0x7FFFFFFFL, error)))
+	{
+		return fail(reply, reply_length, "%s", "usage: sysstate <state ID> <state> [error]");
+	}
+	if(execute)
+	{
+		IARM_Bus_SYSMgr_EventData_t event;
+		memset(&event, 0, sizeof(event));
+		event.data.systemStates.stateId = (IARM_Bus_SYSMgr_SystemState_t)state_id;
+		event.data.systemStates.state = (int)state;
+		event.data.systemStates.error = (int)error;
+		sysEventHandler(IARM_BUS_SYSMGR_NAME, IARM_BUS_SYSMGR_EVENT_SYSTEMSTATE, &event, sizeof(event));
+	}
+	return 0;
+}
+
+/*key <code> [type]*/
+static int control_key(int argc, char *argv[], bool execute, char *reply, size_t reply_length)
+{
+	long code = 0;
+	long type = 0;
+	if(!parse_number(argv[1], 0, 0x7FFFFFFFL, code) || ((3 == argc) && !parse_number(argv[2], 0, 0x7FFFFFFFL, type)))
+	{
+		return fail(reply, reply_length, "%s", "usage: key <code> [type]");
+	}
+	if(execute)
+	{
+		IARM_Bus_IRMgr_EventData_t event;
+		memset(&event, 0, sizeof(event));
+		event.data.irkey.keyCode = (int)code;
+		event.data.irkey.keyType = (int)type;
+		keyEventHandler(IARM_BUS_IRMGR_NAME, IARM_BUS_IRMGR_EVENT_IRKEY, &event, sizeof(event));
+	}
+	return 0;
+}
+
+/*reset <step>|abort: one step of the reset sequence, or leaving it.*/
+static int control_reset(int argc, char *argv[], bool execute, char *reply, size_t reply_length)
+{
+	long step = -1;
+	if((0 != strcmp(argv[1], "abort")) && !parse_number(argv[1], 0, 0xFFFF, step))
+	{
+		return fail(reply, reply_length, "%s", "usage: reset <step>|abort");
+	}
+	if(execute)
+	{
+		IARM_Bus_PWRMgr_EventData_t event;
+		memset(&event, 0, sizeof(event));
+		event.data.reset_sequence_progress = (int)step;
+		powerEventHandler(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_EVENT_RESET_SEQUENCE, &event, sizeof(event));
+	}
+	return 0;
+}
+
+static const char * value_name(int value, const controlName_t *names, size_t num_names)
+{
+	for(size_t i = 0; i < num_names; i++)
+	{
+		if(value == names[i].value)
+		{
+			return names[i].name;
+		}
+	}
+	return NULL;
+}
+
+/*energy [indicator]: energy per indicator, or per power state and pattern for one indicator.*/
+static int control_energy(int argc, char *argv[], bool execute, char *reply, size_t reply_length)
+{
+	energyBucket_t buckets[MAX_ENERGY_BUCKETS];
+	unsigned int num_buckets = 0;
+	size_t length = 0;
+	indicator *led = NULL;
+	reply[0] = '\0';
+	if(1 == argc)
+	{
+		for(unsigned int i = 0; (NULL != (led = ledMgr::getInstance().findIndicatorAt(i))) && (length < reply_length); i++)
+		{
+			uint64_t lit_us = 0;
+			double estimate_mwh = 0;
+			ledMgr::getInstance().getEnergy(led->getName().c_str(), buckets, MAX_ENERGY_BUCKETS, num_buckets);
+			for(unsigned int j = 0; j < num_buckets; j++)
+			{
+				lit_us += buckets[j].lit_us;
+				estimate_mwh += buckets[j].estimate_mwh;
+			}
+			length += snprintf(reply + length, reply_length - length, "%s%s %.1fs %.4fmWh", (0 == i) ? "" : "; ",
+				led->getName().c_str(), lit_us / 1e6, estimate_mwh);
+		}
+		return 0;
+	}
+	if(0 != ledMgr::getInstance().getEnergy(argv[1], buckets, MAX_ENERGY_BUCKETS, num_buckets))
+	{
+		return fail(reply, reply_length, "no indicator %s", argv[1]);
+	}
+	for(unsigned int i = 0; (i < num_buckets) && (length < reply_length); i++)
+	{
+		const energyBucket_t &bucket = buckets[i];
+		const char *power = value_name(bucket.power_state, NAMES(g_power_names));
+		const char *pattern = value_name((int)bucket.pattern_id, NAMES(g_pattern_names));
+		if(LEDMGR_STATUS_NO_PATTERN == bucket.pattern_id)
+		{
+			pattern = "steady";
+		}
+		else if(ENERGY_OTHER_PATTERNS == bucket.pattern_id)
+		{
+			pattern = "other";
+		}
+		char pattern_id[16];
+		if(NULL == pattern)
+		{
+			snprintf(pattern_id, sizeof(pattern_id), "0x%x", bucket.pattern_id);
+			pattern = pattern_id;
+		}
+		length += snprintf(reply + length, reply_length - length, "%s%s %s %.1fs %llu%% %.4fmWh", (0 == i) ? "" : "; ",
+			(NULL != power) ? power : "any", pattern, bucket.lit_us / 1e6,
+			(unsigned long long)((0 != bucket.lit_us) ? (bucket.level_us / bucket.lit_us) : 0), bucket.estimate_mwh);
+	}
+	return 0;
+}
+
+static int control_diag(int argc, char *argv[], bool execute, char *reply, size_t reply_length)
+{
+	if(execute)
+	{
+		ledMgr::getInstance().diagnostics();	/*To the log*/
+	}
+	return 0;
+}
+
+static int control_help(int argc, char *argv[], bool execute, char *reply, size_t reply_length);
+
+static const controlVerb_t g_verbs[] = {
+	{"list", 1, 1, "list", control_list},
+	{"state", 3, 3, "state <indicator> on|off", control_indicator},
+	{"blink", 3, 4, "blink <indicator> slow|double|fast [repetitions]", control_indicator},
+	{"play", 3, 4, "play <indicator> <handle> [repetitions]", control_indicator},
+	{"cycle", 2, 3, "cycle <indicator> [repetitions]", control_indicator},
+	{"color", 3, 3, "color <indicator> <0xRRGGBB>", control_indicator},
+	{"flare", 4, 4, "flare <indicator> <percent> <ms>", control_indicator},
+	{"push", 2, 2, "push <indicator>", control_indicator},
+	{"pop", 2, 2, "pop <indicator>", control_indicator},
+	{"register", 2, MAX_CONTROL_ARGS, "register <ms>:off|on|<1-100>[:<color index>[:step|linear|in|out]]... [palette <0xRRGGBB>...]", control_register},
+	{"release", 2, 2, "release <handle>", control_release},
+	{"error", 3, 3, "error <0-31> on|off", control_error},
+	{"power", 2, 2, "power on|standby|light-sleep|deep-sleep|off", control_power},
+	{"mode", 2, 2, "mode normal|eas|warehouse", control_mode},
+	{"sysstate", 3, 4, "sysstate <state ID> <state> [error]", control_sysstate},
+	{"key", 2, 3, "key <code> [type]", control_key},
+	{"reset", 2, 2, "reset <step>|abort", control_reset},
+	{"energy", 1, 2, "energy [indicator]", control_energy},
+	{"diag", 1, 1, "diag", control_diag},
+	{"help", 1, 1, "help", control_help},
+};
+
+#define NUM_CONTROL_VERBS (sizeof(g_verbs) / sizeof(g_verbs[0]))
+
+static int control_help(int argc, char *argv[], bool execute, char *reply, size_t reply_length)
+{
+	size_t length = 0;
+	reply[0] = '\0';
+	for(size_t i = 0; (i < NUM_CONTROL_VERBS) && (length < reply_length); i++)
+	{
+		length += snprintf(reply + length, reply_length - length, "%s%s", (0 == i) ? "" : " ", g_verbs[i].verb);
+	}
+	return 0;
+}
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+/**
+ * @brief This API checks a control command and, if execute is set, runs it. Matches controlCommandHandler_t.
+ *
+ * @return  Returns 0 on success; reply then holds the result, if any, and otherwise the reason.
+ */
+int run_control_command(int argc, char *argv[], bool execute, char *reply, size_t reply_length)
+{
+	for(size_t i = 0; i < NUM_CONTROL_VERBS; i++)
+	{
+		const controlVerb_t &verb = g_verbs[i];
+		if(0 != strcmp(argv[0], verb.verb))
+		{
+			continue;
+		}
+		if((verb.min_words > argc) || (verb.max_words < argc))
+		{
+			return fail(reply, reply_length, "usage: %s", verb.usage);
+		}
+		int ret = verb.function(argc, argv, execute, reply, reply_length);
+		if((0 != ret) && ('\0' == reply[0]))
+		{
+			snprintf(reply, reply_length, "%s failed", verb.verb);
+		}
+		return ret;
+	}
+	return fail(reply, reply_length, "unknown command %s, try help", argv[0]);
+}
+
+/** @} */  //END OF GROUP LED_APIS
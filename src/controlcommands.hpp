@@ -0,0 +1,28 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef CONTROLCOMMANDS_H
+#define CONTROLCOMMANDS_H
+#include <stddef.h>
+
+/*Commands of the control socket (see controlsocket.hpp). They go through the same handlers as the bus,
+ * so an injected power, mode, sys-state or key event is handled, subscribed to, debounced and recorded
+ * exactly like one from IARM.*/
+int run_control_command(int argc, char *argv[], bool execute, char *reply, size_t reply_length);
+
+#endif /*CONTROLCOMMANDS_H*/
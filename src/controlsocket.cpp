@@ -0,0 +1,520 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <string.h>
+#include <stdio.h>
+#include <algorithm>
+#include <stdarg.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "ledmgr_types.hpp"
+#include "ledloop.hpp"
+#include "ledtiming.hpp"
+#include "controlsocket.hpp"
+
+#define CONTROL_INPUT_SIZE (8 * CONTROL_LINE_LENGTH)
+#define CONTROL_MAX_REPLY (CONTROL_REPLY_LENGTH + 32)	/**< Reply line: status, timing, text, newline */
+#define CONTROL_OUTPUT_SIZE ((MAX_BATCH_COMMANDS + 2) * CONTROL_MAX_REPLY)	/**< Room for a whole batch */
+
+/*One connected client. Everything here runs on the main loop, so no locking is needed. Allocated on
+ * connect: the batch and reply buffers are too big to keep around for clients that are not there.*/
+typedef struct
+{
+	int socket;
+	guint input_source;	/**< 0 while throttled */
+	guint output_source;	/**< Non-zero while replies are waiting for the socket */
+	char input[CONTROL_INPUT_SIZE];
+	size_t input_length;
+	char output[CONTROL_OUTPUT_SIZE];
+	size_t output_length;
+	bool in_batch;
+	bool batch_full;		/**< More than MAX_BATCH_COMMANDS; the batch can only be rejected */
+	unsigned int num_batched;
+	int failed_index;		/**< First batched command that did not check out, -1 if none */
+	char failed_reason[CONTROL_REPLY_LENGTH];
+	char batch[MAX_BATCH_COMMANDS][CONTROL_LINE_LENGTH];
+}controlClient_t;
+
+static int g_listen_socket = -1;
+static guint g_listen_source = 0;
+static controlClient_t *g_clients[MAX_CONTROL_CLIENTS];
+static controlCommandHandler_t g_handler = NULL;
+
+static gboolean client_readable(gint fd, GIOCondition condition, gpointer user_data);
+
+static uint64_t get_time_ns()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t)now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+
+static void reply(controlClient_t *client, const char *format, ...)
+{
+	/*Callers make sure there is room for CONTROL_MAX_REPLY before handling a line.*/
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(client->output + client->output_length, CONTROL_MAX_REPLY, format, args);
+	va_end(args);
+	client->output_length += std::min(length, CONTROL_MAX_REPLY - 1);
+}
+
+/*Splits a line into words in place. Returns the number of words, or -1 if there are too many.*/
+static int split_line(char *line, char *argv[])
+{
+	int argc = 0;
+	char *saveptr = NULL;
+	for(char *word = strtok_r(line, " \t\r", &saveptr); NULL != word; word = strtok_r(NULL, " \t\r", &saveptr))
+	{
+		if(MAX_CONTROL_ARGS == argc)
+		{
+			return -1;
+		}
+		argv[argc++] = word;
+	}
+	return argc;
+}
+
+/*Checks a command, runs it if asked to, and replies.*/
+static int run_command(controlClient_t *client, char *line, bool execute)
+{
+	char *argv[MAX_CONTROL_ARGS];
+	char result[CONTROL_REPLY_LENGTH];
+	int argc = split_line(line, argv);
+	if(0 > argc)
+	{
+		if(execute)
+		{
+			reply(client, "ERR 0 too many words\n");
+		}
+		else
+		{
+			strcpy(client->failed_reason, "too many words");
+		}
+		return -1;
+	}
+	result[0] = '\0';
+	uint64_t start_ns = get_time_ns();
+	int ret = g_handler(argc, argv, execute, result, sizeof(result));
+	uint64_t elapsed_ns = get_time_ns() - start_ns;
+	if(!execute)
+	{
+		if(0 != ret)
+		{
+			strncpy(client->failed_reason, result, sizeof(client->failed_reason) - 1);
+			client->failed_reason[sizeof(client->failed_reason) - 1] = '\0';
+		}
+		return ret;
+	}
+	if(0 == ret)
+	{
+		reply(client, "OK %llu%s%s\n", (unsigned long long)elapsed_ns, ('\0' != result[0]) ? " " : "", result);
+	}
+	else
+	{
+		reply(client, "ERR %llu %s\n", (unsigned long long)elapsed_ns, ('\0' != result[0]) ? result : "failed");
+	}
+	return ret;
+}
+
+/*Runs a batch in one go, with timer callbacks held off, if every command in it checked out.*/
+static void commit_batch(controlClient_t *client)
+{
+	if((-1 != client->failed_index) || client->batch_full)
+	{
+		for(unsigned int i = 0; i < client->num_batched; i++)
+		{
+			reply(client, "ERR 0 %s\n", ((int)i == client->failed_index) ? client->failed_reason : "not run");
+		}
+		reply(client, "ERR 0 batch rejected\n");
+	}
+	else
+	{
+		uint64_t start_ns = get_time_ns();
+		hold_led_timers();
+		for(unsigned int i = 0; i < client->num_batched; i++)
+		{
+			run_command(client, client->batch[i], true);
+		}
+		release_led_timers();
+		reply(client, "OK %llu %u\n", (unsigned long long)(get_time_ns() - start_ns), client->num_batched);
+	}
+	client->in_batch = false;
+}
+
+/*Holds a command back until commit, checking it now. A line that could not be read is queued with the
+ * reason. Once the batch has overflowed, commands are refused straight away; it cannot run anyway.*/
+static void batch_command(controlClient_t *client, char *line, const char *error)
+{
+	if(!client->batch_full && (MAX_BATCH_COMMANDS == client->num_batched))
+	{
+		/*Answer what is queued now rather than holding replies the buffer may not fit.*/
+		for(unsigned int i = 0; i < client->num_batched; i++)
+		{
+			reply(client, "ERR 0 batch full\n");
+		}
+		client->num_batched = 0;
+		client->batch_full = true;
+	}
+	if(client->batch_full)
+	{
+		reply(client, "ERR 0 batch full\n");
+		return;
+	}
+	bool failed = (NULL != error);
+	if(failed)
+	{
+		strcpy(client->failed_reason, error);
+		client->batch[client->num_batched][0] = '\0';
+	}
+	else
+	{
+		strcpy(client->batch[client->num_batched], line);
+		failed = (0 != run_command(client, line, false));
+	}
+	if(failed && (-1 == client->failed_index))
+	{
+		client->failed_index = client->num_batched;
+	}
+	client->num_batched++;
+}
+
+static void handle_line(controlClient_t *client, char *line)
+{
+	char words[CONTROL_LINE_LENGTH];
+	char *argv[MAX_CONTROL_ARGS];
+	strcpy(words, line);
+	int argc = split_line(words, argv);
+	if((0 == argc) || ((0 < argc) && ('#' == argv[0][0])))
+	{
+		return;
+	}
+	const char *verb = (0 < argc) ? argv[0] : "";
+	if(0 == strcmp(verb, "begin"))
+	{
+		if(client->in_batch)
+		{
+			reply(client, "ERR 0 already in a batch\n");
+			return;
+		}
+		client->in_batch = true;
+		client->batch_full = false;
+		client->num_batched = 0;
+		client->failed_index = -1;
+		reply(client, "OK 0\n");
+	}
+	else if((0 == strcmp(verb, "commit")) || (0 == strcmp(verb, "abort")))
+	{
+		if(!client->in_batch)
+		{
+			reply(client, "ERR 0 not in a batch\n");
+		}
+		else if('c' == verb[0])
+		{
+			commit_batch(client);
+		}
+		else
+		{
+			for(unsigned int i = 0; i < client->num_batched; i++)
+			{
+				reply(client, "ERR 0 aborted\n");
+			}
+			client->in_batch = false;
+			reply(client, "OK 0\n");
+		}
+	}
+	else if(client->in_batch)
+	{
+		batch_command(client, line, NULL);
+	}
+	else
+	{
+		run_command(client, line, true);
+	}
+}
+
+/*Handles the complete lines received so far, as long as there is room for their replies. Returns false
+ * if it had to stop for lack of room.*/
+static bool process_input(controlClient_t *client)
+{
+	while(0 != client->input_length)
+	{
+		char *end = (char *)memchr(client->input, '\n', client->input_length);
+		if(NULL == end)
+		{
+			break;
+		}
+		unsigned int replies = client->in_batch ? (client->num_batched + 2) : 1;
+		if((CONTROL_OUTPUT_SIZE - client->output_length) < (replies * CONTROL_MAX_REPLY))
+		{
+			return false;
+		}
+		*end = '\0';
+		size_t consumed = (end - client->input) + 1;
+		if((CONTROL_LINE_LENGTH <= consumed) && client->in_batch)
+		{
+			batch_command(client, NULL, "line too long");
+		}
+		else if(CONTROL_LINE_LENGTH <= consumed)
+		{
+			reply(client, "ERR 0 line too long\n");
+		}
+		else
+		{
+			handle_line(client, client->input);
+		}
+		client->input_length -= consumed;
+		memmove(client->input, client->input + consumed, client->input_length);
+	}
+	return true;
+}
+
+/*Sends what it can of the pending replies. Returns -1 if the client is gone.*/
+static int flush_output(controlClient_t *client)
+{
+	size_t sent = 0;
+	while(sent < client->output_length)
+	{
+		ssize_t ret = send(client->socket, client->output + sent, client->output_length - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+		if(0 > ret)
+		{
+			if((EAGAIN == errno) || (EWOULDBLOCK == errno))
+			{
+				break;
+			}
+			if(EINTR == errno)
+			{
+				continue;
+			}
+			return -1;
+		}
+		sent += ret;
+	}
+	client->output_length -= sent;
+	memmove(client->output, client->output + sent, client->output_length);
+	return 0;
+}
+
+/*A batch still open when the client goes away never runs.*/
+static void release_client(controlClient_t *client)
+{
+	if(0 != client->input_source)
+	{
+		led_fd_remove(client->input_source);
+	}
+	if(0 != client->output_source)
+	{
+		led_fd_remove(client->output_source);
+	}
+	close(client->socket);
+	for(unsigned int i = 0; i < MAX_CONTROL_CLIENTS; i++)
+	{
+		if(client == g_clients[i])
+		{
+			g_clients[i] = NULL;
+			INFO("Control client %u disconnected\n", i);
+		}
+	}
+	delete client;
+}
+
+static gboolean client_writable(gint fd, GIOCondition condition, gpointer user_data)
+{
+	controlClient_t *client = (controlClient_t *)user_data;
+	if(0 != flush_output(client))
+	{
+		client->output_source = 0;	/*Removed on return*/
+		release_client(client);
+		return G_SOURCE_REMOVE;
+	}
+	if(0 == client->input_source)
+	{
+		/*Throttled: catch up on what was already read before reading more.*/
+		if(process_input(client))
+		{
+			client->input_source = led_fd_add(client->socket, (GIOCondition)(G_IO_IN | G_IO_HUP | G_IO_ERR), client_readable, client);
+		}
+		if(0 != flush_output(client))
+		{
+			client->output_source = 0;
+			release_client(client);
+			return G_SOURCE_REMOVE;
+		}
+	}
+	if((0 != client->output_length) || (0 == client->input_source))
+	{
+		return G_SOURCE_CONTINUE;
+	}
+	client->output_source = 0;
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean client_readable(gint fd, GIOCondition condition, gpointer user_data)
+{
+	controlClient_t *client = (controlClient_t *)user_data;
+	ssize_t received = recv(fd, client->input + client->input_length, CONTROL_INPUT_SIZE - client->input_length, MSG_DONTWAIT);
+	if((0 > received) && ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (EINTR == errno)))
+	{
+		return G_SOURCE_CONTINUE;
+	}
+	if(0 >= received)
+	{
+		client->input_source = 0;	/*Removed on return*/
+		release_client(client);
+		return G_SOURCE_REMOVE;
+	}
+	client->input_length += received;
+	bool caught_up = process_input(client);
+	if(caught_up && (CONTROL_INPUT_SIZE == client->input_length))
+	{
+		ERROR("Control client sent a line that does not fit, disconnecting.\n");
+		client->input_source = 0;
+		release_client(client);
+		return G_SOURCE_REMOVE;
+	}
+	if(0 != flush_output(client))
+	{
+		client->input_source = 0;
+		release_client(client);
+		return G_SOURCE_REMOVE;
+	}
+	/*A throttled client resumes from client_writable(), even if the replies it waited on are gone already.*/
+	if(((0 != client->output_length) || !caught_up) && (0 == client->output_source))
+	{
+		client->output_source = led_fd_add(client->socket, G_IO_OUT, client_writable, client);
+	}
+	if(!caught_up)
+	{
+		client->input_source = 0;	/*client_writable() reinstates it*/
+		return G_SOURCE_REMOVE;
+	}
+	return G_SOURCE_CONTINUE;
+}
+
+static gboolean client_connected(gint fd, GIOCondition condition, gpointer user_data)
+{
+	int socket = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if(0 > socket)
+	{
+		return G_SOURCE_CONTINUE;
+	}
+	struct ucred peer;
+	socklen_t peer_length = sizeof(peer);
+	if((0 != getsockopt(socket, SOL_SOCKET, SO_PEERCRED, &peer, &peer_length)) || ((0 != peer.uid) && (geteuid() != peer.uid)))
+	{
+		ERROR("Refusing control client!\n");
+		close(socket);
+		return G_SOURCE_CONTINUE;
+	}
+	int slot = -1;
+	for(unsigned int i = 0; i < MAX_CONTROL_CLIENTS; i++)
+	{
+		if(NULL == g_clients[i])
+		{
+			slot = i;
+			break;
+		}
+	}
+	if(0 > slot)
+	{
+		ERROR("Too many control clients!\n");
+		close(socket);
+		return G_SOURCE_CONTINUE;
+	}
+	controlClient_t *client = new controlClient_t;
+	client->socket = socket;
+	client->input_length = 0;
+	client->output_length = 0;
+	client->output_source = 0;
+	client->in_batch = false;
+	client->input_source = led_fd_add(socket, (GIOCondition)(G_IO_IN | G_IO_HUP | G_IO_ERR), client_readable, client);
+	g_clients[slot] = client;
+	INFO("Control client %d connected (pid %d)\n", slot, (int)peer.pid);
+	return G_SOURCE_CONTINUE;
+}
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+/**
+ * @brief This API starts accepting control clients (see controlsocket.hpp) on the main loop.
+ *
+ * @param[in] handler   Checks and runs each command.
+ *
+ * @return  Returns status of the operation.
+ */
+int open_control_socket(controlCommandHandler_t handler)
+{
+	if(0 <= g_listen_socket)
+	{
+		return 0;
+	}
+	g_handler = handler;
+
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	memcpy(address.sun_path + 1, CONTROL_SOCKET_NAME, sizeof(CONTROL_SOCKET_NAME) - 1);
+	socklen_t address_length = offsetof(struct sockaddr_un, sun_path) + sizeof(CONTROL_SOCKET_NAME);
+
+	g_listen_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(0 > g_listen_socket)
+	{
+		ERROR("Could not create control socket!\n");
+		return -1;
+	}
+	if((0 != bind(g_listen_socket, (struct sockaddr *)&address, address_length)) ||
+		(0 != listen(g_listen_socket, MAX_CONTROL_CLIENTS)))
+	{
+		ERROR("Could not listen on @%s!\n", CONTROL_SOCKET_NAME);
+		close(g_listen_socket);
+		g_listen_socket = -1;
+		return -1;
+	}
+	g_listen_source = led_fd_add(g_listen_socket, G_IO_IN, client_connected, NULL);
+	INFO("Accepting control clients on @%s\n", CONTROL_SOCKET_NAME);
+	return 0;
+}
+
+/**
+ * @brief This API stops accepting control clients and disconnects the connected ones. Open batches are dropped.
+ */
+void close_control_socket()
+{
+	if(0 > g_listen_socket)
+	{
+		return;
+	}
+	led_fd_remove(g_listen_source);
+	close(g_listen_socket);
+	g_listen_socket = -1;
+	for(unsigned int i = 0; i < MAX_CONTROL_CLIENTS; i++)
+	{
+		if(NULL != g_clients[i])
+		{
+			release_client(g_clients[i]);
+		}
+	}
+}
+
+/** @} */  //END OF GROUP LED_APIS
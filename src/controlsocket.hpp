@@ -0,0 +1,66 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef CONTROLSOCKET_H
+#define CONTROLSOCKET_H
+#include <stddef.h>
+
+/*Control socket: a line protocol on the abstract unix socket @ledmgr_control, for test automation and
+ * bring-up. Connect with e.g. "socat - ABSTRACT-CONNECT:ledmgr_control". Only root and ledmgr's own user
+ * may connect.
+ *
+ * Each line is a command, words separated by blanks; blank lines and lines starting with '#' are
+ * ignored. Every command gets exactly one reply line, in order, so clients may pipeline as many commands
+ * as they like without waiting:
+ *
+ *	OK <ns>[ <result>]
+ *	ERR <ns> <reason>
+ *
+ * where <ns> is how long the command took to run, in nanoseconds (0 if it did not run). "help" lists
+ * the commands.
+ *
+ * "begin" opens a batch: the commands that follow are checked but held back, and "commit" runs them back
+ * to back in a single main-loop dispatch with LED timer callbacks held off, so the whole batch lands
+ * between two edges. A batch runs only if every command in it checked out; otherwise none of it does.
+ * Replies to batched commands come on commit, followed by the reply to commit itself,
+ * "OK <ns> <count>". "abort" drops a batch, as does hanging up.
+ *
+ * A client that stops reading its replies is throttled: its commands are not read until the replies
+ * have gone out.*/
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+#define CONTROL_SOCKET_NAME "ledmgr_control"	/**< Abstract unix socket, @ledmgr_control */
+#define MAX_CONTROL_CLIENTS 4
+#define MAX_CONTROL_ARGS 40			/**< Words per command, verb included */
+#define CONTROL_LINE_LENGTH 512			/**< Longest command line, newline included */
+#define CONTROL_REPLY_LENGTH 512
+#define MAX_BATCH_COMMANDS 256
+
+/** Runs one command, or only checks it if execute is false. Writes the result or the reason for failing
+ * to reply. Returns 0 on success. */
+typedef int (*controlCommandHandler_t)(int argc, char *argv[], bool execute, char *reply, size_t reply_length);
+
+/* @} */ // End of group LED_TYPES
+
+int open_control_socket(controlCommandHandler_t handler);
+void close_control_socket();
+
+#endif /*CONTROLSOCKET_H*/
@@ -0,0 +1,294 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "debouncer.hpp"
+#include "ledtiming.hpp"
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+/**
+ * @brief Callback function fired when a held-back transition may be due.
+ *
+ * @param[in] data      address of the debouncer.
+ *
+ * @return  Returns true; the wake-up source is re-armed for the next due channel.
+ */
+static gboolean masterDebounceCallbackFunction(gpointer data)
+{
+	eventDebouncer *debouncer = (eventDebouncer *)data;
+	debouncer->expireDue();
+	return G_SOURCE_CONTINUE;
+}
+
+eventDebouncer::eventDebouncer()
+{
+	m_num_channels = 0;
+	m_handler = NULL;
+	m_wakeup = NULL;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_init(&m_mutex, NULL));
+}
+
+eventDebouncer::~eventDebouncer()
+{
+	if(NULL != m_wakeup)
+	{
+		led_wakeup_free(m_wakeup);
+	}
+	pthread_mutex_destroy(&m_mutex);
+}
+
+/**
+ * @brief This API debounces a sys-state ID. Configure before events are handled.
+ *
+ * @return  Returns status of the operation.
+ */
+int eventDebouncer::configure(unsigned int state_id, const debounceConfig_t &config)
+{
+	int ret = 0;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	debounceChannel_t *channel = findChannel(state_id);
+	if(NULL != channel)
+	{
+		channel->config = config;
+	}
+	else if(MAX_DEBOUNCED_STATES > m_num_channels)
+	{
+		channel = &m_channels[m_num_channels++];
+		channel->state_id = state_id;
+		channel->config = config;
+		channel->has_delivered = false;
+		channel->has_pending = false;
+		channel->timer_due_us = 0;
+		channel->raw_events = 0;
+		channel->delivered_events = 0;
+		if(NULL == m_wakeup)
+		{
+			/*Created here rather than on the first event, so that debouncing never allocates.*/
+			m_wakeup = led_wakeup_new(masterDebounceCallbackFunction, this);
+		}
+	}
+	else
+	{
+		ERROR("No room to debounce sys-state %u!\n", state_id);
+		ret = -1;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return ret;
+}
+
+void eventDebouncer::setHandler(debouncedEventHandler_t handler)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	m_handler = handler;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API takes a raw sys-state event. Unconfigured state IDs are handed on immediately, on the
+ * calling thread; the others are held back until stable.
+ */
+void eventDebouncer::submit(unsigned int state_id, int state, int error)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	debouncedEventHandler_t handler = m_handler;
+	debounceChannel_t *channel = findChannel(state_id);
+	if(NULL == channel)
+	{
+		REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+		if(NULL != handler)
+		{
+			handler(state_id, state, error);
+		}
+		return;
+	}
+
+	channel->raw_events++;
+	if(channel->has_delivered && (state == channel->delivered_state))
+	{
+		/*Back where it was: whatever was pending is absorbed.*/
+		channel->has_pending = false;
+	}
+	else if(channel->has_pending && (state == channel->pending_state))
+	{
+		/*Repeat of the pending state; the hold time runs from the first one.*/
+		channel->pending_error = error;
+	}
+	else
+	{
+		gint64 now_us = led_monotonic_us();
+		unsigned int hold_ms = (0 != state) ? channel->config.rise_ms : channel->config.fall_ms;
+		channel->has_pending = true;
+		channel->pending_state = state;
+		channel->pending_error = error;
+		channel->pending_due_us = now_us + ((gint64)hold_ms * 1000);
+		if(channel->has_delivered)
+		{
+			gint64 shown_until_us = channel->delivered_us + ((gint64)channel->config.min_display_ms * 1000);
+			if(shown_until_us > channel->pending_due_us)
+			{
+				channel->pending_due_us = shown_until_us;
+			}
+		}
+		armTimer(*channel);
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API delivers the channel's pending transition if it is due. Runs on the main loop.
+ */
+void eventDebouncer::expire(debounceChannel_t &channel)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	gint64 now_us = led_monotonic_us();
+	if(channel.timer_due_us <= now_us)
+	{
+		channel.timer_due_us = 0;
+	}
+	if(!channel.has_pending)
+	{
+		REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+		return;
+	}
+	if(channel.pending_due_us > now_us)
+	{
+		armTimer(channel);
+		REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+		return;
+	}
+	channel.has_pending = false;
+	channel.has_delivered = true;
+	channel.delivered_state = channel.pending_state;
+	channel.delivered_us = now_us;
+	channel.delivered_events++;
+	int state = channel.pending_state;
+	int error = channel.pending_error;
+	debouncedEventHandler_t handler = m_handler;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+
+	/*Not under m_mutex: the handler takes indicator locks. Deliveries are serialized by the main loop.*/
+	if(NULL != handler)
+	{
+		handler(channel.state_id, state, error);
+	}
+}
+
+/**
+ * @brief This API runs expire() on every channel whose timer is due, then sleeps until the next one. Runs
+ * on the main loop.
+ */
+void eventDebouncer::expireDue()
+{
+	debounceChannel_t *due[MAX_DEBOUNCED_STATES];
+	unsigned int num_due = 0;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	gint64 now_us = led_monotonic_us();
+	for(unsigned int i = 0; i < m_num_channels; i++)
+	{
+		if((0 != m_channels[i].timer_due_us) && (m_channels[i].timer_due_us <= now_us))
+		{
+			due[num_due++] = &m_channels[i];
+		}
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+
+	for(unsigned int i = 0; i < num_due; i++)
+	{
+		expire(*due[i]);
+	}
+
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	rescheduleLocked();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API reports how many raw events a channel took and how many transitions it passed on; the
+ * difference was absorbed.
+ *
+ * @return  Returns status of the operation.
+ */
+int eventDebouncer::getCounters(unsigned int state_id, unsigned int &raw_events, unsigned int &delivered_events)
+{
+	int ret = -1;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	debounceChannel_t *channel = findChannel(state_id);
+	if(NULL != channel)
+	{
+		raw_events = channel->raw_events;
+		delivered_events = channel->delivered_events;
+		ret = 0;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return ret;
+}
+
+void eventDebouncer::diagnostics()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	for(unsigned int i = 0; i < m_num_channels; i++)
+	{
+		const debounceChannel_t &channel = m_channels[i];
+		INFO("Sys-state %u: rise %u ms, fall %u ms, min display %u ms; %u raw events, %u delivered, %u absorbed\n",
+			channel.state_id, channel.config.rise_ms, channel.config.fall_ms, channel.config.min_display_ms,
+			channel.raw_events, channel.delivered_events, channel.raw_events - channel.delivered_events);
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/** @} */  //END OF GROUP LED_APIS
+
+debounceChannel_t * eventDebouncer::findChannel(unsigned int state_id)
+{
+	for(unsigned int i = 0; i < m_num_channels; i++)
+	{
+		if(state_id == m_channels[i].state_id)
+		{
+			return &m_channels[i];
+		}
+	}
+	return NULL;
+}
+
+/*Sets the channel's timer to when the pending transition is due. Called with m_mutex held.*/
+void eventDebouncer::armTimer(debounceChannel_t &channel)
+{
+	channel.timer_due_us = channel.pending_due_us;
+	rescheduleLocked();
+}
+
+/*Points the wake-up source at the earliest channel timer. Called with m_mutex held.*/
+void eventDebouncer::rescheduleLocked()
+{
+	gint64 next_us = -1;
+	for(unsigned int i = 0; i < m_num_channels; i++)
+	{
+		gint64 due_us = m_channels[i].timer_due_us;
+		if((0 != due_us) && ((-1 == next_us) || (due_us < next_us)))
+		{
+			next_us = due_us;
+		}
+	}
+	if(NULL != m_wakeup)
+	{
+		led_wakeup_set(m_wakeup, next_us);
+	}
+}
@@ -0,0 +1,95 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef DEBOUNCER_H
+#define DEBOUNCER_H
+#include "ledmgr_types.hpp"
+#include "pthread.h"
+#include "ledloop.hpp"
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+#define MAX_DEBOUNCED_STATES 16
+
+typedef struct
+{
+	unsigned int rise_ms;		/**< A change to a non-zero state is passed on once it has held this long */
+	unsigned int fall_ms;		/**< A change to state zero is passed on once it has held this long */
+	unsigned int min_display_ms;	/**< A state that was passed on is kept at least this long */
+}debounceConfig_t;
+
+/** Receives the transitions that survived debouncing, on the main loop. */
+typedef void (*debouncedEventHandler_t)(unsigned int state_id, int state, int error);
+
+typedef struct
+{
+	unsigned int state_id;
+	debounceConfig_t config;
+	bool has_delivered;
+	int delivered_state;
+	gint64 delivered_us;
+	bool has_pending;
+	int pending_state;
+	int pending_error;
+	gint64 pending_due_us;
+	gint64 timer_due_us;		/**< Earliest armed timer, 0 if none */
+	unsigned int raw_events;
+	unsigned int delivered_events;
+}debounceChannel_t;
+
+/* @} */ // End of group LED_TYPES
+
+/*Debounce stage for sys-state events. Each configured state ID is a channel: a raw change is held back
+ * until it has been stable for the channel's rise or fall time, and until the previously delivered state
+ * has been shown for its minimum display time. A change that reverts before then is absorbed, so the
+ * handler sees only stable transitions. Unconfigured state IDs pass straight through.
+ *
+ * Raw events may come from any thread; debounced ones are delivered from the main loop, in order.
+ * All channels share one main-loop source woken for the earliest channel timer, so flapping inputs cost
+ * no allocation. Timers are never cancelled: a timer that finds nothing due just lapses.*/
+class eventDebouncer
+{
+	private:
+		pthread_mutex_t m_mutex;
+		debounceChannel_t m_channels[MAX_DEBOUNCED_STATES];
+		unsigned int m_num_channels;
+		debouncedEventHandler_t m_handler;
+		ledWakeup_t *m_wakeup;
+
+		eventDebouncer(const eventDebouncer &);
+		eventDebouncer& operator=(const eventDebouncer &);
+
+	public:
+		eventDebouncer();
+		~eventDebouncer();
+		int configure(unsigned int state_id, const debounceConfig_t &config);
+		void setHandler(debouncedEventHandler_t handler);
+		void submit(unsigned int state_id, int state, int error);
+		void expire(debounceChannel_t &channel);
+		void expireDue();
+		int getCounters(unsigned int state_id, unsigned int &raw_events, unsigned int &delivered_events);
+		void diagnostics();
+	private:
+		debounceChannel_t * findChannel(unsigned int state_id);
+		void armTimer(debounceChannel_t &channel);
+		void rescheduleLocked();
+};
+
+#endif /*DEBOUNCER_H*/
@@ -0,0 +1,301 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "ledbackend.hpp"
+#include "asyncbackend.hpp"
+#include "ledmgr_types.hpp"
+#include "pthread.h"
+#include "frontPanelConfig.hpp"
+
+/*Device Settings implementation of the hardware interface. DS reports failures through
+ * exceptions; they are contained here.*/
+class dsBackend : public ledBackend
+{
+	private:
+		pthread_mutex_t m_mutex;
+		int m_num_handles;
+		device::FrontPanelIndicator *m_indicators[MAX_LED_HANDLES];
+		ledCapabilities_t m_capabilities[MAX_LED_HANDLES];
+
+	public:
+		dsBackend();
+		~dsBackend();
+		virtual int open(const std::string &name);
+		virtual int setState(int handle, bool enable);
+		virtual int setBrightness(int handle, unsigned int intensity);
+		virtual int getBrightness(int handle, unsigned int &intensity);
+		virtual int setColor(int handle, unsigned int color);
+		virtual int getColor(int handle, unsigned int &color);
+		virtual int listIndicators(std::vector<std::string> &names);
+		virtual int getCapabilities(int handle, ledCapabilities_t &capabilities);
+	private:
+		device::FrontPanelIndicator * lookup(int handle) const;
+		void probe(int handle);
+};
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+dsBackend::dsBackend()
+{
+	m_num_handles = 0;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_init(&m_mutex, NULL));
+}
+
+dsBackend::~dsBackend()
+{
+	pthread_mutex_destroy(&m_mutex);
+}
+
+/*Handles are published by open() only once their slot is filled, so lookups need no lock.*/
+device::FrontPanelIndicator * dsBackend::lookup(int handle) const
+{
+	if((0 > handle) || (__atomic_load_n(&m_num_handles, __ATOMIC_ACQUIRE) <= handle))
+	{
+		ERROR("Invalid handle %d!\n", handle);
+		return NULL;
+	}
+	return m_indicators[handle];
+}
+
+/**
+ * @brief This API looks up the named indicator in DS and caches a reference to it. This is safe because
+ * we don't expect the indicator instances in DS to change once initialized.
+ *
+ * @param[in] name   indicator name.
+ *
+ * @return  Returns handle for the indicator or -1 on failure.
+ */
+int dsBackend::open(const std::string &name)
+{
+	int handle = -1;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	for(int i = 0; i < m_num_handles; i++)
+	{
+		if(0 == name.compare(m_indicators[i]->getName()))
+		{
+			handle = i;
+			break;
+		}
+	}
+	if((-1 == handle) && (MAX_LED_HANDLES > m_num_handles))
+	{
+		try
+		{
+			m_indicators[m_num_handles] = &(device::FrontPanelConfig::getInstance().getIndicator(name));
+			probe(m_num_handles);
+			handle = m_num_handles;
+			__atomic_store_n(&m_num_handles, handle + 1, __ATOMIC_RELEASE);
+		}
+		catch(...)
+		{
+			ERROR("No indicator %s in DS!\n", name.c_str());
+		}
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return handle;
+}
+
+int dsBackend::setState(int handle, bool enable)
+{
+	device::FrontPanelIndicator *fp_indicator = lookup(handle);
+	if(NULL == fp_indicator)
+	{
+		return -1;
+	}
+	try
+	{
+		fp_indicator->setState(enable);
+	}
+	catch(...)
+	{
+		ERROR("Could not change indicator state!\n");
+		return -1;
+	}
+	return 0;
+}
+
+int dsBackend::setBrightness(int handle, unsigned int intensity)
+{
+	device::FrontPanelIndicator *fp_indicator = lookup(handle);
+	if(NULL == fp_indicator)
+	{
+		return -1;
+	}
+	try
+	{
+		fp_indicator->setBrightness(intensity, false);
+	}
+	catch(...)
+	{
+		ERROR("Error setting indicator brightness!\n");
+		return -1;
+	}
+	return 0;
+}
+
+int dsBackend::getBrightness(int handle, unsigned int &intensity)
+{
+	device::FrontPanelIndicator *fp_indicator = lookup(handle);
+	if(NULL == fp_indicator)
+	{
+		return -1;
+	}
+	try
+	{
+		intensity = fp_indicator->getBrightness();
+	}
+	catch(...)
+	{
+		ERROR("Could not read brightness!\n");
+		return -1;
+	}
+	return 0;
+}
+
+int dsBackend::setColor(int handle, unsigned int color)
+{
+	device::FrontPanelIndicator *fp_indicator = lookup(handle);
+	if(NULL == fp_indicator)
+	{
+		return -1;
+	}
+	try
+	{
+		fp_indicator->setColor(color, false);
+	}
+	catch(...)
+	{
+		ERROR("Error setting color!\n");
+		return -1;
+	}
+	return 0;
+}
+
+int dsBackend::getColor(int handle, unsigned int &color)
+{
+	device::FrontPanelIndicator *fp_indicator = lookup(handle);
+	if(NULL == fp_indicator)
+	{
+		return -1;
+	}
+	try
+	{
+		color = fp_indicator->getColor();
+	}
+	catch(...)
+	{
+		ERROR("Could not read color!\n");
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief This API lists the indicators the platform's front panel configuration declares.
+ *
+ * @param[out] names   receives the indicator names.
+ *
+ * @return  Returns status of the operation.
+ */
+int dsBackend::listIndicators(std::vector<std::string> &names)
+{
+	try
+	{
+		device::List<device::FrontPanelIndicator> indicators = device::FrontPanelConfig::getInstance().getIndicators();
+		for(size_t i = 0; i < indicators.size(); i++)
+		{
+			names.push_back(indicators.at(i).getName());
+		}
+	}
+	catch(...)
+	{
+		ERROR("Could not list indicators!\n");
+		return -1;
+	}
+	return 0;
+}
+
+int dsBackend::getCapabilities(int handle, ledCapabilities_t &capabilities)
+{
+	if(NULL == lookup(handle))
+	{
+		return -1;
+	}
+	capabilities = m_capabilities[handle];
+	return 0;
+}
+
+/*Finds out once, while the indicator is opened, which calls DS supports for it. A mono LED throws on
+ * every color call and a fixed-brightness one on every brightness call; with the result cached,
+ * indicators never make those calls. Every DS indicator can be switched on and off.*/
+void dsBackend::probe(int handle)
+{
+	device::FrontPanelIndicator *fp_indicator = m_indicators[handle];
+	ledCapabilities_t &capabilities = m_capabilities[handle];
+	capabilities.mask = LED_CAP_STATE | LED_CAP_BLINK;
+	capabilities.min_brightness = 0;
+	capabilities.max_brightness = 0;
+	try
+	{
+		int levels = 0;
+		int min_brightness = 0;
+		int max_brightness = 0;
+		fp_indicator->getBrightnessLevels(levels, min_brightness, max_brightness);
+		fp_indicator->getBrightness();
+		if((1 < levels) && (0 <= min_brightness) && (min_brightness < max_brightness))
+		{
+			capabilities.mask |= LED_CAP_BRIGHTNESS;
+			capabilities.min_brightness = min_brightness;
+			capabilities.max_brightness = max_brightness;
+		}
+	}
+	catch(...)
+	{
+		/*No brightness control.*/
+	}
+	try
+	{
+		if(0 != fp_indicator->getColorMode())
+		{
+			fp_indicator->getColor();
+			capabilities.mask |= LED_CAP_COLOR;
+		}
+	}
+	catch(...)
+	{
+		/*Mono LED.*/
+	}
+	INFO("Indicator %s: capabilities 0x%x, brightness %u-%u\n", fp_indicator->getName().c_str(), capabilities.mask,
+		capabilities.min_brightness, capabilities.max_brightness);
+}
+
+/**
+ * @brief This API returns the backend used by the daemon: Device Settings, driven from a dedicated I/O
+ * thread so that a slow dsmgr never stalls indicator timing.
+ */
+ledBackend& getDefaultLedBackend()
+{
+	static dsBackend ds_backend;
+	static asyncBackend backend(ds_backend);
+	return backend;
+}
+
+/** @} */  //END OF GROUP LED_APIS
@@ -0,0 +1,511 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef LEDMGR_MINIMAL
+#include <iostream>
+#endif
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "libIBus.h"
+#include "sysMgr.h"
+#include "libIBusDaemon.h"
+#include "irMgr.h"
+#include "pwrMgr.h"
+
+#include "ledmgr_types.hpp"
+#include "ledmgr.hpp"
+#include "eventhandlers.hpp"
+#include "eventrecorder.hpp"
+#include "ledmgr_ipc.h"
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+/** @brief This API is used to trace the debug logs prints.
+ *
+ *  @param[in] state  system state
+ */
+void trace_event(int state)
+{
+#ifdef LEDMGR_MINIMAL
+	/*The minimal profile leaves out the name table.*/
+	INFO("Detected event %d\n", state);
+#else
+#define HANDLE(event) case event:\
+	std::cout<<"Detected event "<<#event<<std::endl;\
+	break;
+
+	switch(state)
+	{
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_CHANNELMAP);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_DISCONNECTMGR);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_TUNEREADY);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_EXIT_OK);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_CMAC);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_MOTO_ENTITLEMENT);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_MOTO_HRV_RX);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_CARD_CISCO_STATUS);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_VIDEO_PRESENTING);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_HDMI_OUT);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_HDCP_ENABLED);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_HDMI_EDID_READ);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_FIRMWARE_DWNLD);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_TIME_SOURCE);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_TIME_ZONE);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_CA_SYSTEM);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_ESTB_IP);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_ECM_IP);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_LAN_IP);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_MOCA);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_DOCSIS);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_DSG_BROADCAST_CHANNEL);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_DSG_CA_TUNNEL);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_CABLE_CARD);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_CABLE_CARD_DWNLD);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_CVR_SUBSYSTEM);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_DOWNLOAD);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_VOD_AD);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_DAC_INIT_TIMESTAMP);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_CABLE_CARD_SERIAL_NO);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_ECM_MAC);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_DAC_ID);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_PLANT_ID);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_STB_SERIAL_NO);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_BOOTUP);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_GATEWAY_CONNECTION);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_DST_OFFSET);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_RF_CONNECTED);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_PARTNERID_CHANGE);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_IP_MODE);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_LP_CONNECTION_RESET);
+		HANDLE(IARM_BUS_SYSMGR_SYSSTATE_RWS_CONNECTION_RESET);
+		default:
+			break;
+	}
+#undef HANDLE
+#endif
+}
+
+/** @brief This API  receives the IR events from IR manager to handle the detected key pressed and give LED indication accordingly using received keycode and type.
+ *
+ *  @param[in] owner  	owner of the event
+ *  @param[in] eventId  event ID
+ *  @param[in] data 	event data
+ *  @param[in] len  	event size
+ */
+void keyEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
+{
+	record_event(EVENT_SOURCE_IRMGR, eventId, data, sizeof(IARM_Bus_IRMgr_EventData_t));
+	if( IARM_BUS_PWRMGR_POWERSTATE_STANDBY_DEEP_SLEEP != ledMgr::getInstance().getPowerState() )
+	{
+		IARM_Bus_IRMgr_EventData_t *irEventData = (IARM_Bus_IRMgr_EventData_t*) data;
+		ledMgr::getInstance().handleKeyPress(irEventData->data.irkey.keyCode, irEventData->data.irkey.keyType);	
+	}
+	else
+		INFO("power state is deepsleep, handleKeyPress not invoked");
+	return;
+}
+
+/** @brief This API handles power mode change events received from power manager.
+ *
+ *  Power Manager monitors Power IR key events and reacts to power state changes.
+ *
+ *  @param[in] owner  	owner of the event
+ *  @param[in] eventId  power manager event ID
+ *  @param[in] data  	event data
+ *  @param[in] len 	event size
+ */
+void powerEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
+{
+	IARM_Bus_PWRMgr_EventData_t *eventData = (IARM_Bus_PWRMgr_EventData_t *)data;
+	record_event(EVENT_SOURCE_PWRMGR, eventId, data, sizeof(IARM_Bus_PWRMgr_EventData_t));
+	switch(eventId)
+	{
+		case IARM_BUS_PWRMGR_EVENT_MODECHANGED:
+			ledMgr::getInstance().setPowerState(eventData->data.state.newState);
+			INFO("Detected power status change to 0x%x\n", eventData->data.state.newState);
+			break;
+
+		case IARM_BUS_PWRMGR_EVENT_RESET_SEQUENCE:
+			if(0 <= eventData->data.reset_sequence_progress)
+			{
+				INFO("Reset sequence %d.\n", eventData->data.reset_sequence_progress);
+				ledMgr::getInstance().handleDeviceReset(eventData->data.reset_sequence_progress);
+			}
+			else
+			{
+				INFO("Exit reset sequence.\n");
+				ledMgr::getInstance().handleDeviceResetAbort();
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/** @brief This callback notification received when there is a system mode change to handle from  IARM manager.
+ *
+ *  @param[in] arg  system mode change param
+ *
+ *  @return Returns status of the operation.
+ */
+IARM_Result_t modeChangeHandler(void *arg)
+{
+	IARM_Bus_CommonAPI_SysModeChange_Param_t *param = (IARM_Bus_CommonAPI_SysModeChange_Param_t *)arg;
+	record_event(EVENT_SOURCE_SYSMODE, 0, arg, sizeof(IARM_Bus_CommonAPI_SysModeChange_Param_t));
+	if(0 == (ledMgr::getInstance().getEventInterest() & EVENT_CLASS_SYS_MODE))
+	{
+		return IARM_RESULT_SUCCESS;
+	}
+	ledMgr::getInstance().setSysMode((unsigned int) param->newMode);
+	ledMgr::getInstance().handleModeChange((unsigned int) param->newMode);
+	return IARM_RESULT_SUCCESS;
+}
+
+/** @brief This RPC registers a custom keyframe pattern on behalf of another component.
+ *
+ *  @param[in,out] arg  IARM_Bus_LEDMgr_RegisterPattern_Param_t
+ *
+ *  @return Returns status of the operation.
+ */
+IARM_Result_t registerPatternHandler(void *arg)
+{
+	IARM_Bus_LEDMgr_RegisterPattern_Param_t *param = (IARM_Bus_LEDMgr_RegisterPattern_Param_t *)arg;
+	param->handle = LEDMGR_INVALID_PATTERN_HANDLE;
+	param->result = -1;
+	if((0 == param->num_keyframes) || (LEDMGR_MAX_PATTERN_KEYFRAMES < param->num_keyframes) ||
+		(LEDMGR_MAX_PATTERN_COLORS < param->num_colors))
+	{
+		ERROR("Bad pattern size!\n");
+		return IARM_RESULT_INVALID_PARAM;
+	}
+	keyframe_t keyframes[LEDMGR_MAX_PATTERN_KEYFRAMES];
+	for(unsigned int i = 0; i < param->num_keyframes; i++)
+	{
+		const IARM_Bus_LEDMgr_Keyframe_t &wire = param->keyframes[i];
+		if((MAX_KEYFRAME_COLORS < wire.color_index) || (EASING_OUT < wire.easing))
+		{
+			ERROR("Bad keyframe %u!\n", i);
+			return IARM_RESULT_INVALID_PARAM;
+		}
+		keyframes[i].duration = wire.duration;
+		keyframes[i].brightness = wire.brightness;
+		keyframes[i].color_index = wire.color_index;
+		keyframes[i].easing = wire.easing;
+	}
+	unsigned int handle;
+	if(0 == ledMgr::getInstance().registerPattern(keyframes, param->num_keyframes, param->palette, param->num_colors, handle))
+	{
+		param->handle = handle;
+		param->result = 0;
+	}
+	return IARM_RESULT_SUCCESS;
+}
+
+/** @brief This RPC releases a pattern handle obtained through registerPatternHandler().
+ *
+ *  @param[in,out] arg  IARM_Bus_LEDMgr_ReleasePattern_Param_t
+ *
+ *  @return Returns status of the operation.
+ */
+IARM_Result_t releasePatternHandler(void *arg)
+{
+	IARM_Bus_LEDMgr_ReleasePattern_Param_t *param = (IARM_Bus_LEDMgr_ReleasePattern_Param_t *)arg;
+	param->result = ledMgr::getInstance().releasePattern(param->handle);
+	return IARM_RESULT_SUCCESS;
+}
+
+/** @brief This RPC plays a registered pattern on an indicator.
+ *
+ *  @param[in,out] arg  IARM_Bus_LEDMgr_PlayPattern_Param_t
+ *
+ *  @return Returns status of the operation.
+ */
+IARM_Result_t playPatternHandler(void *arg)
+{
+	IARM_Bus_LEDMgr_PlayPattern_Param_t *param = (IARM_Bus_LEDMgr_PlayPattern_Param_t *)arg;
+	char name[LEDMGR_INDICATOR_NAME_LENGTH + 1];
+	strncpy(name, param->indicator, LEDMGR_INDICATOR_NAME_LENGTH);
+	name[LEDMGR_INDICATOR_NAME_LENGTH] = '\0';
+	param->result = ledMgr::getInstance().playPattern(name, param->handle, param->repetitions);
+	return IARM_RESULT_SUCCESS;
+}
+
+/** @brief To handle IARM BUS system state event callback.
+ *
+ *  @param[in] owner  	owner of the event
+ *  @param[in] eventId  event ID
+ *  @param[in] data  	event data
+ *  @param[in] len 	event size
+ */
+void sysEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
+{
+	IARM_Bus_SYSMgr_EventData_t *sysEventData = (IARM_Bus_SYSMgr_EventData_t*)data;
+	record_event(EVENT_SOURCE_SYSMGR, eventId, data, sizeof(IARM_Bus_SYSMgr_EventData_t));
+	IARM_Bus_SYSMgr_SystemState_t stateId = sysEventData->data.systemStates.stateId;
+	if(!ledMgr::getInstance().isSysStateSubscribed(stateId))
+	{
+		return;
+	}
+	trace_event(stateId);
+	ledMgr::getInstance().getDebouncer().submit(stateId, sysEventData->data.systemStates.state,
+		sysEventData->data.systemStates.error);
+}
+
+/** @brief To hand a sys-state transition that passed the debounce stage to the OEM handlers.
+ *
+ *  @param[in] stateId  sys-state ID
+ *  @param[in] state  	new state
+ *  @param[in] error  	error code reported with it
+ */
+void sysStateHandler(unsigned int stateId, int state, int error)
+{
+	ledMgr::getInstance().setSysStateValue(stateId, state);
+	switch(stateId)
+	{
+		case IARM_BUS_SYSMGR_SYSSTATE_CHANNELMAP:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_DISCONNECTMGR:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_TUNEREADY:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_EXIT_OK:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_CMAC:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_MOTO_ENTITLEMENT:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_MOTO_HRV_RX:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_CARD_CISCO_STATUS:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_VIDEO_PRESENTING:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_HDMI_OUT:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_HDCP_ENABLED:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_HDMI_EDID_READ:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_FIRMWARE_DWNLD:
+			ledMgr::getInstance().handleCDLEvents(state);
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_TIME_SOURCE:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_TIME_ZONE:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_CA_SYSTEM:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_ESTB_IP:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_ECM_IP:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_LAN_IP:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_MOCA:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_DOCSIS:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_DSG_BROADCAST_CHANNEL:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_DSG_CA_TUNNEL:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_CABLE_CARD:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_CABLE_CARD_DWNLD:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_CVR_SUBSYSTEM:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_DOWNLOAD:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_VOD_AD:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_DAC_INIT_TIMESTAMP:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_CABLE_CARD_SERIAL_NO:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_ECM_MAC:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_DAC_ID:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_PLANT_ID:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_STB_SERIAL_NO:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_BOOTUP:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_GATEWAY_CONNECTION:
+			ledMgr::getInstance().handleGatewayConnectionEvent(state, error);
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_DST_OFFSET:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_RF_CONNECTED:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_PARTNERID_CHANGE:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_IP_MODE:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_LP_CONNECTION_RESET:
+			break;
+		case IARM_BUS_SYSMGR_SYSSTATE_RWS_CONNECTION_RESET:
+			break;
+		default:
+			break;
+	}
+}
+
+typedef struct
+{
+	unsigned int event_class;
+	const char *owner;
+	IARM_EventId_t event_id;
+	IARM_EventHandler_t handler;
+}eventRegistration_t;
+
+static const eventRegistration_t g_event_registrations[] =
+{
+	{EVENT_CLASS_SYSTEM_STATE, IARM_BUS_SYSMGR_NAME, IARM_BUS_SYSMGR_EVENT_SYSTEMSTATE, sysEventHandler},
+	{EVENT_CLASS_POWER_MODE, IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_EVENT_MODECHANGED, powerEventHandler},
+	{EVENT_CLASS_RESET_SEQUENCE, IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_EVENT_RESET_SEQUENCE, powerEventHandler},
+	{EVENT_CLASS_IR_KEY, IARM_BUS_IRMGR_NAME, IARM_BUS_IRMGR_EVENT_IRKEY, keyEventHandler},
+};
+#define NUM_EVENT_REGISTRATIONS (sizeof(g_event_registrations) / sizeof(g_event_registrations[0]))
+
+static pthread_mutex_t g_subscription_mutex = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int g_subscribed_events = 0;
+
+/**
+ * @brief This API brings the bus registrations in line with the requested event classes, registering
+ * new ones and releasing those no longer wanted.
+ *
+ * The SysModeChange RPC cannot be unregistered from the bus; once registered, modeChangeHandler()
+ * drops the call when the class is not subscribed.
+ *
+ * @param[in] event_classes   bitmask of eventClass_t values.
+ *
+ * @return  Returns status of the operation.
+ */
+static int32_t apply_event_subscriptions(unsigned int event_classes)
+{
+	int32_t ret = 0;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_subscription_mutex));
+	for(unsigned int i = 0; i < NUM_EVENT_REGISTRATIONS; i++)
+	{
+		const eventRegistration_t &reg = g_event_registrations[i];
+		bool wanted = (0 != (event_classes & reg.event_class));
+		bool subscribed = (0 != (g_subscribed_events & reg.event_class));
+
+		if(wanted && !subscribed)
+		{
+			if(0 != IARM_Bus_RegisterEventHandler(reg.owner, reg.event_id, reg.handler))
+			{
+				ERROR("Could not register for %s event %d\n", reg.owner, reg.event_id);
+				ret = -1;
+				continue;
+			}
+			g_subscribed_events |= reg.event_class;
+		}
+		else if(!wanted && subscribed)
+		{
+			IARM_Bus_UnRegisterEventHandler(reg.owner, reg.event_id);
+			g_subscribed_events &= ~reg.event_class;
+		}
+	}
+
+	if((0 != (event_classes & EVENT_CLASS_SYS_MODE)) && (0 == (g_subscribed_events & EVENT_CLASS_SYS_MODE)))
+	{
+		if(0 != IARM_Bus_RegisterCall(IARM_BUS_COMMON_API_SysModeChange, modeChangeHandler))
+		{
+			ERROR("Could not register for sys mode changes\n");
+			ret = -1;
+		}
+		else
+		{
+			g_subscribed_events |= EVENT_CLASS_SYS_MODE;
+		}
+	}
+	INFO("Subscribed event classes: 0x%x\n", g_subscribed_events);
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_subscription_mutex));
+	return ret;
+}
+
+/**
+ * @brief Subscription listener invoked when the OEM implementation changes its event interest at runtime.
+ */
+static void subscription_changed(unsigned int event_classes)
+{
+	REPORT_IF_UNEQUAL(0, apply_event_subscriptions(event_classes));
+}
+
+/**
+ * @brief To Register required IARM event handlers with appropriate callback function to handle the event.
+ *
+ * Only the event classes declared by the OEM implementation are subscribed to.
+ */
+int32_t init_event_handlers()
+{
+	ledMgr::getInstance().getDebouncer().setHandler(sysStateHandler);
+	if(0 != apply_event_subscriptions(ledMgr::getInstance().getEventInterest() & ~EVENT_CLASS_SYS_MODE))
+	{
+		goto err;
+	}
+
+	IARM_Bus_PWRMgr_GetPowerState_Param_t power_query_arg;
+	REPORT_IF_UNEQUAL(IARM_RESULT_SUCCESS, IARM_Bus_Call(IARM_BUS_PWRMGR_NAME, "GetPowerState", (void *)&power_query_arg, sizeof(power_query_arg)));
+	ledMgr::getInstance().setPowerState(power_query_arg.curState);
+
+	if(0 != apply_event_subscriptions(ledMgr::getInstance().getEventInterest()))
+	{
+		goto err;
+	}
+	ledMgr::getInstance().setSubscriptionListener(subscription_changed);
+
+	if((IARM_RESULT_SUCCESS != IARM_Bus_RegisterCall(IARM_BUS_LEDMGR_API_RegisterPattern, registerPatternHandler)) ||
+		(IARM_RESULT_SUCCESS != IARM_Bus_RegisterCall(IARM_BUS_LEDMGR_API_ReleasePattern, releasePatternHandler)) ||
+		(IARM_RESULT_SUCCESS != IARM_Bus_RegisterCall(IARM_BUS_LEDMGR_API_PlayPattern, playPatternHandler)))
+	{
+		ERROR("Could not register pattern RPCs\n");
+		goto err;
+	}
+	INFO("Successfully initialized event handlers\n");
+	return 0;
+	
+	/*Clean exit if there are errors.*/
+err:
+	apply_event_subscriptions(0);
+	ERROR("Error initializing event handlers\n");
+	return -1;
+}
+
+/**
+ * @brief This API UnRegister IARM event handlers in order to release bus-facing resources.
+ */
+int32_t term_event_handlers()
+{
+	ledMgr::getInstance().setSubscriptionListener(NULL);
+	apply_event_subscriptions(0);
+	ledMgr::getInstance().getDebouncer().setHandler(NULL);
+	INFO("Successfully terminated all event handlers\n");
+	return 0;
+}
+
+
+/** @} */  //END OF GROUP LED_APIS
@@ -0,0 +1,36 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef EVENTHANDLERS_H
+#define EVENTHANDLERS_H
+#include <stdint.h>
+#include "libIBus.h"
+
+void trace_event(int state);
+void keyEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
+void powerEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
+IARM_Result_t modeChangeHandler(void *arg);
+IARM_Result_t registerPatternHandler(void *arg);
+IARM_Result_t releasePatternHandler(void *arg);
+IARM_Result_t playPatternHandler(void *arg);
+void sysEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
+void sysStateHandler(unsigned int stateId, int state, int error);
+int32_t init_event_handlers();
+int32_t term_event_handlers();
+
+#endif /*EVENTHANDLERS_H*/
@@ -0,0 +1,197 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "libIBusDaemon.h"
+#include "sysMgr.h"
+#include "irMgr.h"
+#include "pwrMgr.h"
+#include "ledmgr_types.hpp"
+#include "eventrecorder.hpp"
+
+static pthread_mutex_t g_recorder_mutex = PTHREAD_MUTEX_INITIALIZER;
+static FILE *g_event_log = NULL;
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+/**
+ * @brief This API returns CLOCK_MONOTONIC in microseconds.
+ */
+uint64_t get_monotonic_time_us()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t)now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+}
+
+/**
+ * @brief This API opens the binary event log and starts recording every inbound event.
+ *
+ * @param[in] path   log file to create.
+ *
+ * @return  Returns status of the operation.
+ */
+int start_event_recording(const char *path)
+{
+	FILE *log = fopen(path, "wb");
+	if(NULL == log)
+	{
+		ERROR("Could not open %s for recording!\n", path);
+		return -1;
+	}
+	eventLogHeader_t header = {EVENT_LOG_MAGIC, EVENT_LOG_VERSION, 0};
+	if(1 != fwrite(&header, sizeof(header), 1, log))
+	{
+		ERROR("Could not write log header!\n");
+		fclose(log);
+		return -1;
+	}
+	fflush(log);
+
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_recorder_mutex));
+	if(NULL != g_event_log)
+	{
+		fclose(g_event_log);
+	}
+	g_event_log = log;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_recorder_mutex));
+	INFO("Recording events to %s\n", path);
+	return 0;
+}
+
+/**
+ * @brief This API stops recording and closes the log.
+ */
+void stop_event_recording()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_recorder_mutex));
+	if(NULL != g_event_log)
+	{
+		fclose(g_event_log);
+		g_event_log = NULL;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_recorder_mutex));
+}
+
+/**
+ * @brief This API appends an inbound event to the log if recording is enabled. Each record is
+ * flushed so that the trace survives a crash.
+ *
+ * @param[in] source	event source.
+ * @param[in] event_id	IARM event ID.
+ * @param[in] data	event payload.
+ * @param[in] len	payload size.
+ */
+void record_event(eventSource_t source, int event_id, const void *data, size_t len)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_recorder_mutex));
+	if(NULL != g_event_log)
+	{
+		eventLogRecord_t record;
+		record.timestamp_us = get_monotonic_time_us();
+		record.source = (uint8_t)source;
+		record.reserved = 0;
+		record.event_id = (uint16_t)event_id;
+		record.length = (uint32_t)((EVENT_LOG_MAX_PAYLOAD < len) ? EVENT_LOG_MAX_PAYLOAD : len);
+		if((1 != fwrite(&record, sizeof(record), 1, g_event_log)) ||
+				((0 != record.length) && (1 != fwrite(data, record.length, 1, g_event_log))))
+		{
+			ERROR("Could not write event record!\n");
+		}
+		fflush(g_event_log);
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_recorder_mutex));
+}
+
+/**
+ * @brief This API maps a recorded event source back to its IARM owner name.
+ */
+const char * get_event_source_owner(eventSource_t source)
+{
+	switch(source)
+	{
+		case EVENT_SOURCE_SYSMGR:
+			return IARM_BUS_SYSMGR_NAME;
+		case EVENT_SOURCE_PWRMGR:
+			return IARM_BUS_PWRMGR_NAME;
+		case EVENT_SOURCE_IRMGR:
+			return IARM_BUS_IRMGR_NAME;
+		case EVENT_SOURCE_SYSMODE:
+			return IARM_BUS_COMMON_API_SysModeChange;
+		default:
+			return "unknown";
+	}
+}
+
+/**
+ * @brief This API validates the header of a log opened for replay.
+ *
+ * @return  Returns status of the operation.
+ */
+int open_event_log(FILE *log)
+{
+	eventLogHeader_t header;
+	if((1 != fread(&header, sizeof(header), 1, log)) || (EVENT_LOG_MAGIC != header.magic))
+	{
+		ERROR("Not an event log!\n");
+		return -1;
+	}
+	if(EVENT_LOG_VERSION != header.version)
+	{
+		ERROR("Unsupported event log version %u!\n", header.version);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief This API reads the next record from the log.
+ *
+ * @param[in] log		log opened with open_event_log().
+ * @param[out] record		record header.
+ * @param[out] payload		buffer for the payload.
+ * @param[in] payload_size	size of the buffer.
+ *
+ * @return  Returns 1 if a record was read, 0 at the end of the log and -1 on a corrupt record.
+ */
+int read_event_log(FILE *log, eventLogRecord_t *record, void *payload, size_t payload_size)
+{
+	if(1 != fread(record, sizeof(*record), 1, log))
+	{
+		return 0;
+	}
+	if((EVENT_SOURCE_MAX <= record->source) || (payload_size < record->length))
+	{
+		ERROR("Corrupt event record!\n");
+		return -1;
+	}
+	memset(payload, 0, payload_size);
+	if((0 != record->length) && (1 != fread(payload, record->length, 1, log)))
+	{
+		ERROR("Truncated event record!\n");
+		return -1;
+	}
+	return 1;
+}
+
+/** @} */  //END OF GROUP LED_APIS
@@ -0,0 +1,70 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef EVENTRECORDER_H
+#define EVENTRECORDER_H
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+#define EVENT_LOG_MAGIC 0x5244454C	/**< "LEDR" */
+#define EVENT_LOG_VERSION 1
+#define EVENT_LOG_MAX_PAYLOAD 4096	/**< Larger payloads are truncated on record */
+
+typedef enum
+{
+	EVENT_SOURCE_SYSMGR = 0,	/**< IARM_BUS_SYSMGR_NAME events */
+	EVENT_SOURCE_PWRMGR,		/**< IARM_BUS_PWRMGR_NAME events */
+	EVENT_SOURCE_IRMGR,		/**< IARM_BUS_IRMGR_NAME events */
+	EVENT_SOURCE_SYSMODE,		/**< IARM_BUS_COMMON_API_SysModeChange calls */
+	EVENT_SOURCE_MAX,
+}eventSource_t;
+
+/* On-disk layout. The log is written in host byte order and is meant to be replayed on the
+ * same architecture it was recorded on.*/
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t reserved;
+}eventLogHeader_t;
+
+typedef struct
+{
+	uint64_t timestamp_us;	/**< CLOCK_MONOTONIC at reception */
+	uint8_t source;		/**< eventSource_t */
+	uint8_t reserved;
+	uint16_t event_id;
+	uint32_t length;	/**< Payload bytes following this record */
+}eventLogRecord_t;
+
+/* @} */ // End of group LED_TYPES
+
+int start_event_recording(const char *path);
+void stop_event_recording();
+void record_event(eventSource_t source, int event_id, const void *data, size_t len);
+const char * get_event_source_owner(eventSource_t source);
+int open_event_log(FILE *log);
+int read_event_log(FILE *log, eventLogRecord_t *record, void *payload, size_t payload_size);
+uint64_t get_monotonic_time_us();
+
+#endif /*EVENTRECORDER_H*/
@@ -21,11 +21,35 @@ typedef enum
 
 /* @} */ // End of group LED_TYPES
 
+/* Sys-state IDs consumed by this implementation. */
+static const unsigned int g_sysstate_interest[] = {IARM_BUS_SYSMGR_SYSSTATE_GATEWAY_CONNECTION};
 
 ledMgr::ledMgr()
 {
-        //TODO: Explore autodetection
-        m_indicators.push_back(indicator("Power"));
+        /*Take every indicator the platform declares, with what each supports; fall back to the one every
+         * box has if the backend cannot list them.*/
+        if(0 >= detectIndicators())
+        {
+                addIndicator("Power");
+        }
+
+        /*Subscribe only to the events handled below.
+         * TODO (OEM): Add EVENT_CLASS_IR_KEY once handleKeyPress() is implemented.*/
+        setEventInterest(EVENT_CLASS_SYSTEM_STATE | EVENT_CLASS_SYS_MODE, g_sysstate_interest,
+                        sizeof(g_sysstate_interest) / sizeof(g_sysstate_interest[0]));
+
+        /*Ride out gateway flaps: report a disconnect only once it has lasted 3s, trust a reconnect after
+         * 1s, and keep whatever is shown up for at least 5s.
+         * TODO (OEM): Tune for the platform's network stack.*/
+        setDebounce(IARM_BUS_SYSMGR_SYSSTATE_GATEWAY_CONNECTION, 1000, 3000, 5000);
+
+        /*No blinking in deep sleep: patterns freeze and resume on wake-up, the LED is off meanwhile.
+         * TODO (OEM): Keep it dimly lit instead if the platform's power budget allows.*/
+        setDeepSleepState("Power", false);
+
+        /*Energy estimates assume 10mA at full brightness from a 3.3V rail.
+         * TODO (OEM): Use the figures from the front-panel schematic.*/
+        setLedCurrent("Power", 10000, 3300);
 }
 
 ledMgr ledMgr::m_singleton;
@@ -17,8 +17,14 @@
  * limitations under the License.
 */
 #include "indicator.hpp"
-#include "frontPanelConfig.hpp"
+#include "syncgroup.hpp"
+#include "eventrecorder.hpp"
+#include "statuspage.hpp"
+#include "ledtiming.hpp"
 static const unsigned int INVALID_COLOR =  0xFFFFFFFF;
+static const unsigned int OUTPUT_LIT = 0x01;
+static const unsigned int OUTPUT_BRIGHTNESS = 0x02;
+static const unsigned int OUTPUT_COLOR = 0x04;
 
 /**
  * @addtogroup LED_APIS
@@ -56,20 +62,74 @@ static gboolean masterFlareCallbackFunction(gpointer data)
 	return false;
 }
 
-indicator::indicator(const std::string &name)
+/**
+ * @brief Callback function to advance a color animation.
+ *
+ * @param[in] data      address of indicator class.
+ *
+ * @return  Returns false; the next step registers its own callback.
+ */
+static gboolean masterColorCallbackFunction(gpointer data)
+{
+	indicator *ptr = (indicator *)data;
+	DEBUG("Enter\n");
+	ptr->colorTimerCallback();
+	return false;
+}
+
+indicator::indicator(const std::string &name, ledBackend &backend)
 {
 	m_name = name;
 	m_source_id = 0;
+	m_color_source_id = 0;
+	m_color_animation = NULL;
+	m_pattern_ptr = NULL;
+	m_legacy_pattern_ptr = NULL;
+	m_sync_group = NULL;
+	m_checkpoint = NULL;
+	m_status = NULL;
+	m_output_lit = false;
+	m_output_brightness = 0;
+	m_output_color = LEDMGR_STATUS_NO_COLOR;
+	m_output_suspended = false;
+	m_output_touched = 0;
+	m_num_energy_buckets = 0;
+	m_energy_since_us = get_monotonic_time_us();
+	m_energy_lit = false;
+	m_energy_brightness = 0;
+	m_energy_pattern_id = LEDMGR_STATUS_NO_PATTERN;
+	m_energy_power_state = 0;
+	m_ramp_elapsed = 0;
+	m_ramp_level = KEYFRAME_OFF;
 	m_saved_properties.isValid = false;
+	m_script = NULL;
+	m_script_source_id = 0;
+	m_script_running = false;
+	m_script_cancelled = false;
+	m_script_event = NULL;
+	m_next_event_waiter = NULL;
+	m_script_event_value = 0;
 	pthread_mutexattr_t mutex_attribute;
 	REPORT_IF_UNEQUAL(0, pthread_mutexattr_init(&mutex_attribute));
 	REPORT_IF_UNEQUAL(0, pthread_mutexattr_settype(&mutex_attribute, PTHREAD_MUTEX_RECURSIVE));
 	REPORT_IF_UNEQUAL(0, pthread_mutex_init(&m_mutex, &mutex_attribute));
 
-	/*Caching a reference to the DS instance of the indicator. This is safe because
-	 * we don't expect the indicator instances in DS to change once initialized.
-	 * Below line may throw an exception*/
-	m_indicator = &(device::FrontPanelConfig::getInstance().getIndicator(m_name));
+	m_backend = &backend;
+	m_handle = m_backend->open(m_name);
+	if(0 > m_handle)
+	{
+		ERROR("Could not open indicator %s!\n", m_name.c_str());
+	}
+	if((0 > m_handle) || (0 != m_backend->getCapabilities(m_handle, m_capabilities)))
+	{
+		m_capabilities.mask = 0;
+		m_capabilities.min_brightness = 0;
+		m_capabilities.max_brightness = 0;
+	}
+	if((0 != (m_capabilities.mask & LED_CAP_BRIGHTNESS)) && (0 != m_backend->getBrightness(m_handle, m_output_brightness)))
+	{
+		m_output_brightness = 0;
+	}
   #if 0 //Temporarily disabled until DELIA-6363 is available in stable2
 	m_state = (true == m_indicator->getState() ? STATE_STEADY_ON : STATE_STEADY_OFF);
   #else
@@ -80,12 +140,17 @@ indicator::indicator(const std::string &name)
 
 indicator::~indicator()
 {
-	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	leaveSyncGroup();
+#ifdef LEDMGR_COROUTINES
+	stopScript();
+#endif
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
 	if(0 != m_source_id)
 	{
-		REPORT_IF_UNEQUAL(true, g_source_remove(m_source_id));
+		REPORT_IF_UNEQUAL(true, led_source_remove(m_source_id));
 		m_source_id = 0;
 	}
+	cancelColorAnimation();
 	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
 	pthread_mutex_destroy(&m_mutex);
 }
@@ -100,46 +165,209 @@ const std::string& indicator::getName() const
 	return m_name;
 }
 
+/**
+ * @brief API to return what the indicator supports, as found out when it was opened.
+ *
+ * @return  Returns the indicator's capabilities.
+ */
+const ledCapabilities_t& indicator::getCapabilities() const
+{
+	return m_capabilities;
+}
+
 /**
  * @brief This API sets the indicator color.
  *
  * @param[in] color   indicator color to be set.
  *
+ * @return  Returns status of the operation.
  */
-void indicator::setColor(const unsigned int color)
+int indicator::setColor(const unsigned int color)
+{
+	if(0 == (m_capabilities.mask & LED_CAP_COLOR))
+	{
+		ERROR("Indicator %s has no color control!\n", m_name.c_str());
+		return -1;
+	}
+	stopColorAnimation();
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	writeColor(color);
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return 0;
+}
+
+/*Keyframe and animation colors are dropped on indicators without color control, so patterns written for
+ * color LEDs still play on mono ones.*/
+void indicator::writeColor(unsigned int color)
 {
-	using namespace device;
-	try
+	if(0 == (m_capabilities.mask & LED_CAP_COLOR))
 	{
-		m_indicator->setColor(color, false);
+		return;
 	}
-	catch(...)
+	if(m_output_suspended)
 	{
-		ERROR("Error setting color!\n");
+		m_output_touched |= OUTPUT_COLOR;
 	}
+	else
+	{
+		m_backend->setColor(m_handle, color);
+	}
+	m_output_color = color;
+	publishStatus();
 }
 
 /**
- * @brief This API sets the brightness of the specified LED.
+ * @brief This API plays a precomputed color animation. The animation must outlive its playback.
+ *
+ * @param[in] animation		color lookup table to play.
+ * @param[in] repetitions	number of times to play it, -1 to loop indefinitely.
+ *
+ * @return  Returns status of the operation.
+ */
+int indicator::setColorAnimation(const colorAnimation *animation, int repetitions)
+{
+	if((NULL == animation) || (0 == animation->getNumSteps()) || (0 == repetitions))
+	{
+		ERROR("Bad inputs!\n");
+		return -1;
+	}
+	if(0 == (m_capabilities.mask & LED_CAP_COLOR))
+	{
+		ERROR("Indicator %s has no color control!\n", m_name.c_str());
+		return -1;
+	}
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	cancelColorAnimation();
+	m_color_animation = animation;
+	m_color_step = 0;
+	m_color_repetitions = repetitions;
+	stepColor();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	INFO("Started color animation with %u steps\n", animation->getNumSteps());
+	return 0;
+}
+
+/**
+ * @brief This API stops the running color animation, leaving the current color in place.
+ */
+void indicator::stopColorAnimation()
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	cancelColorAnimation();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+void indicator::cancelColorAnimation()
+{
+	if(0 != m_color_source_id)
+	{
+		REPORT_IF_UNEQUAL(true, led_source_remove(m_color_source_id));
+		m_color_source_id = 0;
+	}
+	m_color_animation = NULL;
+}
+
+/**
+ * @brief This API writes the current color step and schedules the next one.
+ */
+int indicator::stepColor()
+{
+	const colorStep_t &step = m_color_animation->getStep(m_color_step);
+	writeColor(step.color);
+
+	m_color_step++;
+	if(m_color_step == m_color_animation->getNumSteps())
+	{
+		m_color_step = 0;
+		if((-1 != m_color_repetitions) && (0 == --m_color_repetitions))
+		{
+			/*Final step written; hold it.*/
+			m_color_animation = NULL;
+			return 0;
+		}
+	}
+	m_color_source_id = led_timeout_add(step.hold_frames * m_color_animation->getFrameInterval(), masterColorCallbackFunction, (gpointer)this);
+	if(0 == m_color_source_id)
+	{
+		ERROR("Could not register callback!\n");
+	}
+	return 0;
+}
+
+/**
+ * @brief This API requests to process the next color animation step.
+ */
+int indicator::colorTimerCallback()
+{
+	DEBUG("Enter\n");
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	m_color_source_id = 0;
+	if(NULL != m_color_animation)
+	{
+		stepColor();
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return 0;
+}
+
+/**
+ * @brief This API sets the brightness of the specified LED, within the range it supports. Eased
+ * keyframes on an indicator without brightness control just switch it.
  *
  * @param[in] intensity   intensity value of brightness.
  */
 void indicator::setBrightness(unsigned int intensity)
 {
-	using namespace device;
-	try
+	if(0 == (m_capabilities.mask & LED_CAP_BRIGHTNESS))
+	{
+		return;
+	}
+	if(m_capabilities.min_brightness > intensity)
+	{
+		intensity = m_capabilities.min_brightness;
+	}
+	else if(m_capabilities.max_brightness < intensity)
+	{
+		intensity = m_capabilities.max_brightness;
+	}
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	if(m_output_suspended)
+	{
+		m_output_touched |= OUTPUT_BRIGHTNESS;
+	}
+	else
 	{
-		m_indicator->setBrightness(intensity, false);
+		m_backend->setBrightness(m_handle, intensity);
 	}
-	catch(...)
+	m_output_brightness = intensity;
+	accountEnergy();
+	publishStatus();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API enables the indicator to blink with the specified keyframe pattern.
+ *
+ * @param[in] pattern		keyframe pattern.
+ * @param[in] repetitions	number of repetition count.
+ *
+ * @return  Returns status of the operation.
+ */
+int indicator::setBlink(const keyframePattern_t *pattern, int repetitions)
+{
+	if((0 == repetitions) || (NULL == pattern) || (1 > pattern->num_keyframes))
 	{
-		ERROR("Error setting indicator brightness!\n");
+		ERROR("Bad inputs!\n");
+		return -1;
 	}
+	return startBlink(pattern, NULL, repetitions);
 }
 
 /**
  * @brief This API enables the indicator to blink with the specified blinking pattern.
  *
+ * On/off patterns are played by the keyframe engine, each step read as an on or off keyframe.
+ *
  * @param[in] pattern		blink pattern.
  * @param[in] repetitions	number of repetition count.
  *
@@ -152,14 +380,28 @@ int indicator::setBlink(const blinkPattern_t *pattern, int repetitions)
 		ERROR("Bad inputs!\n");
 		return -1;
 	}
+	return startBlink(NULL, pattern, repetitions);
+}
+
+int indicator::startBlink(const keyframePattern_t *pattern, const blinkPattern_t *legacy_pattern, int repetitions)
+{
+	if(0 == (m_capabilities.mask & LED_CAP_BLINK))
+	{
+		ERROR("Indicator %s cannot blink!\n", m_name.c_str());
+		return -1;
+	}
 	INFO("Start\n");
-	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	leaveSyncGroup();
+#ifdef LEDMGR_COROUTINES
+	stopScript();
+#endif
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
 
 	
 	/*Cancel previous blink pattern if any*/
 	if(0 != m_source_id)
 	{
-		REPORT_IF_UNEQUAL(true, g_source_remove(m_source_id));
+		REPORT_IF_UNEQUAL(true, led_source_remove(m_source_id));
 		m_source_id = 0;
 	}
 	/*Check whether the indicator is currently disabled. Enable
@@ -172,34 +414,157 @@ int indicator::setBlink(const blinkPattern_t *pattern, int repetitions)
 
 	m_state = STATE_BLINKING;
 	m_pattern_ptr = pattern;
+	m_legacy_pattern_ptr = legacy_pattern;
 	m_pattern_repetitions = repetitions;
 	m_sequence_read_offset = 0;
+	m_ramp_elapsed = 0;
 	step();
 	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
 	INFO("Done\n");
 	return 0;
 }
 
+unsigned int indicator::getNumKeyframes() const
+{
+	return (NULL != m_pattern_ptr) ? m_pattern_ptr->num_keyframes : m_legacy_pattern_ptr->num_sequences;
+}
+
+/**
+ * @brief This API reads a step of the active pattern as an unpacked keyframe.
+ */
+void indicator::getKeyframe(unsigned int offset, resolvedKeyframe_t &frame) const
+{
+	if(NULL != m_pattern_ptr)
+	{
+		const keyframe_t &keyframe = m_pattern_ptr->keyframes[offset];
+		frame.duration = keyframe.duration;
+		frame.brightness = keyframe.brightness;
+		frame.has_color = (KEYFRAME_COLOR_KEEP != keyframe.color_index) && (keyframe.color_index <= m_pattern_ptr->num_colors);
+		frame.color = frame.has_color ? m_pattern_ptr->palette[keyframe.color_index - 1] : 0;
+		frame.easing = (keyframeEasing_t)keyframe.easing;
+	}
+	else
+	{
+		const blinkOp_t &op = m_legacy_pattern_ptr->sequence[offset];
+		frame.duration = op.length;
+		frame.brightness = (op.isOn ? KEYFRAME_ON : KEYFRAME_OFF);
+		frame.has_color = false;
+		frame.color = 0;
+		frame.easing = EASING_STEP;
+	}
+}
+
+void indicator::applyLevel(unsigned int brightness)
+{
+	if(KEYFRAME_OFF == brightness)
+	{
+		enableIndicator(false);
+	}
+	else
+	{
+		enableIndicator(true);
+		if(KEYFRAME_ON != brightness)
+		{
+			setBrightness(brightness);
+		}
+	}
+}
+
+/**
+ * @brief This API writes a keyframe's color and brightness. Plain on/off keyframes translate to a
+ * single state change, as the on/off patterns always did.
+ */
+void indicator::applyKeyframe(const resolvedKeyframe_t &frame)
+{
+	if(frame.has_color)
+	{
+		writeColor(frame.color);
+	}
+	applyLevel(frame.brightness);
+}
+
 /**
  * @brief This API is to register timer callback function depends on iteration pattern(indefinite iteration and finite iteration).
  *
+ * Eased keyframes are split into KEYFRAME_RAMP_MS sub-steps that interpolate the brightness towards the
+ * next keyframe with integer arithmetic.
+ *
  * @return  Returns status of the operation.
  */
 int indicator::step()
 {
 	DEBUG("Start\n");
-	unsigned char offset = m_sequence_read_offset;
-	enableIndicator(m_pattern_ptr->sequence[offset].isOn);
+	unsigned int offset = m_sequence_read_offset;
+	unsigned int num_keyframes = getNumKeyframes();
+	unsigned int wait;
+	resolvedKeyframe_t frame;
+	getKeyframe(offset, frame);
+	if(0 == m_ramp_elapsed)
+	{
+		checkpointActive(offset, m_pattern_repetitions, get_monotonic_time_us());
+	}
 
-	/* Advance offset (in other words, the pattern's read-pointer)
-	 * for next the next step.*/
-	m_sequence_read_offset = (m_sequence_read_offset + 1) % m_pattern_ptr->num_sequences;
-	//TODO: Temporary, for developer confidence
-	if(m_sequence_read_offset == m_pattern_ptr->num_sequences)
+	resolvedKeyframe_t next_frame;
+	getKeyframe((offset + 1) % num_keyframes, next_frame);
+	bool ramping = (EASING_STEP != frame.easing) && (KEYFRAME_ON != frame.brightness) && (KEYFRAME_ON != next_frame.brightness) &&
+		(KEYFRAME_RAMP_MS < frame.duration);
+
+	if((0 == m_ramp_elapsed) || !ramping)
 	{
-		ERROR("Out of bounds access!\n");
+		applyKeyframe(frame);
+		m_ramp_level = frame.brightness;
+	}
+	else
+	{
+		/*Progress through the keyframe in 1/256 units, shaped by the easing curve.*/
+		int progress = (m_ramp_elapsed << 8) / frame.duration;
+		if(EASING_IN == frame.easing)
+		{
+			progress = (progress * progress) >> 8;
+		}
+		else if(EASING_OUT == frame.easing)
+		{
+			progress = 256 - (((256 - progress) * (256 - progress)) >> 8);
+		}
+		int from = frame.brightness;
+		int to = next_frame.brightness;
+		unsigned int level = from + (((to - from) * progress) >> 8);
+		if((KEYFRAME_OFF != level) && (KEYFRAME_OFF != m_ramp_level))
+		{
+			/*Already lit; only the brightness moves.*/
+			setBrightness(level);
+		}
+		else
+		{
+			applyLevel(level);
+		}
+		m_ramp_level = level;
+	}
+
+	if(ramping)
+	{
+		unsigned int remaining = frame.duration - m_ramp_elapsed;
+		wait = (KEYFRAME_RAMP_MS < remaining) ? KEYFRAME_RAMP_MS : remaining;
+		m_ramp_elapsed += wait;
+		if(m_ramp_elapsed < frame.duration)
+		{
+			/*More sub-steps remain in this keyframe.*/
+			registerCallback(wait);
+			return 0;
+		}
+		m_ramp_elapsed = 0;
+	}
+	else
+	{
+		/*m_ramp_elapsed is only non-zero here when resuming part-way through the keyframe.*/
+		wait = frame.duration - m_ramp_elapsed;
+		m_ramp_elapsed = 0;
 	}
 
+	/* Advance offset (in other words, the pattern's read-pointer)
+	 * for next the next step.*/
+	m_sequence_read_offset = (m_sequence_read_offset + 1) % num_keyframes;
+
 	/* Evaluate whether a callback is necessary:
 	 * A callback is necessary when at least one of the below conditions is true:
 	 * 1. Pattern is required to iterate indefinitely (m_pattern_repetitions = -1).
@@ -209,7 +574,7 @@ int indicator::step()
 	 * */
 	if(-1 ==  m_pattern_repetitions)
 	{
-		registerCallback(m_pattern_ptr->sequence[offset].length);
+		registerCallback(wait);
 	}
 	else
 	{
@@ -223,7 +588,7 @@ int indicator::step()
 			if(0 < m_pattern_repetitions)
 			{
 				/* There are iterations pending */
-				registerCallback(m_pattern_ptr->sequence[offset].length);
+				registerCallback(wait);
 				DEBUG("End iteration\n");
 			}
 			else
@@ -234,7 +599,7 @@ int indicator::step()
 		else
 		{
 			/* More steps remain to complete this iteration. */
-			registerCallback(m_pattern_ptr->sequence[offset].length);
+			registerCallback(wait);
 		}
 	}
 	return 0;
@@ -246,7 +611,7 @@ int indicator::step()
 int indicator::timerCallback()
 {
 	DEBUG("Enter\n");
-	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
 	m_source_id = 0;
 	step();
 	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
@@ -267,7 +632,7 @@ int indicator::registerCallback(unsigned int milliseconds)
 		ERROR("Zero-wait timer!\n");
 		return -1;
 	}
-	m_source_id = g_timeout_add(milliseconds, masterBlinkCallbackFunction, (gpointer)this);
+	m_source_id = led_timeout_add(milliseconds, masterBlinkCallbackFunction, (gpointer)this);
 	if(0 == m_source_id)
 	{
 		ERROR("Could not register callback!\n");
@@ -290,19 +655,29 @@ int indicator::setState(indicatorState_t state)
 		ERROR("Unsupported state!\n");
 		return -1;
 	}
+	if(0 == (m_capabilities.mask & LED_CAP_STATE))
+	{
+		ERROR("Indicator %s cannot be switched!\n", m_name.c_str());
+		return -1;
+	}
+	leaveSyncGroup();
+#ifdef LEDMGR_COROUTINES
+	stopScript();
+#endif
 
-	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
 	/*Cancel any blinking*/
 	if(STATE_BLINKING ==  m_state)
 	{
 		if(0 != m_source_id)
 		{
-			REPORT_IF_UNEQUAL(true, g_source_remove(m_source_id));
+			REPORT_IF_UNEQUAL(true, led_source_remove(m_source_id));
 			m_source_id = 0;
 			INFO("Cancelled previously started blink operation\n");
 		}
 	}
 	m_state = state;
+	checkpointActive(0, 0, 0);
 	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
 	
 	if(STATE_STEADY_ON == state)
@@ -325,16 +700,25 @@ int indicator::setState(indicatorState_t state)
  */
 int indicator::enableIndicator(bool enable)
 {
-	using namespace device;
-	try
+	if(0 == (m_capabilities.mask & LED_CAP_STATE))
 	{
-		m_indicator->setState(enable);
+		return -1;
 	}
-	catch(...)
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	int ret = 0;
+	if(m_output_suspended)
 	{
-		ERROR("Could not change indicator state!\n");
+		m_output_touched |= OUTPUT_LIT;
 	}
-	return 0;
+	else
+	{
+		ret = m_backend->setState(m_handle, enable);
+	}
+	m_output_lit = enable;
+	accountEnergy();
+	publishStatus();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return ret;
 }
 
 /**
@@ -345,26 +729,25 @@ int indicator::enableIndicator(bool enable)
  */
 void indicator::saveState(void)
 {
-	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
 	m_saved_properties.state = m_state;
 	if(STATE_BLINKING == m_state)
 	{
 		m_saved_properties.sequence_read_offset = m_sequence_read_offset;
 		m_saved_properties.pattern_ptr = m_pattern_ptr;
+		m_saved_properties.legacy_pattern_ptr = m_legacy_pattern_ptr;
 		m_saved_properties.pattern_repetitions= m_pattern_repetitions;
 	}
-	try
+	if((0 == (m_capabilities.mask & LED_CAP_BRIGHTNESS)) || (0 != m_backend->getBrightness(m_handle, m_saved_properties.intensity)))
 	{
-		m_saved_properties.intensity = m_indicator->getBrightness();
-		m_saved_properties.color = m_indicator->getColor();
+		m_saved_properties.intensity = 20; //safe default
 	}
-	catch(...)
+	if((0 == (m_capabilities.mask & LED_CAP_COLOR)) || (0 != m_backend->getColor(m_handle, m_saved_properties.color)))
 	{
-		ERROR("Could not read brightness or color values!\n");
-		m_saved_properties.intensity = 20; //safe default
-		m_saved_properties.intensity= INVALID_COLOR;
+		m_saved_properties.color = INVALID_COLOR;
 	}
 	m_saved_properties.isValid = true;
+	checkpointSaved();
 	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
 	INFO("Saved state.\n");
 }
@@ -377,7 +760,10 @@ void indicator::saveState(void)
  */
 void indicator::restoreState(void)
 {
-	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	/*setState() below runs with our lock held, so it must find no group to leave: the group lock is
+	 * taken before the indicator lock.*/
+	leaveSyncGroup();
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
 	if(m_saved_properties.isValid)
 	{
 		/*Stop whatever we're doing right now.*/
@@ -392,19 +778,25 @@ void indicator::restoreState(void)
 		if(STATE_STEADY_ON == m_state)
 		{
 			enableIndicator(true);
+			checkpointActive(0, 0, 0);
 			INFO("Successfully restored to STEADY ON state.\n");
 		}
 		else if(STATE_BLINKING == m_state)
 		{
 			m_pattern_ptr = m_saved_properties.pattern_ptr;
+			m_legacy_pattern_ptr = m_saved_properties.legacy_pattern_ptr;
 			m_sequence_read_offset = m_saved_properties.sequence_read_offset;
 			m_pattern_repetitions = m_saved_properties.pattern_repetitions;
+			m_ramp_elapsed = 0;
 
 			/*If the blink pattern is not set to repeat indefinitely and has completed its run,
 			 * find out what the last state is supposed to be and set it.*/
 			if(0 == m_pattern_repetitions)
 			{
-				enableIndicator(m_pattern_ptr->sequence[m_pattern_ptr->num_sequences - 1].isOn);
+				resolvedKeyframe_t frame;
+				getKeyframe(getNumKeyframes() - 1, frame);
+				applyKeyframe(frame);
+				checkpointActive(getNumKeyframes() - 1, 1, get_monotonic_time_us());
 				INFO("Successfully restored to final holding state of blink pattern.\n");
 			}
 			else
@@ -414,6 +806,7 @@ void indicator::restoreState(void)
 			}
 		}
 		m_saved_properties.isValid = false; //This setting has been applied. Mark as stale.
+		checkpointSaved();
 	}
 	else
 	{
@@ -430,19 +823,16 @@ void indicator::restoreState(void)
  */
 void indicator::executeFlare(const unsigned int percentage_increase, const unsigned int length_ms)
 {
-	using namespace device;
-	unsigned int preflare_brightness = 20;
-	try
+	if(0 == (m_capabilities.mask & LED_CAP_BRIGHTNESS))
 	{
-		preflare_brightness = m_indicator->getBrightness();
-	}
-	catch(...)
-	{
-		ERROR("Could not read brightness!\n");
+		ERROR("Indicator %s has no brightness control!\n", m_name.c_str());
+		return;
 	}
+	unsigned int preflare_brightness = 20;
+	m_backend->getBrightness(m_handle, preflare_brightness);
 
 
-	if(0 == g_timeout_add(length_ms, masterFlareCallbackFunction, (gpointer)this))
+	if(0 == led_timeout_add(length_ms, masterFlareCallbackFunction, (gpointer)this))
 	{
 		ERROR("Could not register callback!\n");
 	}
@@ -467,17 +857,684 @@ void indicator::executeFlare(const unsigned int percentage_increase, const unsig
  */
 void indicator::flareCallback()
 {
-	using namespace device;
 	unsigned int preflare_brightness = 20; //safe default
-	try
+	m_backend->getBrightness(m_handle, preflare_brightness);
+	setBrightness(preflare_brightness);
+}
+
+/**
+ * @brief This API detaches the indicator from its sync group, if any. The current output is kept.
+ */
+void indicator::leaveSyncGroup()
+{
+	/*The group lock is taken before the indicator lock, so look the group up and release
+	 * our lock before calling into it.*/
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	syncGroup *group = m_sync_group;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	if(NULL != group)
 	{
-		preflare_brightness = m_indicator->getBrightness();
+		group->leave(*this);
 	}
-	catch(...)
+}
+
+/**
+ * @brief Called by a sync group, under its lock, when the indicator joins it. The group's timer takes
+ * over from the indicator's own.
+ */
+void indicator::enterSyncGroup(syncGroup *group)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	if(0 != m_source_id)
 	{
-		ERROR("Could not read brightness!\n");
+		REPORT_IF_UNEQUAL(true, led_source_remove(m_source_id));
+		m_source_id = 0;
 	}
-	setBrightness(preflare_brightness);
+	m_sync_group = group;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief Called by a sync group, under its lock, when the indicator leaves it.
+ */
+void indicator::exitSyncGroup(syncGroup *group)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	if(group == m_sync_group)
+	{
+		m_sync_group = NULL;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief Called by a sync group on every edge of its timeline.
+ *
+ * @param[in] pattern   pattern played by the group.
+ * @param[in] offset    keyframe the timeline is in.
+ */
+void indicator::applySyncedKeyframe(const keyframePattern_t *pattern, unsigned int offset)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	m_state = STATE_BLINKING;
+	m_pattern_ptr = pattern;
+	m_legacy_pattern_ptr = NULL;
+	m_pattern_repetitions = -1;
+	m_sequence_read_offset = offset;
+	m_ramp_elapsed = 0;
+	resolvedKeyframe_t frame;
+	getKeyframe(offset, frame);
+	applyKeyframe(frame);
+	checkpointActive(offset, -1, get_monotonic_time_us());
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API starts mirroring the indicator's logical state into a crash-resume slot. The slot is
+ * written on the next state change or keyframe, so a record left by a previous instance survives until
+ * resumeState() has read it.
+ *
+ * @param[in] slot   slot in the checkpoint segment, or NULL to stop mirroring.
+ */
+void indicator::attachCheckpoint(checkpointSlot_t *slot)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	m_checkpoint = slot;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API brings the indicator back to the state recorded by a previous instance of the daemon.
+ * A blinking pattern resumes at the phase it would have reached had the daemon not gone away.
+ *
+ * @param[in] slot		copy of the slot recorded by the previous instance.
+ * @param[in] pattern		active pattern, looked up again by id. NULL if it could not be.
+ * @param[in] saved_pattern	pattern of the saved layer, looked up again by id. NULL if it could not be.
+ */
+void indicator::resumeState(const checkpointSlot_t &slot, const keyframePattern_t *pattern, const keyframePattern_t *saved_pattern)
+{
+	/*As in restoreState(): leave the group before setState() runs under our lock.*/
+	leaveSyncGroup();
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	if(slot.saved_valid)
+	{
+		m_saved_properties.state = (indicatorState_t)slot.saved.state;
+		m_saved_properties.pattern_ptr = saved_pattern;
+		m_saved_properties.legacy_pattern_ptr = NULL;
+		m_saved_properties.sequence_read_offset = slot.saved.sequence_offset;
+		m_saved_properties.pattern_repetitions = slot.saved.repetitions;
+		m_saved_properties.intensity = slot.saved.intensity;
+		m_saved_properties.color = slot.saved.color;
+		if((STATE_BLINKING == m_saved_properties.state) &&
+			((NULL == saved_pattern) || (saved_pattern->num_keyframes <= slot.saved.sequence_offset)))
+		{
+			m_saved_properties.state = STATE_STEADY_ON;
+		}
+		m_saved_properties.isValid = true;
+		checkpointSaved();
+	}
+
+	if(STATE_BLINKING == slot.active.state)
+	{
+		if(NULL != pattern)
+		{
+			resumeBlink(pattern, slot.active);
+		}
+		else
+		{
+			/*Patterns the manager cannot look up by id again (OEM-owned on/off patterns) are shown steady.*/
+			INFO("Cannot resume pattern 0x%x; holding steady on.\n", slot.active.pattern_id);
+			setState(STATE_STEADY_ON);
+		}
+	}
+	else if(STATE_STEADY_ON == slot.active.state)
+	{
+		setState(STATE_STEADY_ON);
+	}
+	else
+	{
+		setState(STATE_STEADY_OFF);
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	INFO("Indicator %s resumed to state 0x%x\n", m_name.c_str(), m_state);
+}
+
+/**
+ * @brief This API shows the deep-sleep hardware state and holds back every write from then on, while the
+ * indicator carries on tracking what it would show. Its timers are frozen separately, by
+ * suspend_led_timers().
+ *
+ * @param[in] hardware_state   what the indicator shows until resumeOutput().
+ */
+void indicator::suspendOutput(const deepSleepState_t &hardware_state)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	if(!m_output_suspended)
+	{
+		accountEnergy();
+		m_output_touched = OUTPUT_LIT;
+		if(hardware_state.lit && (0 != hardware_state.brightness) && (0 != (m_capabilities.mask & LED_CAP_BRIGHTNESS)))
+		{
+			/*Remember the brightness being replaced, even if this daemon never set it.*/
+			unsigned int brightness;
+			if(0 == m_backend->getBrightness(m_handle, brightness))
+			{
+				m_output_brightness = brightness;
+			}
+			m_backend->setBrightness(m_handle, hardware_state.brightness);
+			m_output_touched |= OUTPUT_BRIGHTNESS;
+		}
+		m_backend->setState(m_handle, hardware_state.lit);
+		m_output_suspended = true;
+
+		/*Until resumeOutput(), the hardware holds this steady state whatever the indicator tracks.*/
+		m_energy_lit = hardware_state.lit;
+		if(0 != hardware_state.brightness)
+		{
+			m_energy_brightness = hardware_state.brightness;
+		}
+		m_energy_pattern_id = LEDMGR_STATUS_NO_PATTERN;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API ends suspendOutput(): the outputs it replaced, and any that changed meanwhile, are
+ * written back as the indicator now wants them.
+ */
+void indicator::resumeOutput()
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	if(m_output_suspended)
+	{
+		m_output_suspended = false;
+		if((0 != (m_output_touched & OUTPUT_COLOR)) && (LEDMGR_STATUS_NO_COLOR != m_output_color))
+		{
+			m_backend->setColor(m_handle, m_output_color);
+		}
+		if(0 != (m_output_touched & OUTPUT_BRIGHTNESS))
+		{
+			m_backend->setBrightness(m_handle, m_output_brightness);
+		}
+		if(0 != (m_output_touched & OUTPUT_LIT))
+		{
+			m_backend->setState(m_handle, m_output_lit);
+		}
+		m_output_touched = 0;
+		accountEnergy();
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API closes the indicator's energy accounting for the previous power state; from here on
+ * its on-time counts against the new one.
+ *
+ * @param[in] power_state   IARM bus power state.
+ */
+void indicator::accountPowerState(int power_state)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	accountEnergy();
+	m_energy_power_state = power_state;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API copies out the indicator's on-time, by power state and pattern, up to the present.
+ *
+ * @param[out] buckets		receives the buckets, estimate_mwh left at 0.
+ * @param[in] max_buckets	room in buckets.
+ *
+ * @return  Returns the number of buckets copied.
+ */
+unsigned int indicator::getEnergy(energyBucket_t *buckets, unsigned int max_buckets)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	accountEnergy();
+	unsigned int num_buckets = (m_num_energy_buckets < max_buckets) ? m_num_energy_buckets : max_buckets;
+	for(unsigned int i = 0; i < num_buckets; i++)
+	{
+		buckets[i] = m_energy[i];
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return num_buckets;
+}
+
+/*Closes the running energy segment and opens the next one with what the hardware shows now. Called with
+ * the indicator lock held after every change of output, power state or suspension, so the accounting
+ * rides on transitions the engine makes anyway and needs no timer of its own. While output is
+ * suspended the hardware keeps the state suspendOutput() recorded.*/
+void indicator::accountEnergy()
+{
+	uint64_t now = get_monotonic_time_us();
+	if(m_energy_lit && (now > m_energy_since_us))
+	{
+		uint64_t elapsed_us = now - m_energy_since_us;
+		energyBucket_t *bucket = findEnergyBucket(m_energy_power_state, m_energy_pattern_id);
+		bucket->lit_us += elapsed_us;
+		bucket->level_us += elapsed_us * m_energy_brightness;
+	}
+	m_energy_since_us = now;
+	if(!m_output_suspended)
+	{
+		m_energy_lit = m_output_lit;
+		/*Brightness never read nor written is unknown; count it as full.*/
+		m_energy_brightness = (0 != m_output_brightness) ? m_output_brightness : 100;
+		m_energy_pattern_id = getActivePatternId();
+	}
+}
+
+/*Buckets are added as combinations first show up; once the table is full, the last one collects the rest.*/
+energyBucket_t * indicator::findEnergyBucket(int power_state, unsigned int pattern_id)
+{
+	for(unsigned int i = 0; i < m_num_energy_buckets; i++)
+	{
+		if((power_state == m_energy[i].power_state) && (pattern_id == m_energy[i].pattern_id))
+		{
+			return &m_energy[i];
+		}
+	}
+	if(MAX_ENERGY_BUCKETS == m_num_energy_buckets)
+	{
+		return &m_energy[MAX_ENERGY_BUCKETS - 1];
+	}
+	energyBucket_t *bucket = &m_energy[m_num_energy_buckets++];
+	if(MAX_ENERGY_BUCKETS == m_num_energy_buckets)
+	{
+		power_state = ENERGY_ANY_POWER_STATE;
+		pattern_id = ENERGY_OTHER_PATTERNS;
+	}
+	bucket->power_state = power_state;
+	bucket->pattern_id = pattern_id;
+	bucket->lit_us = 0;
+	bucket->level_us = 0;
+	bucket->estimate_mwh = 0;
+	return bucket;
+}
+
+/**
+ * @brief This API walks the pattern timeline forward from the recorded keyframe to the present and
+ * continues from there. Whole cycles are skipped arithmetically.
+ */
+void indicator::resumeBlink(const keyframePattern_t *pattern, const checkpointLayer_t &layer)
+{
+	unsigned int num_keyframes = pattern->num_keyframes;
+	uint64_t cycle = 0;
+	for(unsigned int i = 0; i < num_keyframes; i++)
+	{
+		cycle += pattern->keyframes[i].duration;
+	}
+	uint64_t now = get_monotonic_time_us();
+	uint64_t elapsed = (now > layer.keyframe_start_us) ? (now - layer.keyframe_start_us) / 1000 : 0;
+	unsigned int offset = (layer.sequence_offset < num_keyframes) ? layer.sequence_offset : 0;
+	int repetitions = layer.repetitions;
+	bool finished = false;
+
+	while(true)
+	{
+		if((-1 != repetitions) && (1 > repetitions))
+		{
+			offset = num_keyframes - 1;
+			finished = true;
+			break;
+		}
+		if(((-1 != repetitions) && (1 == repetitions) && (num_keyframes - 1 == offset)) || (0 == cycle))
+		{
+			/*The final keyframe is held once the last repetition completes.*/
+			finished = true;
+			break;
+		}
+		unsigned int duration = pattern->keyframes[offset].duration;
+		if(elapsed < duration)
+		{
+			break;
+		}
+		elapsed -= duration;
+		offset = (offset + 1) % num_keyframes;
+		if(0 == offset)
+		{
+			if(-1 != repetitions)
+			{
+				repetitions--;
+			}
+			uint64_t cycles = elapsed / cycle;
+			if((-1 != repetitions) && (0 < repetitions) && (cycles > (uint64_t)(repetitions - 1)))
+			{
+				cycles = repetitions - 1;
+			}
+			elapsed -= cycles * cycle;
+			if(-1 != repetitions)
+			{
+				repetitions -= cycles;
+			}
+		}
+	}
+
+	if(0 != m_source_id)
+	{
+		REPORT_IF_UNEQUAL(true, led_source_remove(m_source_id));
+		m_source_id = 0;
+	}
+	m_state = STATE_BLINKING;
+	m_pattern_ptr = pattern;
+	m_legacy_pattern_ptr = NULL;
+	if(finished)
+	{
+		resolvedKeyframe_t frame;
+		getKeyframe(offset, frame);
+		applyKeyframe(frame);
+		m_sequence_read_offset = 0;
+		m_pattern_repetitions = 0;
+		checkpointActive(offset, 1, now);
+	}
+	else
+	{
+		m_sequence_read_offset = offset;
+		m_pattern_repetitions = repetitions;
+		m_ramp_elapsed = elapsed;
+		checkpointActive(offset, repetitions, now - (elapsed * 1000));
+		step();
+	}
+}
+
+/**
+ * @brief This API records the active layer. Called with the indicator lock held.
+ *
+ * @param[in] offset		keyframe being displayed.
+ * @param[in] repetitions	repetitions left when that keyframe started.
+ * @param[in] keyframe_start_us	CLOCK_MONOTONIC when that keyframe started.
+ */
+void indicator::checkpointActive(unsigned int offset, int repetitions, uint64_t keyframe_start_us)
+{
+	if(NULL == m_checkpoint)
+	{
+		return;
+	}
+	checkpointLayer_t &layer = m_checkpoint->active;
+	begin_checkpoint_update(&m_checkpoint->generation);
+	layer.state = m_state;
+	layer.pattern_source = CHECKPOINT_PATTERN_NONE;
+	if(STATE_BLINKING == m_state)
+	{
+		layer.pattern_source = (NULL != m_pattern_ptr) ? CHECKPOINT_PATTERN_KEYFRAME : CHECKPOINT_PATTERN_LEGACY;
+		layer.pattern_id = (NULL != m_pattern_ptr) ? m_pattern_ptr->id : m_legacy_pattern_ptr->id;
+		layer.num_keyframes = getNumKeyframes();
+	}
+	layer.sequence_offset = offset;
+	layer.repetitions = repetitions;
+	layer.keyframe_start_us = keyframe_start_us;
+	end_checkpoint_update(&m_checkpoint->generation);
+}
+
+/**
+ * @brief This API records the layer stashed by saveState(). Called with the indicator lock held.
+ */
+void indicator::checkpointSaved()
+{
+	if(NULL == m_checkpoint)
+	{
+		return;
+	}
+	checkpointLayer_t &layer = m_checkpoint->saved;
+	begin_checkpoint_update(&m_checkpoint->generation);
+	m_checkpoint->saved_valid = m_saved_properties.isValid;
+	if(m_saved_properties.isValid)
+	{
+		layer.state = m_saved_properties.state;
+		layer.pattern_source = CHECKPOINT_PATTERN_NONE;
+		if(STATE_BLINKING == m_saved_properties.state)
+		{
+			if(NULL != m_saved_properties.pattern_ptr)
+			{
+				layer.pattern_source = CHECKPOINT_PATTERN_KEYFRAME;
+				layer.pattern_id = m_saved_properties.pattern_ptr->id;
+				layer.num_keyframes = m_saved_properties.pattern_ptr->num_keyframes;
+			}
+			else
+			{
+				layer.pattern_source = CHECKPOINT_PATTERN_LEGACY;
+				layer.pattern_id = m_saved_properties.legacy_pattern_ptr->id;
+				layer.num_keyframes = m_saved_properties.legacy_pattern_ptr->num_sequences;
+			}
+		}
+		layer.sequence_offset = m_saved_properties.sequence_read_offset;
+		layer.repetitions = m_saved_properties.pattern_repetitions;
+		layer.intensity = m_saved_properties.intensity;
+		layer.color = m_saved_properties.color;
+		layer.keyframe_start_us = 0;
+	}
+	end_checkpoint_update(&m_checkpoint->generation);
+}
+
+/**
+ * @brief This API tells whether the indicator may still read the pattern, either because it is playing
+ * it or because it is the saved layer restoreState() would bring back.
+ */
+bool indicator::usesPattern(const keyframePattern_t *pattern)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	bool in_use = ((STATE_BLINKING == m_state) && (pattern == m_pattern_ptr)) ||
+		(m_saved_properties.isValid && (STATE_BLINKING == m_saved_properties.state) && (pattern == m_saved_properties.pattern_ptr));
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return in_use;
+}
+
+/**
+ * @brief This API starts publishing the indicator into its status page record.
+ *
+ * @param[in] entry   record in the status page, or NULL to stop publishing.
+ */
+void indicator::attachStatus(ledmgr_status_indicator_t *entry)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	m_status = entry;
+	if(NULL != m_status)
+	{
+		/*Seed what hasn't been written since startup from the backend.*/
+		m_output_lit = (STATE_STEADY_OFF != m_state);
+		if((0 == (m_capabilities.mask & LED_CAP_BRIGHTNESS)) || (0 != m_backend->getBrightness(m_handle, m_output_brightness)))
+		{
+			m_output_brightness = 0;
+		}
+		if((0 == (m_capabilities.mask & LED_CAP_COLOR)) || (0 != m_backend->getColor(m_handle, m_output_color)))
+		{
+			m_output_color = LEDMGR_STATUS_NO_COLOR;
+		}
+		publishStatus();
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API refreshes the status page record. Called with the indicator lock held, after every
+ * write to the backend.
+ */
+void indicator::publishStatus()
+{
+	if(NULL == m_status)
+	{
+		return;
+	}
+	begin_status_update(&m_status->sequence);
+	m_status->state = m_state;
+	m_status->lit = m_output_lit;
+	m_status->brightness = m_output_brightness;
+	m_status->color = m_output_color;
+	m_status->pattern_id = getActivePatternId();
+	m_status->updated_us = get_monotonic_time_us();
+	end_status_update(&m_status->sequence);
+}
+
+unsigned int indicator::getActivePatternId() const
+{
+	if((STATE_BLINKING == m_state) && (NULL != m_pattern_ptr))
+	{
+		return m_pattern_ptr->id;
+	}
+	if((STATE_BLINKING == m_state) && (NULL != m_legacy_pattern_ptr))
+	{
+		return m_legacy_pattern_ptr->id;
+	}
+	return LEDMGR_STATUS_NO_PATTERN;
+}
+
+#ifdef LEDMGR_COROUTINES
+/**
+ * @brief Callback function fired when a script's scriptSleep has elapsed.
+ *
+ * @param[in] data      address of indicator class.
+ *
+ * @return  Returns false; the script's next sleep registers its own callback.
+ */
+static gboolean masterScriptCallbackFunction(gpointer data)
+{
+	((indicator *)data)->scriptTimerCallback();
+	return false;
+}
+
+/**
+ * @brief This API runs a script (see ledscript.hpp) on the indicator. Whatever the indicator was doing
+ * stops, and the script runs up to its first co_await before this returns.
+ *
+ * @return  Returns status of the operation. Fails if the script could not be allocated.
+ */
+int indicator::runScript(ledScript script)
+{
+	if(!script.isValid())
+	{
+		ERROR("No room for another script!\n");
+		return -1;
+	}
+	setState(STATE_STEADY_OFF);
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	if(m_script)
+	{
+		/*Lost a race with another runScript().*/
+		destroyScriptLocked();
+	}
+	ledScript::handle_t handle = script.release();
+	handle.promise().owner = this;
+	m_script = handle.address();
+	resumeScriptLocked();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return 0;
+}
+
+/**
+ * @brief This API destroys the running script, if any. A script that stops itself (e.g. by calling
+ * setState()) is destroyed at its next co_await.
+ */
+void indicator::stopScript()
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	if(m_script)
+	{
+		if(m_script_running)
+		{
+			m_script_cancelled = true;
+		}
+		else
+		{
+			destroyScriptLocked();
+		}
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API sets the LED's output level without touching its logical state. For scripts.
+ *
+ * @param[in] brightness	KEYFRAME_OFF, 1-100, or KEYFRAME_ON.
+ */
+void indicator::driveLevel(unsigned int brightness)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	applyLevel(brightness);
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API sets the LED's color without stopping a script or a color animation. For scripts.
+ */
+void indicator::driveColor(unsigned int color)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	writeColor(color);
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+void indicator::scriptTimerCallback()
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	/*A timer that was removed while already being dispatched must not resume a newer sleep.*/
+	if((0 != m_script_source_id) && (m_script_source_id == led_current_timer()))
+	{
+		m_script_source_id = 0;
+		resumeScriptLocked();
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/*Called from scriptSleep with the lock held.*/
+void indicator::scheduleScript(unsigned int milliseconds)
+{
+	m_script_source_id = led_timeout_add(milliseconds, masterScriptCallbackFunction, (gpointer)this);
+	if(0 == m_script_source_id)
+	{
+		ERROR("Could not register callback!\n");
+		m_script_cancelled = true;
+	}
+}
+
+/*Called from scriptEvent::awaiter with the lock held.*/
+void indicator::waitScriptEvent(scriptEvent *event)
+{
+	m_script_event = event;
+	event->addWaiter(this);
+}
+
+void indicator::scriptEventCallback(scriptEvent *event, int value)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATOR));
+	if(m_script && (event == m_script_event))
+	{
+		m_script_event = NULL;
+		m_script_event_value = value;
+		resumeScriptLocked();
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/*Runs the script up to its next co_await, then retires it if it finished or was stopped meanwhile.*/
+void indicator::resumeScriptLocked()
+{
+	m_script_running = true;
+	ledScript::handle_t handle = ledScript::handle_t::from_address(m_script);
+	handle.resume();
+	m_script_running = false;
+	if(m_script_cancelled || handle.done())
+	{
+		destroyScriptLocked();
+	}
+}
+
+void indicator::destroyScriptLocked()
+{
+	if(0 != m_script_source_id)
+	{
+		led_source_remove(m_script_source_id);
+		m_script_source_id = 0;
+	}
+	if(NULL != m_script_event)
+	{
+		m_script_event->removeWaiter(this);
+		m_script_event = NULL;
+	}
+	ledScript::handle_t::from_address(m_script).destroy();
+	m_script = NULL;
+	m_script_cancelled = false;
 }
+#endif /*LEDMGR_COROUTINES*/
 
 /** @} */  //END OF GROUP LED_APIS
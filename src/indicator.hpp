@@ -16,23 +16,37 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
 */
-#include <iostream>
+#include <string>
 #include "ledmgr_types.hpp"
 #include "pthread.h"
-#include "frontPanelIndicator.hpp"
-#include <glib.h>
+#include "lockstats.hpp"
+#include "ledbackend.hpp"
+#include "coloranimation.hpp"
+#include "checkpoint.hpp"
+#include "ledmgr_status.h"
+#include "ledscript.hpp"
+#include "ledloop.hpp"
 
+class syncGroup;
+class scriptEvent;
 
 class indicator
 {
+	friend class syncGroup;
+#ifdef LEDMGR_COROUTINES
+	friend class scriptSleep;
+	friend class scriptEvent;
+#endif
+
 	public:
 		typedef struct
 		{
 			bool isValid;
 			indicatorState_t state;
-			const blinkPattern_t *pattern_ptr;
+			const keyframePattern_t *pattern_ptr;
+			const blinkPattern_t *legacy_pattern_ptr;
 			int pattern_repetitions;
-			unsigned char sequence_read_offset;
+			unsigned int sequence_read_offset;
 			unsigned int intensity;
 			unsigned int color;	
 		}indicatorProperties_t;
@@ -41,34 +55,128 @@ class indicator
 		std::string m_name;
 		pthread_mutex_t m_mutex;
 		guint m_source_id;
-		device::FrontPanelIndicator *m_indicator;
+		ledBackend *m_backend;
+		int m_handle;
+		ledCapabilities_t m_capabilities;	/**< Cached from the backend; unsupported calls never reach it */
 
 		indicatorState_t m_state;
-		const blinkPattern_t *m_pattern_ptr;
+		/*Exactly one of the two pattern pointers is set while blinking.*/
+		const keyframePattern_t *m_pattern_ptr;
+		const blinkPattern_t *m_legacy_pattern_ptr;
 		int m_pattern_repetitions;
-		unsigned char m_sequence_read_offset;
+		unsigned int m_sequence_read_offset;
+		unsigned int m_ramp_elapsed;	/**< ms already spent in the current keyframe (eased ramps, resume) */
+		unsigned int m_ramp_level;	/**< Brightness last written by an eased keyframe */
 		unsigned int m_preflare_brightness;
 
+		guint m_color_source_id;
+		const colorAnimation *m_color_animation;
+		unsigned int m_color_step;
+		int m_color_repetitions;
+
 		indicatorProperties_t m_saved_properties;
+		syncGroup *m_sync_group;
+		checkpointSlot_t *m_checkpoint;	/**< Crash-resume record, NULL when checkpointing is off */
+		ledmgr_status_indicator_t *m_status;	/**< Status page record, NULL when not publishing */
+		bool m_output_lit;		/**< Last values written to the backend, for the status page */
+		unsigned int m_output_brightness;
+		unsigned int m_output_color;
+		bool m_output_suspended;	/**< Writes are held back; the m_output_* fields keep what should be shown */
+		unsigned int m_output_touched;	/**< Outputs written while suspended, to be restored on resume */
+		energyBucket_t m_energy[MAX_ENERGY_BUCKETS];	/**< On-time by power state and pattern */
+		unsigned int m_num_energy_buckets;
+		uint64_t m_energy_since_us;	/**< Start of the running energy segment */
+		bool m_energy_lit;		/**< What the hardware shows during that segment */
+		unsigned int m_energy_brightness;
+		unsigned int m_energy_pattern_id;
+		int m_energy_power_state;
+		/*Script state is declared whether or not LEDMGR_COROUTINES is set: the OEM library embeds indicators
+		 * through ledMgrBase and is built without it, so no build flag may change this layout.*/
+		void *m_script;			/**< Frame of the running script, ledScript::handle_t::address(), NULL if none */
+		guint m_script_source_id;
+		bool m_script_running;		/**< Script is executing; cancelling it is deferred to its next suspension */
+		bool m_script_cancelled;
+		scriptEvent *m_script_event;	/**< Event the script is waiting on */
+		indicator *m_next_event_waiter;	/**< Next indicator waiting on the same event, guarded by the event */
+		int m_script_event_value;
+
+		/*Timer callbacks and sync groups hold the address of the indicator, so it must never be copied or moved.*/
+		indicator(const indicator &);
+		indicator& operator=(const indicator &);
 
 	public:
 		/* Configure with appropriate identifier.*/
-		indicator(const std::string &name);
+		indicator(const std::string &name, ledBackend &backend = getDefaultLedBackend());
 		~indicator();
 		const std::string& getName() const;
 		int setState(indicatorState_t state);
+		int setBlink(const keyframePattern_t *pattern, int repetitions = -1);
 		int setBlink(const blinkPattern_t *pattern, int repetitions = -1);
-		void setColor(const unsigned int color);
+		const ledCapabilities_t& getCapabilities() const;
+		int setColor(const unsigned int color);
+		int setColorAnimation(const colorAnimation *animation, int repetitions = -1);
+		void stopColorAnimation();
+		int colorTimerCallback(void);
 		int timerCallback(void);
 		void saveState();
 		void restoreState();
 		void executeFlare(const unsigned int percentage_increase, const unsigned int length_ms);
 		void flareCallback(void);
+		void leaveSyncGroup();
+		void attachCheckpoint(checkpointSlot_t *slot);
+		void attachStatus(ledmgr_status_indicator_t *entry);
+		bool usesPattern(const keyframePattern_t *pattern);
+		void resumeState(const checkpointSlot_t &slot, const keyframePattern_t *pattern, const keyframePattern_t *saved_pattern);
+		void suspendOutput(const deepSleepState_t &hardware_state);
+		void resumeOutput();
+		void accountPowerState(int power_state);
+		unsigned int getEnergy(energyBucket_t *buckets, unsigned int max_buckets);
+#ifdef LEDMGR_COROUTINES
+		int runScript(ledScript script);
+		void stopScript();
+		void driveLevel(unsigned int brightness);
+		void driveColor(unsigned int color);
+		void scriptTimerCallback();
+#endif
 	private:
+		typedef struct
+		{
+			unsigned int duration;
+			unsigned int brightness;
+			bool has_color;
+			unsigned int color;
+			keyframeEasing_t easing;
+		}resolvedKeyframe_t;
+
+		int startBlink(const keyframePattern_t *pattern, const blinkPattern_t *legacy_pattern, int repetitions);
+		unsigned int getNumKeyframes() const;
+		void getKeyframe(unsigned int offset, resolvedKeyframe_t &frame) const;
+		void applyKeyframe(const resolvedKeyframe_t &frame);
+		void applyLevel(unsigned int brightness);
 		int step();
+		void enterSyncGroup(syncGroup *group);
+		void exitSyncGroup(syncGroup *group);
+		void applySyncedKeyframe(const keyframePattern_t *pattern, unsigned int offset);
 		int registerCallback(unsigned int milliseconds);
+		void resumeBlink(const keyframePattern_t *pattern, const checkpointLayer_t &layer);
+		void checkpointActive(unsigned int offset, int repetitions, uint64_t keyframe_start_us);
+		void checkpointSaved();
+		int stepColor();
+		void cancelColorAnimation();
 		void setBrightness(unsigned int intensity);
+		void writeColor(unsigned int color);
+		void publishStatus();
+		unsigned int getActivePatternId() const;
+		void accountEnergy();
+		energyBucket_t * findEnergyBucket(int power_state, unsigned int pattern_id);
 		int enableIndicator(bool enable);
+#ifdef LEDMGR_COROUTINES
+		void scheduleScript(unsigned int milliseconds);
+		void waitScriptEvent(scriptEvent *event);
+		void scriptEventCallback(scriptEvent *event, int value);
+		void resumeScriptLocked();
+		void destroyScriptLocked();
+#endif
 
 };
 
@@ -0,0 +1,406 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdexcept>
+#include "indicatorgroup.hpp"
+#include "ledtiming.hpp"
+
+static const uint32_t GROUP_COLOR_UNSET = 0xFFFFFFFF;
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+/**
+ * @brief Callback function to advance an indicator group by one frame.
+ *
+ * @param[in] data      address of indicatorGroup class.
+ *
+ * @return  Returns true to keep the frame timer running.
+ */
+static gboolean masterGroupCallbackFunction(gpointer data)
+{
+	indicatorGroup *ptr = (indicatorGroup *)data;
+	ptr->tick();
+	return true;
+}
+
+indicatorGroup::indicatorGroup(const std::string &name, const std::string &member_prefix, unsigned int num_members, ledBackend &backend) :
+	m_handles(num_members), m_capabilities(num_members), m_phase(num_members, 0), m_level(num_members, 100), m_color(num_members, GROUP_COLOR_UNSET),
+	m_brightness(num_members, 0), m_pushed_brightness(num_members, 0xFF), m_pushed_color(num_members, GROUP_COLOR_UNSET)
+{
+	m_name = name;
+	m_source_id = 0;
+	m_backend = &backend;
+	m_size = num_members;
+	m_effect = GROUP_EFFECT_SOLID;
+	m_time = 0;
+	m_time_increment = 0;
+	m_lit = false;
+	m_output_suspended = false;
+
+	pthread_mutexattr_t mutex_attribute;
+	REPORT_IF_UNEQUAL(0, pthread_mutexattr_init(&mutex_attribute));
+	REPORT_IF_UNEQUAL(0, pthread_mutexattr_settype(&mutex_attribute, PTHREAD_MUTEX_RECURSIVE));
+	REPORT_IF_UNEQUAL(0, pthread_mutex_init(&m_mutex, &mutex_attribute));
+
+	unsigned int num_opened = 0;
+	for(unsigned int i = 0; i < m_size; i++)
+	{
+		char member_name[64];
+		snprintf(member_name, sizeof(member_name), "%s%u", member_prefix.c_str(), i);
+		m_handles[i] = m_backend->open(member_name);
+		if((0 > m_handles[i]) || (0 != m_backend->getCapabilities(m_handles[i], m_capabilities[i])))
+		{
+			ERROR("Could not open group member %s!\n", member_name);
+			m_capabilities[i].mask = 0;
+			m_capabilities[i].min_brightness = 0;
+			m_capabilities[i].max_brightness = 0;
+		}
+		else
+		{
+			num_opened++;
+		}
+	}
+	if(0 == num_opened)
+	{
+		ERROR("No member of group %s could be opened!\n", m_name.c_str());
+		pthread_mutex_destroy(&m_mutex);
+		throw std::invalid_argument("No group member could be opened!");
+	}
+	INFO("Indicator group %s initialized with %u of %u members\n", m_name.c_str(), num_opened, m_size);
+}
+
+indicatorGroup::~indicatorGroup()
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATORGROUP));
+	cancelTimer();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	pthread_mutex_destroy(&m_mutex);
+}
+
+/**
+ * @brief API to return the group name.
+ */
+const std::string& indicatorGroup::getName() const
+{
+	return m_name;
+}
+
+/**
+ * @brief API to return the number of LEDs in the group.
+ */
+unsigned int indicatorGroup::getSize() const
+{
+	return m_size;
+}
+
+void indicatorGroup::cancelTimer()
+{
+	if(0 != m_source_id)
+	{
+		REPORT_IF_UNEQUAL(true, led_source_remove(m_source_id));
+		m_source_id = 0;
+	}
+}
+
+/**
+ * @brief This API starts an effect on the whole group, driven by a single frame timer.
+ *
+ * @param[in] effect		effect to run.
+ * @param[in] period_ms		duration of one effect cycle.
+ * @param[in] frame_ms		frame interval.
+ *
+ * @return  Returns status of the operation.
+ */
+int indicatorGroup::start(groupEffect_t effect, unsigned int period_ms, unsigned int frame_ms)
+{
+	if((GROUP_EFFECT_SOLID != effect) && ((0 == frame_ms) || (frame_ms > period_ms)))
+	{
+		ERROR("Bad inputs!\n");
+		return -1;
+	}
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATORGROUP));
+	cancelTimer();
+
+	m_effect = effect;
+	m_time = 0;
+	m_lit = true;
+	for(unsigned int i = 0; i < m_size; i++)
+	{
+		/*Travelling effects spread the members evenly over one wave.*/
+		m_phase[i] = (GROUP_EFFECT_SPIN == effect || GROUP_EFFECT_CHASE == effect) ? (uint16_t)((i * 65536ULL) / m_size) : 0;
+		if((0 != (m_capabilities[i].mask & LED_CAP_STATE)) && !m_output_suspended)
+		{
+			m_backend->setState(m_handles[i], true);
+		}
+	}
+
+	if(GROUP_EFFECT_SOLID == effect)
+	{
+		m_time_increment = 0;
+		tick();
+	}
+	else
+	{
+		unsigned long long increment = (65536ULL * frame_ms) / period_ms;
+		m_time_increment = (uint16_t)(0 == increment ? 1 : (65535 < increment ? 65535 : increment));
+		tick();
+		m_source_id = led_timeout_add(frame_ms, masterGroupCallbackFunction, (gpointer)this);
+		if(0 == m_source_id)
+		{
+			ERROR("Could not register callback!\n");
+		}
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	INFO("Group %s started effect %d\n", m_name.c_str(), effect);
+	return 0;
+}
+
+/**
+ * @brief This API stops the running effect.
+ *
+ * @param[in] leave_on   keep the LEDs at their current frame instead of switching them off.
+ */
+void indicatorGroup::stop(bool leave_on)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATORGROUP));
+	cancelTimer();
+	if(!leave_on)
+	{
+		m_lit = false;
+		for(unsigned int i = 0; (i < m_size) && !m_output_suspended; i++)
+		{
+			if(0 != (m_capabilities[i].mask & LED_CAP_STATE))
+			{
+				m_backend->setState(m_handles[i], false);
+			}
+		}
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API sets the peak brightness of one LED.
+ *
+ * @return  Returns status of the operation.
+ */
+int indicatorGroup::setLevel(unsigned int led, unsigned int level)
+{
+	if((m_size <= led) || (100 < level))
+	{
+		ERROR("Bad inputs!\n");
+		return -1;
+	}
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATORGROUP));
+	m_level[led] = (uint8_t)level;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return 0;
+}
+
+/**
+ * @brief This API sets the color of one LED. It is written with the next frame.
+ *
+ * @return  Returns status of the operation.
+ */
+int indicatorGroup::setColor(unsigned int led, unsigned int color)
+{
+	if(m_size <= led)
+	{
+		ERROR("Bad inputs!\n");
+		return -1;
+	}
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATORGROUP));
+	m_color[led] = color;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return 0;
+}
+
+/**
+ * @brief This API sets the color of every LED in the group.
+ */
+void indicatorGroup::setColor(unsigned int color)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATORGROUP));
+	for(unsigned int i = 0; i < m_size; i++)
+	{
+		m_color[i] = color;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API computes the brightness of every LED for the current frame.
+ *
+ * A single branch-free pass over the contiguous arrays so that the compiler can vectorize it.
+ */
+void indicatorGroup::renderFrame()
+{
+	const unsigned int size = m_size;
+	const uint16_t time = m_time;
+	const uint16_t *phase = &m_phase[0];
+	const uint8_t *level = &m_level[0];
+	uint8_t *brightness = &m_brightness[0];
+
+	switch(m_effect)
+	{
+		case GROUP_EFFECT_SOLID:
+			for(unsigned int i = 0; i < size; i++)
+			{
+				brightness[i] = level[i];
+			}
+			break;
+
+		case GROUP_EFFECT_CHASE:
+			for(unsigned int i = 0; i < size; i++)
+			{
+				int position = (uint16_t)(phase[i] + time) >> 8;
+				int wave = 255 - abs((position << 1) - 255);
+				/*Keep only the top quarter of the wave to get a narrow segment.*/
+				int peak = (wave << 2) - 765;
+				peak = (peak < 0) ? 0 : peak;
+				brightness[i] = (uint8_t)((peak * level[i]) / 255);
+			}
+			break;
+
+		default: /*GROUP_EFFECT_BREATHE, GROUP_EFFECT_SPIN*/
+			for(unsigned int i = 0; i < size; i++)
+			{
+				int position = (uint16_t)(phase[i] + time) >> 8;
+				int wave = 255 - abs((position << 1) - 255);
+				brightness[i] = (uint8_t)((wave * level[i]) / 255);
+			}
+			break;
+	}
+}
+
+/**
+ * @brief This API writes the LEDs whose brightness or color differ from what was last written. Only the
+ * calls a member supports are made, so members that could not be opened keep their place in the effect
+ * but are never written. Brightness is scaled from 0-100 into the member's own range.
+ *
+ * @return  Returns the number of LEDs written.
+ */
+int indicatorGroup::pushFrame()
+{
+	int num_pushed = 0;
+	for(unsigned int i = 0; i < m_size; i++)
+	{
+		const ledCapabilities_t &capabilities = m_capabilities[i];
+		bool pushed = false;
+		if((0 != (capabilities.mask & LED_CAP_COLOR)) && (GROUP_COLOR_UNSET != m_color[i]) && (m_color[i] != m_pushed_color[i]))
+		{
+			m_backend->setColor(m_handles[i], m_color[i]);
+			m_pushed_color[i] = m_color[i];
+			pushed = true;
+		}
+		if((0 != (capabilities.mask & LED_CAP_BRIGHTNESS)) && (m_brightness[i] != m_pushed_brightness[i]))
+		{
+			m_backend->setBrightness(m_handles[i], scaleBrightness(i, m_brightness[i]));
+			m_pushed_brightness[i] = m_brightness[i];
+			pushed = true;
+		}
+		num_pushed += (pushed ? 1 : 0);
+	}
+	return num_pushed;
+}
+
+/**
+ * @brief This API renders and writes one frame, then advances the effect.
+ *
+ * @return  Returns the number of LEDs written.
+ */
+int indicatorGroup::tick()
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATORGROUP));
+	renderFrame();
+	int num_pushed = m_output_suspended ? 0 : pushFrame();
+	m_time += m_time_increment;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return num_pushed;
+}
+
+/**
+ * @brief This API shows the deep-sleep hardware state on every member in one pass and holds back every
+ * write from then on, while the group carries on tracking what it would show. Its frame timer is frozen
+ * separately, by suspend_led_timers().
+ *
+ * @param[in] hardware_state   what the members show until resumeOutput().
+ */
+void indicatorGroup::suspendOutput(const deepSleepState_t &hardware_state)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATORGROUP));
+	if(!m_output_suspended)
+	{
+		for(unsigned int i = 0; i < m_size; i++)
+		{
+			const ledCapabilities_t &capabilities = m_capabilities[i];
+			if(hardware_state.lit && (0 != hardware_state.brightness) && (0 != (capabilities.mask & LED_CAP_BRIGHTNESS)))
+			{
+				m_backend->setBrightness(m_handles[i], scaleBrightness(i, hardware_state.brightness));
+			}
+			if(0 != (capabilities.mask & LED_CAP_STATE))
+			{
+				m_backend->setState(m_handles[i], hardware_state.lit);
+			}
+		}
+		m_output_suspended = true;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API ends suspendOutput(): every member is written back as the group now wants it.
+ */
+void indicatorGroup::resumeOutput()
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_INDICATORGROUP));
+	if(m_output_suspended)
+	{
+		m_output_suspended = false;
+		for(unsigned int i = 0; i < m_size; i++)
+		{
+			/*Whatever was written last, the deep-sleep state has replaced it.*/
+			m_pushed_brightness[i] = 0xFF;
+			m_pushed_color[i] = GROUP_COLOR_UNSET;
+			if(0 != (m_capabilities[i].mask & LED_CAP_STATE))
+			{
+				m_backend->setState(m_handles[i], m_lit);
+			}
+		}
+		if(m_lit)
+		{
+			renderFrame();
+			pushFrame();
+		}
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/*Maps a 0-100 brightness into the member's own range.*/
+unsigned int indicatorGroup::scaleBrightness(unsigned int member, unsigned int brightness) const
+{
+	const ledCapabilities_t &capabilities = m_capabilities[member];
+	unsigned int range = capabilities.max_brightness - capabilities.min_brightness;
+	return capabilities.min_brightness + ((brightness * range) + 50) / 100;
+}
+
+/** @} */  //END OF GROUP LED_APIS
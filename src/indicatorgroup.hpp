@@ -0,0 +1,99 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef INDICATORGROUP_H
+#define INDICATORGROUP_H
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "ledmgr_types.hpp"
+#include "ledbackend.hpp"
+#include "pthread.h"
+#include "lockstats.hpp"
+#include "ledloop.hpp"
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+#define DEFAULT_GROUP_FRAME_MS 40	/**< 25 frames per second */
+
+typedef enum
+{
+	GROUP_EFFECT_SOLID = 0,	/**< Every LED held at its level */
+	GROUP_EFFECT_BREATHE,	/**< All LEDs fade in and out together */
+	GROUP_EFFECT_SPIN,	/**< Triangle wave travelling around the group */
+	GROUP_EFFECT_CHASE,	/**< Narrow lit segment travelling around the group */
+}groupEffect_t;
+
+/* @} */ // End of group LED_TYPES
+
+/*Animates a set of LEDs (e.g. the segments of a ring) as one unit. Per-LED phase, level, color and
+ * brightness are kept in contiguous arrays; each frame is computed in a single pass from one timer
+ * and only the LEDs whose value changed are written to the backend.*/
+class indicatorGroup
+{
+	private:
+		std::string m_name;
+		pthread_mutex_t m_mutex;
+		guint m_source_id;
+		ledBackend *m_backend;
+		unsigned int m_size;
+
+		groupEffect_t m_effect;
+		uint16_t m_time;		/**< Wave position, 256 units per wave step */
+		uint16_t m_time_increment;	/**< Advance per frame */
+		bool m_lit;			/**< Members switched on by start() */
+		bool m_output_suspended;	/**< Deep sleep: frames are tracked but not written */
+
+		std::vector <int> m_handles;
+		std::vector <ledCapabilities_t> m_capabilities;	/**< Cached per member; none for members that could not be opened */
+		std::vector <uint16_t> m_phase;		/**< Per-LED wave offset */
+		std::vector <uint8_t> m_level;		/**< Per-LED peak brightness, 0-100 */
+		std::vector <uint32_t> m_color;
+		std::vector <uint8_t> m_brightness;	/**< Current frame */
+		std::vector <uint8_t> m_pushed_brightness;	/**< Last value written to the backend */
+		std::vector <uint32_t> m_pushed_color;
+
+		indicatorGroup(const indicatorGroup &);
+		indicatorGroup& operator=(const indicatorGroup &);
+
+	public:
+		/* Members are the backend indicators "<member_prefix>0" .. "<member_prefix><num_members - 1>". Throws
+		 * std::invalid_argument if none of them can be opened.*/
+		indicatorGroup(const std::string &name, const std::string &member_prefix, unsigned int num_members,
+				ledBackend &backend = getDefaultLedBackend());
+		~indicatorGroup();
+		const std::string& getName() const;
+		unsigned int getSize() const;
+		int start(groupEffect_t effect, unsigned int period_ms, unsigned int frame_ms = DEFAULT_GROUP_FRAME_MS);
+		void stop(bool leave_on);
+		int setLevel(unsigned int led, unsigned int level);
+		int setColor(unsigned int led, unsigned int color);
+		void setColor(unsigned int color);
+		int tick();
+		void renderFrame();
+		int pushFrame();
+		void suspendOutput(const deepSleepState_t &hardware_state);
+		void resumeOutput();
+	private:
+		void cancelTimer();
+		unsigned int scaleBrightness(unsigned int member, unsigned int brightness) const;
+};
+
+#endif /*INDICATORGROUP_H*/
@@ -0,0 +1,80 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef LEDBACKEND_H
+#define LEDBACKEND_H
+#include <string>
+#include <vector>
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+#define MAX_LED_HANDLES 256	/**< Maximum number of indicators a backend can hand out */
+
+typedef enum
+{
+	LED_CAP_STATE = 0x01,		/**< Can be switched on and off */
+	LED_CAP_BLINK = 0x02,		/**< Can play blink patterns; they are timed in software on top of on/off */
+	LED_CAP_BRIGHTNESS = 0x04,	/**< Brightness can be read and set */
+	LED_CAP_COLOR = 0x08,		/**< Color can be read and set */
+	LED_CAPS_ALL = 0x0F,
+}ledCapability_t;
+
+typedef struct
+{
+	unsigned int mask;		/**< ledCapability_t bits */
+	unsigned int min_brightness;	/**< Range setBrightness() accepts, with LED_CAP_BRIGHTNESS */
+	unsigned int max_brightness;
+}ledCapabilities_t;
+
+/* @} */ // End of group LED_TYPES
+
+/*Hardware-facing interface used by indicator. All calls return 0 on success and -1 on failure;
+ * implementations must not let exceptions escape.*/
+class ledBackend
+{
+	public:
+		virtual ~ledBackend() {}
+		/* Returns a handle for the named indicator, or -1 if there is no such indicator.*/
+		virtual int open(const std::string &name) = 0;
+		virtual int setState(int handle, bool enable) = 0;
+		virtual int setBrightness(int handle, unsigned int intensity) = 0;
+		virtual int getBrightness(int handle, unsigned int &intensity) = 0;
+		virtual int setColor(int handle, unsigned int color) = 0;
+		virtual int getColor(int handle, unsigned int &color) = 0;
+		/* Logs backend statistics, if the backend keeps any.*/
+		virtual void diagnostics() {}
+		/* Names every indicator the hardware has, for autodetection. Backends that cannot tell fail.*/
+		virtual int listIndicators(std::vector<std::string> &names) { return -1; }
+		/* What the indicator behind the handle supports, found out when it was opened. Backends that
+		 * cannot tell claim everything, so that calls go through as they always did.*/
+		virtual int getCapabilities(int handle, ledCapabilities_t &capabilities)
+		{
+			capabilities.mask = LED_CAPS_ALL;
+			capabilities.min_brightness = 0;
+			capabilities.max_brightness = 100;
+			return 0;
+		}
+};
+
+/* Backend used by indicators that are not given one explicitly. The daemon links the DS
+ * implementation; tools link a stand-in.*/
+ledBackend& getDefaultLedBackend();
+
+#endif /*LEDBACKEND_H*/
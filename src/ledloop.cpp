@@ -0,0 +1,499 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "ledloop.hpp"
+#include "ledmgr_types.hpp"
+
+#ifndef LEDMGR_EPOLL_LOOP
+#include <glib-unix.h>
+
+struct ledWakeup
+{
+	GSource source;
+	GSourceFunc function;
+	gpointer data;
+};
+
+static GMainLoop *g_loop = NULL;
+
+static gboolean wakeupSourceDispatch(GSource *source, GSourceFunc callback, gpointer data)
+{
+	ledWakeup_t *wakeup = (ledWakeup_t *)source;
+	g_source_set_ready_time(source, -1);
+	wakeup->function(wakeup->data);
+	return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs g_wakeup_source_funcs = {NULL, NULL, wakeupSourceDispatch, NULL};
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+/**
+ * @brief This API watches a file descriptor on the main loop.
+ *
+ * @return  Returns the watch ID.
+ */
+guint led_fd_add(gint fd, GIOCondition condition, GUnixFDSourceFunc function, gpointer data)
+{
+	return g_unix_fd_add(fd, condition, function, data);
+}
+
+/**
+ * @brief This API removes a watch. It may be called from the watch's own callback.
+ *
+ * @return  Returns TRUE if the watch existed.
+ */
+gboolean led_fd_remove(guint watch_id)
+{
+	return g_source_remove(watch_id);
+}
+
+/**
+ * @brief This API creates a wakeup: a glib source on the default main context that calls function each
+ * time the ready time set with led_wakeup_set() passes. One wakeup can be re-armed for every deadline
+ * instead of adding a glib timeout per deadline.
+ *
+ * @return  Returns the disarmed wakeup, to be released with led_wakeup_free().
+ */
+ledWakeup_t * led_wakeup_new(GSourceFunc function, gpointer data)
+{
+	ledWakeup_t *wakeup = (ledWakeup_t *)g_source_new(&g_wakeup_source_funcs, sizeof(ledWakeup_t));
+	wakeup->function = function;
+	wakeup->data = data;
+	g_source_set_ready_time(&wakeup->source, -1);
+	g_source_attach(&wakeup->source, NULL);
+	return wakeup;
+}
+
+/**
+ * @brief This API arms a wakeup for a monotonic time in microseconds, or disarms it with -1.
+ */
+void led_wakeup_set(ledWakeup_t *wakeup, gint64 ready_time_us)
+{
+	g_source_set_ready_time(&wakeup->source, ready_time_us);
+}
+
+void led_wakeup_free(ledWakeup_t *wakeup)
+{
+	g_source_destroy(&wakeup->source);
+	g_source_unref(&wakeup->source);
+}
+
+gint64 led_monotonic_us()
+{
+	return g_get_monotonic_time();
+}
+
+/**
+ * @brief This API runs the main loop until led_loop_quit() is called.
+ *
+ * @return  Returns 0 once the loop has stopped.
+ */
+int led_loop_run()
+{
+	g_loop = g_main_loop_new(NULL, false);
+	g_main_loop_run(g_loop);
+	g_main_loop_unref(g_loop);
+	g_loop = NULL;
+	return 0;
+}
+
+void led_loop_quit()
+{
+	if(NULL != g_loop)
+	{
+		g_main_loop_quit(g_loop);
+	}
+}
+
+/** @} */  //END OF GROUP LED_APIS
+
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include "pthread.h"
+
+#define WATCH_INDEX_BITS 5	/**< Low bits of a watch ID select its slot */
+#define MAX_LOOP_EVENTS 16	/**< Events taken per epoll_wait() */
+#define TIMER_KEY 0ULL		/**< epoll keys of the loop's own descriptors; watches use their ID */
+#define QUIT_KEY (1ULL << 32)
+
+struct ledWakeup
+{
+	bool in_use;
+	gint64 ready_time_us;	/**< -1 while disarmed */
+	GSourceFunc function;
+	gpointer data;
+};
+
+typedef struct
+{
+	guint id;		/**< 0 while the slot is free */
+	gint fd;		/**< As given to led_fd_add(), passed to the callback */
+	int epoll_fd;		/**< Duplicate of fd registered with epoll */
+	GIOCondition condition;
+	GUnixFDSourceFunc function;
+	gpointer data;
+}loopWatch_t;
+
+static pthread_mutex_t g_loop_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int g_epoll_fd = -1;
+static int g_timer_fd = -1;
+static int g_quit_fd = -1;
+static bool g_quit = false;
+static loopWatch_t g_watches[MAX_LOOP_WATCHES];
+static guint g_next_watch_serial = 1;
+static ledWakeup_t g_wakeups[MAX_LOOP_WAKEUPS];
+static gint64 g_armed_us = -1;		/**< Time the timerfd is set for, -1 if disarmed */
+static bool g_dispatching = false;	/**< Timerfd is re-armed once after the dispatch, not per change */
+
+static bool add_loop_fd(int fd, uint64_t key, uint32_t events)
+{
+	struct epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = events;
+	event.data.u64 = key;
+	return (0 == epoll_ctl(g_epoll_fd, EPOLL_CTL_ADD, fd, &event));
+}
+
+/*Creates the loop's descriptors on first use. Called with g_loop_mutex held.*/
+static bool init_loop_locked()
+{
+	if(-1 != g_epoll_fd)
+	{
+		return true;
+	}
+	g_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	g_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	g_quit_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if((-1 != g_epoll_fd) && (-1 != g_timer_fd) && (-1 != g_quit_fd) &&
+		add_loop_fd(g_timer_fd, TIMER_KEY, EPOLLIN) && add_loop_fd(g_quit_fd, QUIT_KEY, EPOLLIN))
+	{
+		return true;
+	}
+	ERROR("Could not set up the main loop: %s\n", strerror(errno));
+	close(g_epoll_fd);
+	close(g_timer_fd);
+	close(g_quit_fd);
+	g_epoll_fd = g_timer_fd = g_quit_fd = -1;
+	return false;
+}
+
+/*Points the timerfd at the earliest wakeup. A ready time in the past fires at once. Called with
+ * g_loop_mutex held whenever a ready time changes.*/
+static void arm_timer_locked()
+{
+	if(g_dispatching)
+	{
+		return;
+	}
+	gint64 earliest_us = -1;
+	for(unsigned int i = 0; i < MAX_LOOP_WAKEUPS; i++)
+	{
+		ledWakeup_t &wakeup = g_wakeups[i];
+		if(wakeup.in_use && (0 <= wakeup.ready_time_us) && ((0 > earliest_us) || (wakeup.ready_time_us < earliest_us)))
+		{
+			earliest_us = wakeup.ready_time_us;
+		}
+	}
+	if(earliest_us == g_armed_us)
+	{
+		return;
+	}
+	struct itimerspec timer;
+	memset(&timer, 0, sizeof(timer));
+	if(0 <= earliest_us)
+	{
+		gint64 time_us = (0 < earliest_us) ? earliest_us : 1;	/*All zero would disarm*/
+		timer.it_value.tv_sec = time_us / G_USEC_PER_SEC;
+		timer.it_value.tv_nsec = (time_us % G_USEC_PER_SEC) * 1000;
+	}
+	REPORT_IF_UNEQUAL(0, timerfd_settime(g_timer_fd, TFD_TIMER_ABSTIME, &timer, NULL));
+	g_armed_us = earliest_us;
+}
+
+static void dispatch_wakeups()
+{
+	uint64_t expirations;
+	if(0 > read(g_timer_fd, &expirations, sizeof(expirations)))
+	{
+		/*EAGAIN: re-armed since it fired. Whatever is due still runs below.*/
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_loop_mutex));
+	g_armed_us = -1;	/*A one-shot timerfd disarms itself when it fires*/
+	gint64 now_us = led_monotonic_us();
+	for(unsigned int i = 0; i < MAX_LOOP_WAKEUPS; i++)
+	{
+		ledWakeup_t &wakeup = g_wakeups[i];
+		if(!wakeup.in_use || (0 > wakeup.ready_time_us) || (wakeup.ready_time_us > now_us))
+		{
+			continue;
+		}
+		wakeup.ready_time_us = -1;
+		GSourceFunc function = wakeup.function;
+		gpointer data = wakeup.data;
+		REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_loop_mutex));
+		function(data);
+		REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_loop_mutex));
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_loop_mutex));
+}
+
+/*Callbacks of one wait typically move ready times several times each (every timer armed or removed
+ * does); the timerfd follows only once they are all done.*/
+static void set_dispatching(bool dispatching)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_loop_mutex));
+	g_dispatching = dispatching;
+	arm_timer_locked();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_loop_mutex));
+}
+
+static void dispatch_watch(guint watch_id, uint32_t events)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_loop_mutex));
+	loopWatch_t &watch = g_watches[watch_id & (MAX_LOOP_WATCHES - 1)];
+	if(watch.id != watch_id)
+	{
+		/*Removed by an earlier callback of the same wait.*/
+		REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_loop_mutex));
+		return;
+	}
+	gint fd = watch.fd;
+	GUnixFDSourceFunc function = watch.function;
+	gpointer data = watch.data;
+	int condition = (events & EPOLLIN ? G_IO_IN : 0) | (events & EPOLLPRI ? G_IO_PRI : 0) |
+		(events & EPOLLOUT ? G_IO_OUT : 0) | (events & EPOLLERR ? G_IO_ERR : 0) | (events & EPOLLHUP ? G_IO_HUP : 0);
+	condition &= (watch.condition | G_IO_ERR | G_IO_HUP);
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_loop_mutex));
+
+	if(!function(fd, (GIOCondition)condition, data))
+	{
+		led_fd_remove(watch_id);
+	}
+}
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+/**
+ * @brief This API watches a file descriptor on the main loop. epoll registers a descriptor once, and a
+ * socket may be watched for input and output separately, so each watch registers a duplicate of fd.
+ *
+ * @return  Returns the watch ID, or 0 on failure.
+ */
+guint led_fd_add(gint fd, GIOCondition condition, GUnixFDSourceFunc function, gpointer data)
+{
+	guint watch_id = 0;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_loop_mutex));
+	for(unsigned int i = 0; (i < MAX_LOOP_WATCHES) && init_loop_locked(); i++)
+	{
+		loopWatch_t &watch = g_watches[i];
+		if(0 != watch.id)
+		{
+			continue;
+		}
+		int epoll_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+		if(0 == (g_next_watch_serial << WATCH_INDEX_BITS))
+		{
+			g_next_watch_serial = 1;	/*Keep IDs non-zero*/
+		}
+		guint id = (g_next_watch_serial++ << WATCH_INDEX_BITS) | i;
+		uint32_t events = (condition & G_IO_IN ? EPOLLIN : 0) | (condition & G_IO_PRI ? EPOLLPRI : 0) |
+			(condition & G_IO_OUT ? EPOLLOUT : 0);
+		if((-1 == epoll_fd) || !add_loop_fd(epoll_fd, id, events))
+		{
+			ERROR("Could not watch fd %d: %s\n", fd, strerror(errno));
+			if(-1 != epoll_fd)
+			{
+				close(epoll_fd);
+			}
+			break;
+		}
+		watch.id = id;
+		watch.fd = fd;
+		watch.epoll_fd = epoll_fd;
+		watch.condition = condition;
+		watch.function = function;
+		watch.data = data;
+		watch_id = id;
+		break;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_loop_mutex));
+	if(0 == watch_id)
+	{
+		ERROR("Out of main loop watches!\n");
+	}
+	return watch_id;
+}
+
+/**
+ * @brief This API removes a watch. It may be called from the watch's own callback.
+ *
+ * @return  Returns TRUE if the watch existed.
+ */
+gboolean led_fd_remove(guint watch_id)
+{
+	gboolean removed = FALSE;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_loop_mutex));
+	loopWatch_t &watch = g_watches[watch_id & (MAX_LOOP_WATCHES - 1)];
+	if((0 != watch_id) && (watch.id == watch_id))
+	{
+		/*Closing the duplicate alone would leave it registered while the caller's fd keeps the file open.*/
+		REPORT_IF_UNEQUAL(0, epoll_ctl(g_epoll_fd, EPOLL_CTL_DEL, watch.epoll_fd, NULL));
+		close(watch.epoll_fd);
+		watch.id = 0;
+		removed = TRUE;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_loop_mutex));
+	return removed;
+}
+
+/**
+ * @brief This API creates a wakeup, which calls function each time the ready time set with
+ * led_wakeup_set() passes. All wakeups share the loop's timerfd, set for the earliest of them.
+ *
+ * @return  Returns the disarmed wakeup, to be released with led_wakeup_free(), or NULL if all are in use.
+ */
+ledWakeup_t * led_wakeup_new(GSourceFunc function, gpointer data)
+{
+	ledWakeup_t *new_wakeup = NULL;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_loop_mutex));
+	for(unsigned int i = 0; (i < MAX_LOOP_WAKEUPS) && init_loop_locked(); i++)
+	{
+		if(!g_wakeups[i].in_use)
+		{
+			new_wakeup = &g_wakeups[i];
+			new_wakeup->in_use = true;
+			new_wakeup->ready_time_us = -1;
+			new_wakeup->function = function;
+			new_wakeup->data = data;
+			break;
+		}
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_loop_mutex));
+	if(NULL == new_wakeup)
+	{
+		ERROR("Out of main loop wakeups!\n");
+	}
+	return new_wakeup;
+}
+
+/**
+ * @brief This API arms a wakeup for a monotonic time in microseconds, or disarms it with -1. The timerfd
+ * is only touched when the earliest ready time changes.
+ */
+void led_wakeup_set(ledWakeup_t *wakeup, gint64 ready_time_us)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_loop_mutex));
+	wakeup->ready_time_us = ready_time_us;
+	arm_timer_locked();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_loop_mutex));
+}
+
+void led_wakeup_free(ledWakeup_t *wakeup)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_loop_mutex));
+	wakeup->in_use = false;
+	wakeup->ready_time_us = -1;
+	arm_timer_locked();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_loop_mutex));
+}
+
+gint64 led_monotonic_us()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((gint64)now.tv_sec * G_USEC_PER_SEC) + (now.tv_nsec / 1000);
+}
+
+/**
+ * @brief This API runs the main loop until led_loop_quit() is called.
+ *
+ * @return  Returns 0 once the loop has stopped, -1 if it could not run.
+ */
+int led_loop_run()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_loop_mutex));
+	bool ready = init_loop_locked();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_loop_mutex));
+	if(!ready)
+	{
+		return -1;
+	}
+	g_quit = false;
+	while(!g_quit)
+	{
+		struct epoll_event events[MAX_LOOP_EVENTS];
+		int num_events = epoll_wait(g_epoll_fd, events, MAX_LOOP_EVENTS, -1);
+		if((0 > num_events) && (EINTR != errno))
+		{
+			ERROR("Main loop wait failed: %s\n", strerror(errno));
+			return -1;
+		}
+		set_dispatching(true);
+		for(int i = 0; i < num_events; i++)
+		{
+			if(TIMER_KEY == events[i].data.u64)
+			{
+				dispatch_wakeups();
+			}
+			else if(QUIT_KEY == events[i].data.u64)
+			{
+				uint64_t count;
+				if(0 < read(g_quit_fd, &count, sizeof(count)))
+				{
+					g_quit = true;
+				}
+			}
+			else
+			{
+				dispatch_watch((guint)events[i].data.u64, events[i].events);
+			}
+		}
+		set_dispatching(false);
+	}
+	return 0;
+}
+
+/**
+ * @brief This API stops the main loop. It may be called from any thread, and from a signal handler.
+ */
+void led_loop_quit()
+{
+	uint64_t count = 1;
+	if((-1 != g_quit_fd) && (0 > write(g_quit_fd, &count, sizeof(count))))
+	{
+		/*Nothing to do; the counter is already non-zero.*/
+	}
+}
+
+/** @} */  //END OF GROUP LED_APIS
+
+#endif /*LEDMGR_EPOLL_LOOP*/
@@ -0,0 +1,84 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef LEDLOOP_H
+#define LEDLOOP_H
+#include <stdint.h>
+
+#ifndef LEDMGR_EPOLL_LOOP
+#include <glib.h>
+#else
+/*The few glib types the daemon uses, so that the epoll loop build does not need glib at all.*/
+typedef int gint;
+typedef unsigned int guint;
+typedef gint gboolean;
+typedef void* gpointer;
+typedef int64_t gint64;
+typedef gboolean (*GSourceFunc)(gpointer user_data);
+
+typedef enum
+{
+	G_IO_IN = 1,
+	G_IO_PRI = 2,
+	G_IO_OUT = 4,
+	G_IO_ERR = 8,
+	G_IO_HUP = 16,
+	G_IO_NVAL = 32
+}GIOCondition;
+
+typedef gboolean (*GUnixFDSourceFunc)(gint fd, GIOCondition condition, gpointer user_data);
+
+#define FALSE 0
+#define TRUE 1
+#define G_SOURCE_REMOVE FALSE
+#define G_SOURCE_CONTINUE TRUE
+#define G_USEC_PER_SEC 1000000
+#endif /*LEDMGR_EPOLL_LOOP*/
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+#define MAX_LOOP_WATCHES 32	/**< File descriptor watches at once, epoll loop only */
+#define MAX_LOOP_WAKEUPS 8	/**< Wakeups at once, epoll loop only */
+
+typedef struct ledWakeup ledWakeup_t;
+
+/* @} */ // End of group LED_TYPES
+
+/*Main loop of the daemon. Everything that runs on the main loop goes through here: file descriptor
+ * watches (the command rings and the control socket) and wakeups, which call a function once a ready
+ * time passes and are re-armed by moving that time (LED timers and the debouncer).
+ *
+ * By default this is glib's GMainLoop on the default context. Configured with --enable-epoll-loop it is
+ * a small epoll loop instead: one epoll descriptor, one timerfd shared by all wakeups and an eventfd to
+ * stop the loop. Watches and wakeups then come from fixed tables, and glib is not linked.
+ *
+ * Watch callbacks keep the glib contract: return G_SOURCE_REMOVE to drop the watch. Wakeups are disarmed
+ * (ready time -1) before their function runs; its return value is ignored. led_wakeup_set() may be called
+ * from any thread.*/
+guint led_fd_add(gint fd, GIOCondition condition, GUnixFDSourceFunc function, gpointer data);
+gboolean led_fd_remove(guint watch_id);
+ledWakeup_t * led_wakeup_new(GSourceFunc function, gpointer data);
+void led_wakeup_set(ledWakeup_t *wakeup, gint64 ready_time_us);
+void led_wakeup_free(ledWakeup_t *wakeup);
+gint64 led_monotonic_us();
+int led_loop_run();
+void led_loop_quit();
+
+#endif /*LEDLOOP_H*/
@@ -0,0 +1,90 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/*IARM RPCs exported by ledmgr for other components.
+ *
+ * Custom patterns: register a keyframe pattern to get a handle, play it on an indicator by name, and
+ * release the handle when done. Registering a pattern identical to one already registered returns the
+ * same handle with its reference count raised, so every registration must be paired with a release.
+ *
+ *	IARM_Bus_LEDMgr_RegisterPattern_Param_t reg;
+ *	memset(&reg, 0, sizeof(reg));
+ *	reg.num_keyframes = 2;
+ *	reg.keyframes[0].duration = 250; reg.keyframes[0].brightness = LEDMGR_KEYFRAME_ON;
+ *	reg.keyframes[1].duration = 250; reg.keyframes[1].brightness = LEDMGR_KEYFRAME_OFF;
+ *	IARM_Bus_Call(IARM_BUS_LEDMGR_NAME, IARM_BUS_LEDMGR_API_RegisterPattern, &reg, sizeof(reg));
+ */
+#ifndef LEDMGR_IPC_H
+#define LEDMGR_IPC_H
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IARM_BUS_LEDMGR_NAME "ledmgr"
+#define IARM_BUS_LEDMGR_API_RegisterPattern "RegisterPattern"
+#define IARM_BUS_LEDMGR_API_ReleasePattern "ReleasePattern"
+#define IARM_BUS_LEDMGR_API_PlayPattern "PlayPattern"
+
+#define LEDMGR_MAX_PATTERN_KEYFRAMES 32
+#define LEDMGR_MAX_PATTERN_COLORS 16
+#define LEDMGR_INDICATOR_NAME_LENGTH 32
+#define LEDMGR_INVALID_PATTERN_HANDLE 0
+
+#define LEDMGR_KEYFRAME_OFF 0		/**< Keyframe brightness: LED off */
+#define LEDMGR_KEYFRAME_ON 0xFF		/**< Keyframe brightness: LED on, brightness left alone */
+
+typedef struct
+{
+	uint16_t duration;	/**< milliseconds, at least 1 */
+	uint8_t brightness;	/**< LEDMGR_KEYFRAME_OFF, 1-100, or LEDMGR_KEYFRAME_ON */
+	uint8_t color_index;	/**< 0 to keep the color, or 1-based index into the palette */
+	uint8_t easing;		/**< 0 step, 1 linear, 2 ease-in, 3 ease-out towards the next keyframe */
+	uint8_t reserved[3];
+}IARM_Bus_LEDMgr_Keyframe_t;
+
+typedef struct
+{
+	uint32_t num_keyframes;
+	IARM_Bus_LEDMgr_Keyframe_t keyframes[LEDMGR_MAX_PATTERN_KEYFRAMES];
+	uint32_t num_colors;
+	uint32_t palette[LEDMGR_MAX_PATTERN_COLORS];	/**< 0xRRGGBB */
+	uint32_t handle;	/**< out: pattern handle, LEDMGR_INVALID_PATTERN_HANDLE on failure */
+	int32_t result;		/**< out: 0 on success */
+}IARM_Bus_LEDMgr_RegisterPattern_Param_t;
+
+typedef struct
+{
+	uint32_t handle;
+	int32_t result;		/**< out: 0 on success */
+}IARM_Bus_LEDMgr_ReleasePattern_Param_t;
+
+typedef struct
+{
+	char indicator[LEDMGR_INDICATOR_NAME_LENGTH];
+	uint32_t handle;
+	int32_t repetitions;	/**< -1 to loop until the indicator is given another state */
+	int32_t result;		/**< out: 0 on success */
+}IARM_Bus_LEDMgr_PlayPattern_Param_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*LEDMGR_IPC_H*/
@@ -0,0 +1,266 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/*Shared-memory command ring: low-latency LED control for clients that issue commands at a high rate.
+ *
+ * A client connects once and gets a private ring of fixed-size command slots together with an eventfd.
+ * It writes commands straight into the slots and signals the eventfd. ledmgr runs them in order from
+ * its main loop, reading them in place. The ring has one producer: use it from a single thread, or
+ * serialize access yourself. Closing the connection releases the ring. Only clients running as root or
+ * as ledmgr's user are accepted.
+ *
+ *	ledmgr_ring_client_t client;
+ *	if(0 == ledmgr_ring_connect(&client))
+ *	{
+ *		int power = ledmgr_ring_find_indicator(client.ring, "Power");
+ *		ledmgr_ring_command_t *command = ledmgr_ring_reserve(&client);
+ *		if((0 <= power) && (NULL != command))
+ *		{
+ *			command->opcode = LEDMGR_RING_FLARE;
+ *			command->indicator = power;
+ *			command->arg0 = 50;
+ *			command->arg1 = 300;
+ *			ledmgr_ring_commit(&client);
+ *		}
+ *		ledmgr_ring_disconnect(&client);
+ *	}
+ *
+ * Commands are fire-and-forget. Progress and failures are visible in the ring's counters: completed
+ * (commands consumed so far), rejected and overflows.
+ */
+#ifndef LEDMGR_RING_H
+#define LEDMGR_RING_H
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LEDMGR_RING_SOCKET_NAME "ledmgr_ring"	/**< Abstract unix socket, @ledmgr_ring */
+#define LEDMGR_RING_MAGIC 0x474E524C		/**< "LRNG" */
+#define LEDMGR_RING_VERSION 1
+#define LEDMGR_RING_SLOTS 64			/**< Power of two */
+#define LEDMGR_RING_MAX_INDICATORS 16
+#define LEDMGR_RING_NAME_LENGTH 32
+
+typedef enum
+{
+	LEDMGR_RING_SET_STATE = 1,		/**< arg0: LEDMGR_RING_STEADY_ON or LEDMGR_RING_STEADY_OFF */
+	LEDMGR_RING_START_PATTERN,		/**< arg0: built-in pattern (blinkPatternType_t), arg1: repetitions, -1 to loop */
+	LEDMGR_RING_START_CUSTOM_PATTERN,	/**< arg0: handle from the RegisterPattern RPC, arg1: repetitions, -1 to loop */
+	LEDMGR_RING_FLARE,			/**< arg0: brightness increase in percent, arg1: length in ms */
+	LEDMGR_RING_PUSH_LAYER,			/**< Save the current state so that a later pop brings it back */
+	LEDMGR_RING_POP_LAYER,			/**< Restore the state saved by the last push */
+}ledmgr_ring_opcode_t;
+
+#define LEDMGR_RING_STEADY_ON 0
+#define LEDMGR_RING_STEADY_OFF 1
+
+typedef struct
+{
+	uint16_t opcode;	/**< ledmgr_ring_opcode_t */
+	uint16_t indicator;	/**< Index into the ring's indicator table, see ledmgr_ring_find_indicator() */
+	int32_t arg0;
+	int32_t arg1;
+	uint32_t tag;		/**< Not interpreted by ledmgr */
+	uint64_t reserved[2];
+}ledmgr_ring_command_t;
+
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t num_slots;		/**< LEDMGR_RING_SLOTS */
+	uint32_t size;			/**< sizeof(ledmgr_ring_t) */
+	uint32_t num_indicators;
+	char indicators[LEDMGR_RING_MAX_INDICATORS][LEDMGR_RING_NAME_LENGTH];	/**< Names, indexed by ledmgr_ring_command_t::indicator */
+	uint8_t reserved[48];
+
+	/* Written by the client only. Own cache line. */
+	uint32_t head;			/**< Commands submitted */
+	uint32_t overflows;		/**< Commands dropped because the ring was full */
+	uint8_t reserved_producer[56];
+
+	/* Written by ledmgr only. Own cache line. */
+	uint32_t tail;			/**< Commands consumed; slot tail % LEDMGR_RING_SLOTS is free again once tail passes it */
+	uint32_t completed;		/**< Commands executed successfully */
+	uint32_t rejected;		/**< Commands refused: unknown opcode or indicator, bad argument, or failed */
+	uint8_t reserved_consumer[52];
+
+	ledmgr_ring_command_t slots[LEDMGR_RING_SLOTS];
+}ledmgr_ring_t;
+
+typedef struct
+{
+	ledmgr_ring_t *ring;
+	int socket;		/**< Connection to ledmgr; closing it releases the ring */
+	int eventfd;		/**< Signals ledmgr that commands are pending */
+}ledmgr_ring_client_t;
+
+/**
+ * @brief Connects to ledmgr and maps a private command ring.
+ *
+ * @return  Returns 0 on success, -1 if ledmgr is not accepting ring clients.
+ */
+static inline int ledmgr_ring_connect(ledmgr_ring_client_t *client)
+{
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	memcpy(address.sun_path + 1, LEDMGR_RING_SOCKET_NAME, sizeof(LEDMGR_RING_SOCKET_NAME) - 1);
+	socklen_t address_length = offsetof(struct sockaddr_un, sun_path) + sizeof(LEDMGR_RING_SOCKET_NAME);
+
+	client->ring = NULL;
+	client->eventfd = -1;
+	client->socket = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if(0 > client->socket)
+	{
+		return -1;
+	}
+	if(0 != connect(client->socket, (struct sockaddr *)&address, address_length))
+	{
+		close(client->socket);
+		return -1;
+	}
+
+	/*ledmgr answers with the ring's memory and its eventfd.*/
+	uint32_t version = 0;
+	struct iovec payload = {&version, sizeof(version)};
+	union
+	{
+		char buffer[CMSG_SPACE(2 * sizeof(int))];
+		struct cmsghdr align;
+	}control;
+	struct msghdr message;
+	memset(&message, 0, sizeof(message));
+	message.msg_iov = &payload;
+	message.msg_iovlen = 1;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+	int fds[2] = {-1, -1};
+	if(sizeof(version) == recvmsg(client->socket, &message, MSG_CMSG_CLOEXEC))
+	{
+		struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+		if((NULL != header) && (SOL_SOCKET == header->cmsg_level) && (SCM_RIGHTS == header->cmsg_type) &&
+			(CMSG_LEN(sizeof(fds)) == header->cmsg_len))
+		{
+			memcpy(fds, CMSG_DATA(header), sizeof(fds));
+		}
+	}
+	if((LEDMGR_RING_VERSION != version) || (0 > fds[0]) || (0 > fds[1]))
+	{
+		if(0 <= fds[0]) close(fds[0]);
+		if(0 <= fds[1]) close(fds[1]);
+		close(client->socket);
+		return -1;
+	}
+	void *mapping = mmap(NULL, sizeof(ledmgr_ring_t), PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+	close(fds[0]);
+	if((MAP_FAILED == mapping) || (LEDMGR_RING_MAGIC != ((ledmgr_ring_t *)mapping)->magic) ||
+		(sizeof(ledmgr_ring_t) != ((ledmgr_ring_t *)mapping)->size))
+	{
+		if(MAP_FAILED != mapping) munmap(mapping, sizeof(ledmgr_ring_t));
+		close(fds[1]);
+		close(client->socket);
+		return -1;
+	}
+	client->ring = (ledmgr_ring_t *)mapping;
+	client->eventfd = fds[1];
+	return 0;
+}
+
+static inline void ledmgr_ring_disconnect(ledmgr_ring_client_t *client)
+{
+	if(NULL != client->ring)
+	{
+		munmap(client->ring, sizeof(ledmgr_ring_t));
+		close(client->eventfd);
+		close(client->socket);
+		client->ring = NULL;
+	}
+}
+
+/**
+ * @brief Looks an indicator up by name.
+ *
+ * @return  Returns the index to put in ledmgr_ring_command_t::indicator, or -1 if there is no such indicator.
+ */
+static inline int ledmgr_ring_find_indicator(const ledmgr_ring_t *ring, const char *name)
+{
+	uint32_t i;
+	for(i = 0; (i < ring->num_indicators) && (i < LEDMGR_RING_MAX_INDICATORS); i++)
+	{
+		if(0 == strncmp(ring->indicators[i], name, LEDMGR_RING_NAME_LENGTH))
+		{
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @brief Returns the next free slot to fill in, or NULL if the ring is full. A full ring counts an
+ * overflow; the command is lost unless the caller retries once ledmgr has caught up.
+ */
+static inline ledmgr_ring_command_t * ledmgr_ring_reserve(ledmgr_ring_client_t *client)
+{
+	ledmgr_ring_t *ring = client->ring;
+	uint32_t head = ring->head;
+	if(LEDMGR_RING_SLOTS <= (uint32_t)(head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)))
+	{
+		__atomic_store_n(&ring->overflows, ring->overflows + 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+	return &ring->slots[head & (LEDMGR_RING_SLOTS - 1)];
+}
+
+/**
+ * @brief Hands the slot returned by the last ledmgr_ring_reserve() to ledmgr and wakes it up.
+ *
+ * @return  Returns the command's sequence number: it has been consumed once ring->tail has moved past it.
+ */
+static inline uint32_t ledmgr_ring_commit(ledmgr_ring_client_t *client)
+{
+	uint32_t head = client->ring->head;
+	uint64_t one = 1;
+	__atomic_store_n(&client->ring->head, head + 1, __ATOMIC_RELEASE);
+	/*Only fails if the counter is saturated, in which case ledmgr is due to drain anyway.*/
+	ssize_t written = write(client->eventfd, &one, sizeof(one));
+	(void)written;
+	return head;
+}
+
+/**
+ * @brief Tells whether ledmgr has consumed the command with the given sequence number.
+ */
+static inline int ledmgr_ring_is_consumed(const ledmgr_ring_t *ring, uint32_t sequence)
+{
+	return (int32_t)(__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) - sequence) > 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*LEDMGR_RING_H*/
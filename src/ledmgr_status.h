@@ -0,0 +1,193 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/*Read-only view of what the front panel shows, published by ledmgr in shared memory.
+ *
+ * Readers map the page once and then poll it with plain memory reads: no IPC and no syscalls into
+ * ledmgr. Every record is guarded by a sequence counter (seqlock). The reader helpers below retry
+ * until they get a consistent copy.
+ *
+ *	const ledmgr_status_page_t *page = ledmgr_status_open();
+ *	ledmgr_status_indicator_t led;
+ *	if((NULL != page) && (0 == ledmgr_status_read_indicator(page, 0, &led)))
+ *		printf("%s is %s\n", led.name, led.lit ? "lit" : "dark");
+ *	ledmgr_status_close(page);
+ *
+ * Link with -lrt on toolchains older than glibc 2.17.
+ */
+#ifndef LEDMGR_STATUS_H
+#define LEDMGR_STATUS_H
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LEDMGR_STATUS_SHM_NAME "/ledmgr_status"	/**< Appears as /dev/shm/ledmgr_status */
+#define LEDMGR_STATUS_MAGIC 0x5453444C		/**< "LDST" */
+#define LEDMGR_STATUS_VERSION 1
+#define LEDMGR_STATUS_MAX_INDICATORS 16
+#define LEDMGR_STATUS_NAME_LENGTH 32
+#define LEDMGR_STATUS_NO_PATTERN 0xFFFFFFFF
+#define LEDMGR_STATUS_NO_COLOR 0xFFFFFFFF
+
+/* Logical states, as ledmgr's indicatorState_t.*/
+#define LEDMGR_STATUS_STEADY_ON 0
+#define LEDMGR_STATUS_STEADY_OFF 1
+#define LEDMGR_STATUS_BLINKING 2
+
+typedef struct
+{
+	uint32_t sequence;		/**< Odd while ledmgr is updating the record */
+	uint8_t state;			/**< LEDMGR_STATUS_STEADY_ON/STEADY_OFF/BLINKING */
+	uint8_t lit;			/**< 1 if the LED is on right now */
+	uint8_t brightness;		/**< Last brightness written, 0-100 */
+	uint8_t reserved;
+	uint32_t pattern_id;		/**< Active pattern, LEDMGR_STATUS_NO_PATTERN when not blinking */
+	uint32_t color;			/**< Last 0xRRGGBB color written, LEDMGR_STATUS_NO_COLOR if unknown */
+	uint32_t reserved2;
+	uint64_t updated_us;		/**< CLOCK_MONOTONIC of the last update */
+	char name[LEDMGR_STATUS_NAME_LENGTH];
+}ledmgr_status_indicator_t;
+
+typedef struct
+{
+	uint32_t magic;			/**< Written last; zero while the page is being set up or after ledmgr exits */
+	uint16_t version;
+	uint16_t reserved;
+	uint32_t size;			/**< sizeof(ledmgr_status_page_t) */
+	uint32_t sequence;		/**< Guards the fields below */
+	uint32_t error_flags;		/**< Error bitmap, as passed to ledMgrBase::setError() */
+	int32_t power_state;
+	uint32_t num_indicators;
+	uint32_t pid;			/**< Publishing ledmgr process */
+	ledmgr_status_indicator_t indicators[LEDMGR_STATUS_MAX_INDICATORS];
+}ledmgr_status_page_t;
+
+/**
+ * @brief Maps the status page read-only.
+ *
+ * @return  Returns the page, or NULL if ledmgr is not publishing one.
+ */
+static inline const ledmgr_status_page_t * ledmgr_status_open(void)
+{
+	int fd = shm_open(LEDMGR_STATUS_SHM_NAME, O_RDONLY, 0);
+	if(0 > fd)
+	{
+		return NULL;
+	}
+	void *mapping = mmap(NULL, sizeof(ledmgr_status_page_t), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(MAP_FAILED == mapping)
+	{
+		return NULL;
+	}
+	const ledmgr_status_page_t *page = (const ledmgr_status_page_t *)mapping;
+	if((LEDMGR_STATUS_MAGIC != __atomic_load_n(&page->magic, __ATOMIC_ACQUIRE)) ||
+		(LEDMGR_STATUS_VERSION != page->version) || (sizeof(ledmgr_status_page_t) != page->size))
+	{
+		munmap(mapping, sizeof(ledmgr_status_page_t));
+		return NULL;
+	}
+	return page;
+}
+
+static inline void ledmgr_status_close(const ledmgr_status_page_t *page)
+{
+	if(NULL != page)
+	{
+		munmap((void *)page, sizeof(ledmgr_status_page_t));
+	}
+}
+
+/**
+ * @brief Returns 1 while ledmgr is publishing into the page. A page left behind by an ledmgr that
+ * exited cleanly reads 0; a crashed one is replaced when ledmgr restarts.
+ */
+static inline int ledmgr_status_is_live(const ledmgr_status_page_t *page)
+{
+	return (LEDMGR_STATUS_MAGIC == __atomic_load_n(&page->magic, __ATOMIC_ACQUIRE));
+}
+
+/**
+ * @brief Takes a consistent copy of one indicator record.
+ *
+ * @return  Returns 0 on success, -1 if index is not a published indicator.
+ */
+static inline int ledmgr_status_read_indicator(const ledmgr_status_page_t *page, unsigned int index, ledmgr_status_indicator_t *out)
+{
+	if((index >= LEDMGR_STATUS_MAX_INDICATORS) || (index >= __atomic_load_n(&page->num_indicators, __ATOMIC_ACQUIRE)))
+	{
+		return -1;
+	}
+	const ledmgr_status_indicator_t *record = &page->indicators[index];
+	uint32_t before, after;
+	do
+	{
+		before = __atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE);
+		memcpy(out, record, sizeof(*out));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		after = __atomic_load_n(&record->sequence, __ATOMIC_RELAXED);
+	}while((before & 0x01) || (before != after));
+	return 0;
+}
+
+/**
+ * @brief Looks an indicator up by name and takes a consistent copy of its record.
+ *
+ * @return  Returns 0 on success, -1 if there is no such indicator.
+ */
+static inline int ledmgr_status_find_indicator(const ledmgr_status_page_t *page, const char *name, ledmgr_status_indicator_t *out)
+{
+	unsigned int i;
+	for(i = 0; 0 == ledmgr_status_read_indicator(page, i, out); i++)
+	{
+		if(0 == strncmp(out->name, name, LEDMGR_STATUS_NAME_LENGTH))
+		{
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @brief Takes a consistent copy of the error bitmap and power state.
+ */
+static inline void ledmgr_status_read_globals(const ledmgr_status_page_t *page, uint32_t *error_flags, int32_t *power_state)
+{
+	uint32_t before, after;
+	do
+	{
+		before = __atomic_load_n(&page->sequence, __ATOMIC_ACQUIRE);
+		*error_flags = page->error_flags;
+		*power_state = page->power_state;
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		after = __atomic_load_n(&page->sequence, __ATOMIC_RELAXED);
+	}while((before & 0x01) || (before != after));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*LEDMGR_STATUS_H*/
@@ -19,6 +19,7 @@
 #ifndef LEDMGR_TYPES_H
 #define LEDMGR_TYPES_H
 #include <stdio.h>
+#include <stdint.h>
 
 #define LOG(level, text, ...) do {\
 	printf("%s[%d] - %s: " text, __FUNCTION__, __LINE__, level, ##__VA_ARGS__);}while(0);
@@ -42,6 +43,8 @@
  * @addtogroup LED_TYPES
  * @{
  */
+#define MAX_INDICATORS 16	/**< Capacity of the indicator arena */
+
 typedef enum
 {
 	STATE_STEADY_ON = 0,
@@ -63,6 +66,62 @@ typedef struct
 	blinkOp_t * sequence;	/**< Array of {duration, intensity} values in a defined sequence */
 }blinkPattern_t;
 
+#define KEYFRAME_OFF 0		/**< Keyframe brightness: indicator off */
+#define KEYFRAME_ON 0xFF	/**< Keyframe brightness: indicator on, brightness left untouched */
+#define KEYFRAME_COLOR_KEEP 0	/**< Keyframe color index: color left untouched */
+#define KEYFRAME_RAMP_MS 40	/**< Interval between brightness updates of an eased keyframe */
+#define MAX_KEYFRAME_COLORS 63	/**< Palette entries addressable by a keyframe */
+
+typedef enum
+{
+	EASING_STEP = 0,	/**< Hold the keyframe brightness for its whole duration */
+	EASING_LINEAR,		/**< Ramp linearly towards the next keyframe's brightness */
+	EASING_IN,		/**< Ramp slowly at first, then faster */
+	EASING_OUT,		/**< Ramp quickly at first, then slower */
+}keyframeEasing_t;
+
+typedef struct
+{
+	uint16_t duration;	/**< milliseconds */
+	uint8_t brightness;	/**< KEYFRAME_OFF, 1-100, or KEYFRAME_ON */
+	uint8_t color_index : 6;	/**< KEYFRAME_COLOR_KEEP, or 1-based index into the pattern palette */
+	uint8_t easing : 2;	/**< keyframeEasing_t, ramp towards the next keyframe's brightness */
+}keyframe_t;
+
+typedef struct
+{
+	unsigned int id;
+	uint32_t num_keyframes;
+	const keyframe_t *keyframes;
+	uint32_t num_colors;
+	const uint32_t *palette;	/**< 0xRRGGBB colors referenced by keyframe color_index */
+}keyframePattern_t;
+
+typedef struct
+{
+	bool lit;			/**< Indicator on while in deep sleep */
+	unsigned int brightness;	/**< 1-100 while lit, 0 to leave the brightness untouched */
+}deepSleepState_t;
+
+#define MAX_ENERGY_BUCKETS 16			/**< Power state and pattern combinations tracked per indicator */
+#define ENERGY_ANY_POWER_STATE -1		/**< Power state of the bucket that collects the overflow */
+#define ENERGY_OTHER_PATTERNS 0xFFFFFFFE	/**< Pattern of the bucket that collects the overflow */
+
+typedef struct
+{
+	int power_state;		/**< IARM_BUS_PWRMGR_POWERSTATE_* */
+	unsigned int pattern_id;	/**< Pattern shown, LEDMGR_STATUS_NO_PATTERN while not blinking */
+	uint64_t lit_us;		/**< Time spent lit */
+	uint64_t level_us;		/**< Lit time weighted by brightness, in percent x us */
+	double estimate_mwh;		/**< Filled in from the indicator's ledCurrent_t, 0 if that is not configured */
+}energyBucket_t;
+
+typedef struct
+{
+	unsigned int current_ua;	/**< Drive current at full brightness, brightness scales it linearly */
+	unsigned int supply_mv;
+}ledCurrent_t;
+
 /* @} */ // End of group LED_TYPES
 
 
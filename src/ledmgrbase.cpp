@@ -16,13 +16,91 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
 */
+#include <new>
 #include <stdexcept>
+#include <string.h>
 #include "ledmgrbase.hpp"
+#include "ledtiming.hpp"
 #include "libIBus.h"
+#include "libIBusDaemon.h"
+#include "pwrMgr.h"
 
-static blinkOp_t g_blink_pattern_slow_blink[] = {{500, true}, {1000, false}};
-static blinkOp_t g_blink_pattern_double_blink[] = {{200, true}, {100, false}, {200, true}, {1000, false}};
-static blinkOp_t g_blink_pattern_fast_blink[] = {{200, true}, {100, false}};
+/*Built-in blink patterns. They are compile-time constants in read-only data: the keyframe count and
+ * everything derived from the keyframes is worked out by the compiler, and a malformed pattern fails the
+ * build rather than showing up as "Zero-wait timer!" on the box.*/
+static constexpr keyframe_t g_blink_pattern_slow_blink[] = {{500, KEYFRAME_ON, KEYFRAME_COLOR_KEEP, EASING_STEP},
+	{1000, KEYFRAME_OFF, KEYFRAME_COLOR_KEEP, EASING_STEP}};
+static constexpr keyframe_t g_blink_pattern_double_blink[] = {{200, KEYFRAME_ON, KEYFRAME_COLOR_KEEP, EASING_STEP},
+	{100, KEYFRAME_OFF, KEYFRAME_COLOR_KEEP, EASING_STEP}, {200, KEYFRAME_ON, KEYFRAME_COLOR_KEEP, EASING_STEP},
+	{1000, KEYFRAME_OFF, KEYFRAME_COLOR_KEEP, EASING_STEP}};
+static constexpr keyframe_t g_blink_pattern_fast_blink[] = {{200, KEYFRAME_ON, KEYFRAME_COLOR_KEEP, EASING_STEP},
+	{100, KEYFRAME_OFF, KEYFRAME_COLOR_KEEP, EASING_STEP}};
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+typedef struct
+{
+	keyframePattern_t pattern;
+	uint32_t period_ms;		/**< One repetition */
+	uint32_t on_ms;			/**< Lit part of a repetition */
+	uint8_t duty_percent;		/**< on_ms against period_ms */
+	bool ends_lit;			/**< The last keyframe leaves the indicator lit */
+}blinkPatternDefinition_t;
+
+/* @} */ // End of group LED_TYPES
+
+static constexpr uint32_t keyframes_period_ms(const keyframe_t *keyframes, uint32_t num_keyframes)
+{
+	return (0 == num_keyframes) ? 0 : (keyframes[0].duration + keyframes_period_ms(keyframes + 1, num_keyframes - 1));
+}
+
+static constexpr uint32_t keyframes_on_ms(const keyframe_t *keyframes, uint32_t num_keyframes)
+{
+	return (0 == num_keyframes) ? 0 : (((KEYFRAME_OFF != keyframes[0].brightness) ? keyframes[0].duration : 0) +
+		keyframes_on_ms(keyframes + 1, num_keyframes - 1));
+}
+
+static constexpr bool keyframes_all_timed(const keyframe_t *keyframes, uint32_t num_keyframes)
+{
+	return (0 == num_keyframes) || ((0 != keyframes[0].duration) && keyframes_all_timed(keyframes + 1, num_keyframes - 1));
+}
+
+#define NUM_ELEMENTS(array) (sizeof(array) / sizeof(array[0]))
+#define BLINK_PATTERN(type, keyframes) {{type, NUM_ELEMENTS(keyframes), keyframes, 0, NULL}, \
+	keyframes_period_ms(keyframes, NUM_ELEMENTS(keyframes)), keyframes_on_ms(keyframes, NUM_ELEMENTS(keyframes)), \
+	(uint8_t)((0 != keyframes_period_ms(keyframes, NUM_ELEMENTS(keyframes))) ? \
+		((keyframes_on_ms(keyframes, NUM_ELEMENTS(keyframes)) * 100) / keyframes_period_ms(keyframes, NUM_ELEMENTS(keyframes))) : 0), \
+	(KEYFRAME_OFF != keyframes[NUM_ELEMENTS(keyframes) - 1].brightness)}
+
+/*Indexed by blinkPatternType_t.*/
+static constexpr blinkPatternDefinition_t g_blink_patterns[] = {
+	BLINK_PATTERN(STATE_SLOW_BLINK, g_blink_pattern_slow_blink),
+	BLINK_PATTERN(STATE_DOUBLE_BLINK, g_blink_pattern_double_blink),
+	BLINK_PATTERN(STATE_FAST_BLINK, g_blink_pattern_fast_blink),
+};
+
+static constexpr bool blink_patterns_in_order(unsigned int index)
+{
+	return (NUM_PATTERNS == index) || ((index == g_blink_patterns[index].pattern.id) && blink_patterns_in_order(index + 1));
+}
+
+static constexpr bool blink_patterns_timed(unsigned int index)
+{
+	return (NUM_PATTERNS == index) || (keyframes_all_timed(g_blink_patterns[index].pattern.keyframes,
+		g_blink_patterns[index].pattern.num_keyframes) && blink_patterns_timed(index + 1));
+}
+
+static constexpr bool blink_patterns_long_enough(unsigned int index)
+{
+	return (NUM_PATTERNS == index) || ((2 <= g_blink_patterns[index].pattern.num_keyframes) && blink_patterns_long_enough(index + 1));
+}
+
+static_assert(NUM_PATTERNS == NUM_ELEMENTS(g_blink_patterns), "One built-in blink pattern per blinkPatternType_t");
+static_assert(blink_patterns_in_order(0), "Built-in blink patterns must be listed in blinkPatternType_t order");
+static_assert(blink_patterns_timed(0), "Built-in blink pattern with a zero-length step");
+static_assert(blink_patterns_long_enough(0), "Built-in blink pattern with fewer than 2 steps");
 
 /**
  * @addtogroup LED_APIS
@@ -34,11 +112,55 @@ static blinkOp_t g_blink_pattern_fast_blink[] = {{200, true}, {100, false}};
  */
 void ledMgrBase::diagnostics()
 {
-	std::cout<<"Size of the pattern list is "<<m_patterns.size()<<"\n";
-	for(int i = 0; i < m_patterns.size(); i++)
+	INFO("Size of the pattern list is %u\n", (unsigned int)NUM_PATTERNS);
+	for(unsigned int i = 0; i < NUM_PATTERNS; i++)
+	{
+		DEBUG("%x -- %x -- %p, period %u ms, %u%% on, ends %s\n", g_blink_patterns[i].pattern.id,
+			g_blink_patterns[i].pattern.num_keyframes, g_blink_patterns[i].pattern.keyframes, g_blink_patterns[i].period_ms,
+			g_blink_patterns[i].duty_percent, (g_blink_patterns[i].ends_lit ? "lit" : "dark"));
+	}
+	energyBucket_t buckets[MAX_ENERGY_BUCKETS];
+	unsigned int num_buckets;
+	for(unsigned int i = 0; i < m_num_indicators; i++)
 	{
-		DEBUG("%x -- %x -- 0x%x\n", m_patterns[i].id, m_patterns[i].num_sequences, (unsigned int)m_patterns[i].sequence);
+		const char *name = getIndicatorAt(i)->getName().c_str();
+		const ledCapabilities_t &capabilities = getIndicatorAt(i)->getCapabilities();
+		INFO("Indicator %s: capabilities 0x%x, brightness %u-%u\n", name, capabilities.mask, capabilities.min_brightness,
+			capabilities.max_brightness);
+		getEnergy(name, buckets, MAX_ENERGY_BUCKETS, num_buckets);
+		for(unsigned int j = 0; j < num_buckets; j++)
+		{
+			INFO("Energy %s: power state %d, pattern 0x%x: lit %llu ms, average brightness %llu%%, %.4f mWh\n", name,
+				buckets[j].power_state, buckets[j].pattern_id, (unsigned long long)(buckets[j].lit_us / 1000),
+				(unsigned long long)((0 != buckets[j].lit_us) ? (buckets[j].level_us / buckets[j].lit_us) : 0), buckets[j].estimate_mwh);
+		}
 	}
+	m_debouncer.diagnostics();
+	m_rules.diagnostics();
+	getDefaultLedBackend().diagnostics();
+
+	ledTimingStats_t timing;
+	get_led_timing_stats(timing);
+	INFO("LED timing (%s): %llu edges, lateness p50 %u us, p99 %u us, max %u us\n", (timing.realtime ? "real-time thread" : "main loop"),
+		timing.dispatched, timing.p50_us, timing.p99_us, timing.max_us);
+}
+
+/**
+ * @brief This API search for the matching indicator and return the indicator.
+ *
+ * @return  Returns matching indicator.
+ *
+ * Note: throws std::invalid_argument exception
+ */
+indicator& ledMgrBase::getIndicator(const char *name)
+{
+	indicator *led = findIndicator(name);
+	if(NULL == led)
+	{
+		ERROR("No matching indicator found!\n")
+		throw std::invalid_argument("No matching indicator found!");
+	}
+	return *led;
 }
 
 /**
@@ -50,34 +172,232 @@ void ledMgrBase::diagnostics()
  */
 indicator& ledMgrBase::getIndicator(const std::string &name)
 {
-	std::vector <indicator>::iterator iter;
-	for(iter = m_indicators.begin(); iter != m_indicators.end(); iter++)
+	return getIndicator(name.c_str());
+}
+
+/**
+ * @brief This API search for the matching indicator without throwing. Takes a C string so that lookups
+ * from event handlers build no temporary.
+ *
+ * @return  Returns matching indicator, or NULL if there is none.
+ */
+indicator* ledMgrBase::findIndicator(const char *name)
+{
+	for(unsigned int i = 0; i < m_num_indicators; i++)
+	{
+		if(0 == strcmp(name, getIndicatorAt(i)->getName().c_str()))
+		{
+			return getIndicatorAt(i);
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief This API constructs an indicator in place in the indicator arena. The indicator keeps its address
+ * until ledMgrBase is destroyed, so it is safe to hand it to timers and sync groups. Call it while
+ * setting up, before events are handled.
+ *
+ * @param[in] name	indicator name, as known to the backend.
+ * @param[in] backend	backend driving the indicator.
+ *
+ * @return  Returns the new indicator.
+ *
+ * Note: throws std::length_error exception if the arena is full
+ */
+indicator& ledMgrBase::addIndicator(const std::string &name, ledBackend &backend)
+{
+	if(MAX_INDICATORS <= m_num_indicators)
+	{
+		ERROR("Indicator arena is full!\n");
+		throw std::length_error("Indicator arena is full!");
+	}
+	indicator *led = new (m_indicator_storage[m_num_indicators]) indicator(name, backend);
+	m_deep_sleep_states[m_num_indicators].lit = false;
+	m_deep_sleep_states[m_num_indicators].brightness = 0;
+	m_led_currents[m_num_indicators].current_ua = 0;
+	m_led_currents[m_num_indicators].supply_mv = 0;
+	led->accountPowerState(m_is_powered_on);
+	m_num_indicators++;
+	return *led;
+}
+
+/**
+ * @brief This API adds every indicator the backend knows of, skipping any already added. For OEM
+ * constructors, in place of a fixed list of addIndicator() calls.
+ *
+ * @param[in] backend	backend to enumerate.
+ *
+ * @return  Returns the number of indicators added, or -1 if the backend cannot list its indicators.
+ */
+int ledMgrBase::detectIndicators(ledBackend &backend)
+{
+	std::vector<std::string> names;
+	if(0 != backend.listIndicators(names))
+	{
+		return -1;
+	}
+	int num_added = 0;
+	for(size_t i = 0; i < names.size(); i++)
+	{
+		if(NULL != findIndicator(names[i].c_str()))
+		{
+			continue;
+		}
+		if(MAX_INDICATORS <= m_num_indicators)
+		{
+			ERROR("Indicator arena is full, leaving out %s!\n", names[i].c_str());
+			continue;
+		}
+		indicator &led = addIndicator(names[i], backend);
+		INFO("Detected indicator %s, capabilities 0x%x\n", names[i].c_str(), led.getCapabilities().mask);
+		num_added++;
+	}
+	return num_added;
+}
+
+/**
+ * @brief This API walks the indicators in the order they were added.
+ *
+ * @return  Returns the indicator at index, or NULL past the last one.
+ */
+indicator* ledMgrBase::findIndicatorAt(unsigned int index)
+{
+	return (index < m_num_indicators) ? getIndicatorAt(index) : NULL;
+}
+
+indicator* ledMgrBase::getIndicatorAt(unsigned int index)
+{
+	return reinterpret_cast <indicator *> (m_indicator_storage[index]);
+}
+
+/**
+ * @brief This API creates a group of LEDs that are animated as one unit, e.g. the segments of a ring.
+ *
+ * @param[in] name		group name.
+ * @param[in] member_prefix	members are the indicators <member_prefix>0 .. <member_prefix>(num_members - 1).
+ * @param[in] num_members	number of LEDs in the group.
+ *
+ * @return  Returns the new group. It is owned by ledMgrBase.
+ *
+ * Note: throws std::invalid_argument exception if none of the members can be opened
+ */
+indicatorGroup& ledMgrBase::addIndicatorGroup(const std::string &name, const std::string &member_prefix, unsigned int num_members)
+{
+	indicatorGroup *group = new indicatorGroup(name, member_prefix, num_members);
+	deepSleepState_t deep_sleep_state = {false, 0};
+	m_groups.push_back(group);
+	m_group_deep_sleep_states.push_back(deep_sleep_state);
+	return *group;
+}
+
+/**
+ * @brief This API search for the matching indicator group and return it.
+ *
+ * @return  Returns matching indicator group.
+ *
+ * Note: throws std::invalid_argument exception
+ */
+indicatorGroup& ledMgrBase::getIndicatorGroup(const std::string &name)
+{
+	indicatorGroup *group = findIndicatorGroup(name);
+	if(NULL == group)
+	{
+		ERROR("No matching indicator group found!\n")
+		throw std::invalid_argument("No matching indicator group found!");
+	}
+	return *group;
+}
+
+/**
+ * @brief This API search for the matching indicator group without throwing.
+ *
+ * @return  Returns matching indicator group, or NULL if there is none.
+ */
+indicatorGroup* ledMgrBase::findIndicatorGroup(const std::string &name)
+{
+	for(std::vector <indicatorGroup *>::iterator iter = m_groups.begin(); iter != m_groups.end(); iter++)
+	{
+		if(0 == name.compare((*iter)->getName()))
+		{
+			return *iter;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief This API makes the indicator play the pattern phase-locked with the other members of the named
+ * sync group. The group is created on first use; all members share its timeline origin and timer.
+ *
+ * @param[in] name	sync group name.
+ * @param[in] member	indicator to synchronize.
+ * @param[in] pattern	pattern played by the group.
+ *
+ * @return  Returns status of the operation.
+ */
+int ledMgrBase::joinSyncGroup(const std::string &name, indicator &member, const keyframePattern_t *pattern)
+{
+	syncGroup *group = NULL;
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+	for(std::vector <syncGroup *>::iterator iter = m_sync_groups.begin(); iter != m_sync_groups.end(); iter++)
 	{
-		if(0 == name.compare(iter->getName()))
+		if(0 == name.compare((*iter)->getName()))
 		{
+			group = *iter;
 			break;
 		}
 	}
+	if(NULL == group)
+	{
+		group = new syncGroup(name, pattern);
+		m_sync_groups.push_back(group);
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
 
-	if(iter == m_indicators.end())
+	if(pattern != group->getPattern())
 	{
-		ERROR("No matching indicator found!\n")
-		throw std::invalid_argument("No matching indicator found!");
+		ERROR("Sync group %s plays a different pattern!\n", name.c_str());
+		return -1;
 	}
-	return *iter;
+	member.leaveSyncGroup();
+	return group->join(member);
+}
+
+/**
+ * @brief This API detaches the indicator from its sync group. It keeps its current output.
+ */
+void ledMgrBase::leaveSyncGroup(indicator &member)
+{
+	member.leaveSyncGroup();
+}
+
+static bool pattern_in_use(const keyframePattern_t *pattern, void *context)
+{
+	return ((ledMgrBase *)context)->isPatternInUse(pattern);
 }
 
 /**
  * @brief Constructor function performs initialization.
  */
-ledMgrBase::ledMgrBase()
+ledMgrBase::ledMgrBase() : m_pattern_store(pattern_in_use, this)
 {
 	m_is_powered_on = false;
 	m_error_flags = 0;
+	m_num_indicators = 0;
+	m_event_interest = EVENT_CLASS_ALL; //Legacy behaviour until the OEM declares its interest
+	m_sysstate_interest = ~0ULL;
+	m_all_sysstates = true;
+	m_subscription_listener = NULL;
+	m_delivered_interest = 0;
+	m_checkpoint = NULL;
+	m_status_page = NULL;
+	m_engine_suspended = false;
 	pthread_mutexattr_t mutex_attribute;
 	REPORT_IF_UNEQUAL(0, pthread_mutexattr_init(&mutex_attribute));
 	REPORT_IF_UNEQUAL(0, pthread_mutexattr_settype(&mutex_attribute, PTHREAD_MUTEX_ERRORCHECK));
 	REPORT_IF_UNEQUAL(0, pthread_mutex_init(&m_mutex, &mutex_attribute));
+	REPORT_IF_UNEQUAL(0, pthread_mutex_init(&m_subscription_mutex, NULL));
 
 	REPORT_IF_UNEQUAL(0, IARM_Bus_Init(IARMBUS_OWNER_NAME));
 	REPORT_IF_UNEQUAL(0, IARM_Bus_Connect());
@@ -88,21 +408,58 @@ ledMgrBase::ledMgrBase()
  */
 ledMgrBase::~ledMgrBase()
 {
+	for(std::vector <syncGroup *>::iterator iter = m_sync_groups.begin(); iter != m_sync_groups.end(); iter++)
+	{
+		delete *iter;
+	}
+	for(std::vector <indicatorGroup *>::iterator iter = m_groups.begin(); iter != m_groups.end(); iter++)
+	{
+		delete *iter;
+	}
+	while(0 < m_num_indicators)
+	{
+		m_num_indicators--;
+		getIndicatorAt(m_num_indicators)->~indicator();
+	}
+	pthread_mutex_destroy(&m_subscription_mutex);
 	pthread_mutex_destroy(&m_mutex);
 	REPORT_IF_UNEQUAL(0, IARM_Bus_Disconnect());
 	REPORT_IF_UNEQUAL(0, IARM_Bus_Term());
 }
 
 /**
- * @brief This function sets the power state.
+ * @brief This function sets the power state. Entering deep sleep suspends the animation engine, leaving
+ * it resumes the engine.
  *
  * @param[in] state   power state.
  */
 void ledMgrBase::setPowerState(int state)
 {
-	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
 	m_is_powered_on = state;
+	for(unsigned int i = 0; i < m_num_indicators; i++)
+	{
+		getIndicatorAt(i)->accountPowerState(state);
+	}
+	if((IARM_BUS_PWRMGR_POWERSTATE_STANDBY_DEEP_SLEEP == state) != m_engine_suspended)
+	{
+		if(m_engine_suspended)
+		{
+			resumeEngineLocked();
+		}
+		else
+		{
+			suspendEngineLocked();
+		}
+	}
+	checkpointGlobals();
+	publishGlobals();
+	/*Rule inputs must change in the same order as the state itself.*/
+	m_rules.lock();
 	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	m_rules.setInputLocked(RULE_INPUT_POWER, 0, state);
+	applyRulesLocked();
+	m_rules.unlock();
 }
 
 /**
@@ -113,12 +470,47 @@ void ledMgrBase::setPowerState(int state)
 int ledMgrBase::getPowerState()
 {
 	int state;
-	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
 	state = m_is_powered_on;
 	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
 	return state;
 }
 
+/*Suspends the animation engine for deep sleep: every LED timer is frozen in one pass, so nothing wakes
+ * up until resume, then each indicator and indicator group shows its deep-sleep state. Called with
+ * m_mutex held.*/
+void ledMgrBase::suspendEngineLocked()
+{
+	suspend_led_timers();
+	for(unsigned int i = 0; i < m_num_indicators; i++)
+	{
+		getIndicatorAt(i)->suspendOutput(m_deep_sleep_states[i]);
+	}
+	for(unsigned int i = 0; i < m_groups.size(); i++)
+	{
+		m_groups[i]->suspendOutput(m_group_deep_sleep_states[i]);
+	}
+	m_engine_suspended = true;
+	INFO("Animation engine suspended for deep sleep\n");
+}
+
+/*Indicators and groups show again what they tracked while suspended, then the frozen timers carry on with
+ * the time they had left, so patterns continue at the phase they stopped at. Called with m_mutex held.*/
+void ledMgrBase::resumeEngineLocked()
+{
+	for(unsigned int i = 0; i < m_num_indicators; i++)
+	{
+		getIndicatorAt(i)->resumeOutput();
+	}
+	for(unsigned int i = 0; i < m_groups.size(); i++)
+	{
+		m_groups[i]->resumeOutput();
+	}
+	resume_led_timers();
+	m_engine_suspended = false;
+	INFO("Animation engine resumed\n");
+}
+
 /**
  * @brief This API stores the error and returns the transition state in order to call appropriate ledmgr indicator api.
  *
@@ -133,7 +525,7 @@ bool ledMgrBase::setError(unsigned int position, bool value)
 	{
 		bool transition_detected = false;
 
-		REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+		REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
 		if(true == value)
 		{
 			if(0 == m_error_flags)
@@ -146,14 +538,21 @@ bool ledMgrBase::setError(unsigned int position, bool value)
 		else
 		{	
 			unsigned int prev_flags = m_error_flags;
-			m_error_flags &= (0xFFFFFFFE << position);
+			m_error_flags &= ~(0x01u << position);
 			if((0 != prev_flags) && (0 == m_error_flags))
 			{
 				/*We're going from error-state to no errors.*/
 				transition_detected = true;
 			}
 		}
+		checkpointGlobals();
+		publishGlobals();
+		m_rules.lock();
+		unsigned int error_flags = m_error_flags;
 		REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+		m_rules.setErrorFlagsLocked(error_flags);
+		applyRulesLocked();
+		m_rules.unlock();
 		return transition_detected;
 	}
 	else
@@ -164,14 +563,429 @@ bool ledMgrBase::setError(unsigned int position, bool value)
 }
 
 /**
- * @brief This API creates blink patterns using the pattern type, duration, sequence … etc. as parameters.
+ * @brief This API lets the OEM implementation declare, at registration time, the event classes and
+ * sys-state IDs it consumes. Only those are subscribed to on the bus.
+ *
+ * @param[in] event_classes	bitmask of eventClass_t values.
+ * @param[in] state_ids		array of IARM_Bus_SYSMgr_SystemState_t values of interest.
+ * @param[in] num_state_ids	number of entries in state_ids.
+ */
+void ledMgrBase::setEventInterest(unsigned int event_classes, const unsigned int *state_ids, unsigned int num_state_ids)
+{
+	unsigned long long sysstate_interest = 0;
+	for(unsigned int i = 0; i < num_state_ids; i++)
+	{
+		if(MAX_SYSSTATE_IDS > state_ids[i])
+		{
+			sysstate_interest |= (0x01ULL << state_ids[i]);
+		}
+		else
+		{
+			ERROR("Sys-state ID %u out of range!\n", state_ids[i]);
+		}
+	}
+
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+	m_event_interest = event_classes & EVENT_CLASS_ALL;
+	m_sysstate_interest = sysstate_interest;
+	m_all_sysstates = false;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	notifySubscriptionChange();
+}
+
+/**
+ * @brief This API holds back transitions of a sys-state until they are stable, so that a flapping source
+ * (e.g. the gateway connection) doesn't restart the LED pattern on every change. For OEM constructors.
+ *
+ * @param[in] state_id        sys-state ID.
+ * @param[in] rise_ms         how long a change to a non-zero state must hold before it is handled.
+ * @param[in] fall_ms         how long a change to state zero must hold before it is handled.
+ * @param[in] min_display_ms  how long a handled state is kept before the next change is handled.
+ *
+ * @return  Returns status of the operation.
+ */
+int ledMgrBase::setDebounce(unsigned int state_id, unsigned int rise_ms, unsigned int fall_ms, unsigned int min_display_ms)
+{
+	debounceConfig_t config;
+	config.rise_ms = rise_ms;
+	config.fall_ms = fall_ms;
+	config.min_display_ms = min_display_ms;
+	return m_debouncer.configure(state_id, config);
+}
+
+/**
+ * @brief This API sets what an indicator, or every member of an indicator group, shows in deep sleep,
+ * while the animation engine is suspended. Indicators and groups not configured here are turned off.
+ * For OEM constructors.
+ *
+ * @param[in] name		indicator or group name.
+ * @param[in] lit		whether the indicator is on in deep sleep.
+ * @param[in] brightness	brightness while lit, 0 to leave it untouched.
+ *
+ * @return  Returns status of the operation.
+ */
+int ledMgrBase::setDeepSleepState(const std::string &name, bool lit, unsigned int brightness)
+{
+	for(unsigned int i = 0; i < m_num_indicators; i++)
+	{
+		if(0 == name.compare(getIndicatorAt(i)->getName()))
+		{
+			m_deep_sleep_states[i].lit = lit;
+			m_deep_sleep_states[i].brightness = brightness;
+			return 0;
+		}
+	}
+	for(unsigned int i = 0; i < m_groups.size(); i++)
+	{
+		if(0 == name.compare(m_groups[i]->getName()))
+		{
+			m_group_deep_sleep_states[i].lit = lit;
+			m_group_deep_sleep_states[i].brightness = brightness;
+			return 0;
+		}
+	}
+	ERROR("No indicator %s!\n", name.c_str());
+	return -1;
+}
+
+/**
+ * @brief This API sets the figures the energy estimate of an indicator is worked out from. Indicators not
+ * configured here report on-time only. For OEM constructors.
+ *
+ * @param[in] name		indicator name.
+ * @param[in] current_ua	drive current at full brightness, in uA; dimming is taken to scale it linearly.
+ * @param[in] supply_mv		supply voltage of the LED circuit, in mV.
+ *
+ * @return  Returns status of the operation.
+ */
+int ledMgrBase::setLedCurrent(const std::string &name, unsigned int current_ua, unsigned int supply_mv)
+{
+	for(unsigned int i = 0; i < m_num_indicators; i++)
+	{
+		if(0 == name.compare(getIndicatorAt(i)->getName()))
+		{
+			m_led_currents[i].current_ua = current_ua;
+			m_led_currents[i].supply_mv = supply_mv;
+			return 0;
+		}
+	}
+	ERROR("No indicator %s!\n", name.c_str());
+	return -1;
+}
+
+/**
+ * @brief This API reports how long an indicator has been lit, and how brightly, in each power state and
+ * pattern so far, with the energy that took.
+ *
+ * @param[in] name		indicator name.
+ * @param[out] buckets		receives one entry per power state and pattern seen.
+ * @param[in] max_buckets	room in buckets, MAX_ENERGY_BUCKETS holds them all.
+ * @param[out] num_buckets	entries filled in.
+ *
+ * @return  Returns status of the operation.
+ */
+int ledMgrBase::getEnergy(const char *name, energyBucket_t *buckets, unsigned int max_buckets, unsigned int &num_buckets)
+{
+	for(unsigned int i = 0; i < m_num_indicators; i++)
+	{
+		if(0 != getIndicatorAt(i)->getName().compare(name))
+		{
+			continue;
+		}
+		/*mW per unit of level_us, which is percent x us: uA x mV / 1e6, then / 100 and / 3.6e9 us per hour.*/
+		double mwh_per_level_us = ((double)m_led_currents[i].current_ua * m_led_currents[i].supply_mv) / 1e6 / 100 / 3.6e9;
+		num_buckets = getIndicatorAt(i)->getEnergy(buckets, max_buckets);
+		for(unsigned int j = 0; j < num_buckets; j++)
+		{
+			buckets[j].estimate_mwh = buckets[j].level_us * mwh_per_level_us;
+		}
+		return 0;
+	}
+	num_buckets = 0;
+	return -1;
+}
+
+/**
+ * @brief This API loads the state-to-LED rules (see conf/ledmgr.rules). From then on, power state, system
+ * mode, error and sys-state changes drive the indicators through the rules first; the OEM hooks still run
+ * afterwards. The events the rules look at are subscribed to, whatever the OEM asked for, and the rules are
+ * applied once straight away. Call after the OEM's addIndicator() calls, createBlinkPatterns() and
+ * startCheckpointing(), so that the rules start from the resumed power state and errors.
+ *
+ * @return  Returns 0 on success, 1 if there is no rules file, -1 on error.
+ */
+int ledMgrBase::loadRules(const char *path)
+{
+	std::vector <std::string> names;
+	for(unsigned int i = 0; i < m_num_indicators; i++)
+	{
+		names.push_back(getIndicatorAt(i)->getName());
+	}
+	int status = m_rules.load(path, names);
+	if(1 == status)
+	{
+		INFO("No rules in %s, OEM hooks only.\n", path);
+	}
+	else if(0 == status)
+	{
+		ruleInput_t input;
+		unsigned int id;
+		for(unsigned int i = 0; 0 == m_rules.getInput(i, input, id); i++)
+		{
+			switch(input)
+			{
+				case RULE_INPUT_POWER:
+					subscribeEvents(EVENT_CLASS_POWER_MODE);
+					break;
+				case RULE_INPUT_SYS_MODE:
+					subscribeEvents(EVENT_CLASS_SYS_MODE);
+					break;
+				case RULE_INPUT_SYSSTATE:
+					subscribeEvents(EVENT_CLASS_SYSTEM_STATE);
+					subscribeSysState(id);
+					break;
+				default:
+					/*Error bits come from setError().*/
+					break;
+			}
+		}
+		REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+		m_rules.lock();
+		m_rules.setInputLocked(RULE_INPUT_POWER, 0, m_is_powered_on);
+		m_rules.setErrorFlagsLocked(m_error_flags);
+		REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+		m_rules.setInputLocked(RULE_INPUT_SYS_MODE, 0, IARM_BUS_SYS_MODE_NORMAL);
+		applyRulesLocked();
+		m_rules.unlock();
+	}
+	return status;
+}
+
+/**
+ * @brief This API feeds a system mode change to the rules.
+ */
+void ledMgrBase::setSysMode(unsigned int mode)
+{
+	m_rules.lock();
+	m_rules.setInputLocked(RULE_INPUT_SYS_MODE, 0, mode);
+	applyRulesLocked();
+	m_rules.unlock();
+}
+
+/**
+ * @brief This API feeds a (debounced) sys-state value to the rules.
+ */
+void ledMgrBase::setSysStateValue(unsigned int state_id, int value)
+{
+	m_rules.lock();
+	m_rules.setInputLocked(RULE_INPUT_SYSSTATE, state_id, value);
+	applyRulesLocked();
+	m_rules.unlock();
+}
+
+/*Drives the indicators whose rule outcome changed. Called with the rules lock held.*/
+void ledMgrBase::applyRulesLocked()
+{
+	ruleAction_t changes[MAX_INDICATORS];
+	if(!m_rules.evaluateLocked(changes))
+	{
+		return;
+	}
+	for(unsigned int i = 0; i < m_num_indicators; i++)
+	{
+		indicator *led = getIndicatorAt(i);
+		switch(changes[i].type)
+		{
+			case RULE_ACTION_ON:
+				led->setState(STATE_STEADY_ON);
+				break;
+			case RULE_ACTION_OFF:
+				led->setState(STATE_STEADY_OFF);
+				break;
+			case RULE_ACTION_BLINK:
+				led->setBlink(getPattern((blinkPatternType_t)changes[i].pattern), changes[i].repetitions);
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+/**
+ * @brief This API returns the debounce stage sys-state events pass through on their way to the handlers.
+ */
+eventDebouncer& ledMgrBase::getDebouncer()
+{
+	return m_debouncer;
+}
+
+/**
+ * @brief This API adds event classes to the current subscription set.
+ *
+ * @param[in] event_classes   bitmask of eventClass_t values.
+ */
+void ledMgrBase::subscribeEvents(unsigned int event_classes)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+	m_event_interest |= (event_classes & EVENT_CLASS_ALL);
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	notifySubscriptionChange();
+}
+
+/**
+ * @brief This API removes event classes from the current subscription set.
+ *
+ * @param[in] event_classes   bitmask of eventClass_t values.
+ */
+void ledMgrBase::unsubscribeEvents(unsigned int event_classes)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+	m_event_interest &= ~event_classes;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	notifySubscriptionChange();
+}
+
+/**
+ * @brief This API adds a sys-state ID to the set forwarded to the OEM handlers.
+ *
+ * @param[in] state_id   IARM_Bus_SYSMgr_SystemState_t value.
+ *
+ * @return  Returns status of the operation.
+ */
+int ledMgrBase::subscribeSysState(unsigned int state_id)
+{
+	if(MAX_SYSSTATE_IDS <= state_id)
+	{
+		REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+		bool forwarded = m_all_sysstates;
+		REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+		if(forwarded)
+		{
+			return 0;	/*Already covered by the legacy interest*/
+		}
+		ERROR("Sys-state ID %u out of range!\n", state_id);
+		return -1;
+	}
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+	m_sysstate_interest |= (0x01ULL << state_id);
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	notifySubscriptionChange();
+	return 0;
+}
+
+/**
+ * @brief This API removes a sys-state ID from the set forwarded to the OEM handlers. Removing the last
+ * one drops the sysmgr subscription altogether.
+ *
+ * @param[in] state_id   IARM_Bus_SYSMgr_SystemState_t value.
+ *
+ * @return  Returns status of the operation.
+ */
+int ledMgrBase::unsubscribeSysState(unsigned int state_id)
+{
+	if(MAX_SYSSTATE_IDS <= state_id)
+	{
+		ERROR("Sys-state ID %u out of range!\n", state_id);
+		return -1;
+	}
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+	m_sysstate_interest &= ~(0x01ULL << state_id);
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	notifySubscriptionChange();
+	return 0;
+}
+
+/**
+ * @brief This API checks whether events for the given sys-state ID are to be forwarded.
+ *
+ * @param[in] state_id   IARM_Bus_SYSMgr_SystemState_t value.
+ *
+ * @return  Returns true if the OEM implementation consumes this sys-state ID.
+ */
+bool ledMgrBase::isSysStateSubscribed(unsigned int state_id)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+	bool subscribed = (0 != (m_event_interest & EVENT_CLASS_SYSTEM_STATE));
+	if(MAX_SYSSTATE_IDS > state_id)
+	{
+		subscribed = subscribed && (0 != (m_sysstate_interest & (0x01ULL << state_id)));
+	}
+	else
+	{
+		/*IDs past the bitmap can't be picked individually; they pass only while nothing was narrowed down.*/
+		subscribed = subscribed && m_all_sysstates;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return subscribed;
+}
+
+/**
+ * @brief This API returns the effective set of event classes to subscribe to.
+ *
+ * Power mode changes are always included since the base class tracks the power state itself.
+ *
+ * @return  Returns bitmask of eventClass_t values.
+ */
+unsigned int ledMgrBase::getEventInterest()
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+	unsigned int interest = getEventInterestLocked();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return interest;
+}
+
+unsigned int ledMgrBase::getEventInterestLocked() const
+{
+	unsigned int interest = m_event_interest | EVENT_CLASS_POWER_MODE;
+	if((0 == m_sysstate_interest) && !m_all_sysstates)
+	{
+		interest &= ~EVENT_CLASS_SYSTEM_STATE;
+	}
+	return interest;
+}
+
+/**
+ * @brief This API registers the function that applies subscription changes to the bus. The caller is
+ * expected to have applied the current interest itself; the listener is given only later changes.
+ *
+ * @param[in] listener   callback, or NULL to stop notifications.
+ */
+void ledMgrBase::setSubscriptionListener(subscriptionListener_t listener)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_subscription_mutex));
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+	m_subscription_listener = listener;
+	m_delivered_interest = getEventInterestLocked();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_subscription_mutex));
+}
+
+/*Hands the listener the interest as it is now, if that differs from what it was last given. Calls are
+ * serialised and each one reads the latest interest, so concurrent changes can't leave the listener with
+ * an older mask than the last one set.*/
+void ledMgrBase::notifySubscriptionChange()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_subscription_mutex));
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+	unsigned int interest = getEventInterestLocked();
+	subscriptionListener_t listener = m_subscription_listener;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+
+	if((interest != m_delivered_interest) && (NULL != listener))
+	{
+		INFO("Event interest changed 0x%x -> 0x%x\n", m_delivered_interest, interest);
+		listener(interest);
+		m_delivered_interest = interest;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_subscription_mutex));
+}
+
+/**
+ * @brief This API is where a platform would set up patterns of its own. The built-in ones are compile-time
+ * tables (g_blink_patterns), so there is nothing to build for them.
  */
 int ledMgrBase::createBlinkPatterns()
 {
-	m_patterns.resize(NUM_PATTERNS);
-	m_patterns[STATE_SLOW_BLINK] = {STATE_SLOW_BLINK, 2, g_blink_pattern_slow_blink};
-	m_patterns[STATE_DOUBLE_BLINK] = {STATE_DOUBLE_BLINK, 4, g_blink_pattern_double_blink};
-	m_patterns[STATE_FAST_BLINK] = {STATE_FAST_BLINK, 2, g_blink_pattern_fast_blink};
 	INFO("Complete\n");
 	return 0;
 }
@@ -181,11 +995,340 @@ int ledMgrBase::createBlinkPatterns()
  *
  * @param[in] type  Blink pattern type.
  *
- * @return  Returns corresponding blink pattern info structure.
+ * @return  Returns corresponding blink pattern info structure, or NULL for an unknown type.
+ */
+const keyframePattern_t * ledMgrBase::getPattern(blinkPatternType_t type) const
+{
+	if(NUM_PATTERNS <= (unsigned int)type)
+	{
+		return NULL;
+	}
+	return &g_blink_patterns[type].pattern;
+}
+
+/**
+ * @brief This API maps the crash-resume checkpoint and, if a previous instance left one behind, brings the
+ * error flags, power state and every indicator back to where they were. From then on all of them are
+ * mirrored into the checkpoint as they change. Call after createBlinkPatterns() and the OEM's
+ * addIndicator() calls, before events are handled.
+ *
+ * @return  Returns status of the operation.
  */
-const blinkPattern_t * ledMgrBase::getPattern(blinkPatternType_t type) const
+int ledMgrBase::startCheckpointing()
 {
-    return &m_patterns[type];
+	int status = open_checkpoint();
+	if(0 > status)
+	{
+		return -1;
+	}
+	checkpointSegment_t *checkpoint = get_checkpoint();
+
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+	if((1 == status) && is_checkpoint_consistent(&checkpoint->generation))
+	{
+		m_error_flags = checkpoint->error_flags;
+		m_is_powered_on = checkpoint->power_state;
+		INFO("Resumed error flags 0x%x, power state %d\n", m_error_flags, m_is_powered_on);
+	}
+	m_checkpoint = checkpoint;
+	checkpointGlobals();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+
+	for(unsigned int i = 0; i < m_num_indicators; i++)
+	{
+		indicator *led = getIndicatorAt(i);
+		checkpointSlot_t *slot = claim_checkpoint_slot(led->getName());
+		if(NULL == slot)
+		{
+			ERROR("No checkpoint slot for %s!\n", led->getName().c_str());
+			continue;
+		}
+		checkpointSlot_t previous = *slot;
+		led->attachCheckpoint(slot);
+		if((1 == status) && is_checkpoint_consistent(&previous.generation))
+		{
+			led->resumeState(previous, findCheckpointPattern(previous.active), findCheckpointPattern(previous.saved));
+		}
+	}
+
+	/*Restarted during deep sleep: stay suspended until wake-up.*/
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+	if((IARM_BUS_PWRMGR_POWERSTATE_STANDBY_DEEP_SLEEP == m_is_powered_on) && !m_engine_suspended)
+	{
+		suspendEngineLocked();
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return 0;
+}
+
+/**
+ * @brief This API stops checkpointing and removes the checkpoint, so that a clean restart does not resume.
+ */
+void ledMgrBase::stopCheckpointing()
+{
+	for(unsigned int i = 0; i < m_num_indicators; i++)
+	{
+		getIndicatorAt(i)->attachCheckpoint(NULL);
+	}
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+	m_checkpoint = NULL;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	close_checkpoint(true);
+}
+
+/**
+ * @brief This API records the error flags and power state. Called with m_mutex held.
+ */
+void ledMgrBase::checkpointGlobals()
+{
+	if(NULL == m_checkpoint)
+	{
+		return;
+	}
+	begin_checkpoint_update(&m_checkpoint->generation);
+	m_checkpoint->error_flags = m_error_flags;
+	m_checkpoint->power_state = m_is_powered_on;
+	end_checkpoint_update(&m_checkpoint->generation);
+}
+
+/**
+ * @brief This API registers a runtime keyframe pattern. Identical patterns share storage and a handle.
+ *
+ * @param[in] keyframes		keyframes of the pattern.
+ * @param[in] num_keyframes	number of keyframes.
+ * @param[in] palette		colors referenced by the keyframes.
+ * @param[in] num_colors	number of palette entries.
+ * @param[out] handle		handle to play and release the pattern with.
+ *
+ * @return  Returns status of the operation.
+ */
+int ledMgrBase::registerPattern(const keyframe_t *keyframes, unsigned int num_keyframes, const uint32_t *palette,
+	unsigned int num_colors, unsigned int &handle)
+{
+	for(unsigned int i = 0; i < num_keyframes; i++)
+	{
+		if((0 == keyframes[i].duration) || (keyframes[i].color_index > num_colors) ||
+			((KEYFRAME_ON != keyframes[i].brightness) && (100 < keyframes[i].brightness)))
+		{
+			ERROR("Bad keyframe %u!\n", i);
+			return -1;
+		}
+	}
+	return m_pattern_store.registerPattern(keyframes, num_keyframes, palette, num_colors, handle);
+}
+
+/**
+ * @brief This API drops a reference to a runtime pattern. The pattern is reclaimed once it has no
+ * references and no indicator is playing it.
+ *
+ * @return  Returns status of the operation.
+ */
+int ledMgrBase::releasePattern(unsigned int handle)
+{
+	return m_pattern_store.releasePattern(handle);
+}
+
+/**
+ * @brief This API plays a runtime pattern on the named indicator.
+ *
+ * @param[in] indicator_name	indicator to play it on.
+ * @param[in] handle		pattern handle from registerPattern().
+ * @param[in] repetitions	number of repetitions, -1 to loop.
+ *
+ * @return  Returns status of the operation.
+ */
+int ledMgrBase::playPattern(const char *indicator_name, unsigned int handle, int repetitions)
+{
+	indicator *led = findIndicator(indicator_name);
+	if(NULL == led)
+	{
+		ERROR("No indicator %s!\n", indicator_name);
+		return -1;
+	}
+	return playPatternOn(*led, handle, repetitions);
+}
+
+int ledMgrBase::playPatternOn(indicator &led, unsigned int handle, int repetitions)
+{
+	/*Holding the store lock keeps the pattern from being reclaimed before the indicator picks it up.*/
+	m_pattern_store.lock();
+	const keyframePattern_t *pattern = m_pattern_store.lookupLocked(handle);
+	int ret = -1;
+	if(NULL != pattern)
+	{
+		ret = led.setBlink(pattern, repetitions);
+	}
+	else
+	{
+		ERROR("Unknown pattern handle 0x%x!\n", handle);
+	}
+	m_pattern_store.unlock();
+	return ret;
+}
+
+/**
+ * @brief This API tells whether any indicator may still read the pattern.
+ */
+bool ledMgrBase::isPatternInUse(const keyframePattern_t *pattern)
+{
+	for(unsigned int i = 0; i < m_num_indicators; i++)
+	{
+		if(getIndicatorAt(i)->usesPattern(pattern))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief This API publishes the read-only status page (see ledmgr_status.h) and keeps every indicator,
+ * the error flags and the power state current in it. Call after the OEM's addIndicator() calls.
+ *
+ * @return  Returns status of the operation.
+ */
+int ledMgrBase::startStatusPage()
+{
+	if(0 != open_status_page())
+	{
+		return -1;
+	}
+	for(unsigned int i = 0; i < m_num_indicators; i++)
+	{
+		indicator *led = getIndicatorAt(i);
+		ledmgr_status_indicator_t *entry = claim_status_entry(led->getName());
+		if(NULL == entry)
+		{
+			ERROR("No status page record for %s!\n", led->getName().c_str());
+			continue;
+		}
+		led->attachStatus(entry);
+	}
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+	m_status_page = get_status_page();
+	publishGlobals();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return 0;
+}
+
+/**
+ * @brief This API stops publishing and marks the status page as no longer live.
+ */
+void ledMgrBase::stopStatusPage()
+{
+	for(unsigned int i = 0; i < m_num_indicators; i++)
+	{
+		getIndicatorAt(i)->attachStatus(NULL);
+	}
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_LEDMGRBASE));
+	m_status_page = NULL;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	close_status_page();
+}
+
+static int run_ring_command(const ledmgr_ring_command_t &command, void *context)
+{
+	return ((ledMgrBase *)context)->executeRingCommand(command);
+}
+
+/**
+ * @brief This API lets clients drive the indicators through shared-memory command rings (see ledmgr_ring.h).
+ * Commands run on the main loop. Call after the OEM's addIndicator() calls: ring clients address
+ * indicators by their position in the arena.
+ *
+ * @return  Returns status of the operation.
+ */
+int ledMgrBase::startCommandRings()
+{
+	std::vector <std::string> names;
+	for(unsigned int i = 0; i < m_num_indicators; i++)
+	{
+		names.push_back(getIndicatorAt(i)->getName());
+	}
+	return open_command_rings(names, run_ring_command, this);
+}
+
+void ledMgrBase::stopCommandRings()
+{
+	close_command_rings();
+}
+
+/**
+ * @brief This API runs one ring command. The command lives in memory the client can still write to, so
+ * every field is read once.
+ *
+ * @return  Returns status of the operation.
+ */
+int ledMgrBase::executeRingCommand(const ledmgr_ring_command_t &command)
+{
+	unsigned int opcode = command.opcode;
+	unsigned int index = command.indicator;
+	int arg0 = command.arg0;
+	int arg1 = command.arg1;
+	if(index >= m_num_indicators)
+	{
+		return -1;
+	}
+	indicator *led = getIndicatorAt(index);
+	switch(opcode)
+	{
+		case LEDMGR_RING_SET_STATE:
+			return led->setState((indicatorState_t)arg0);
+		case LEDMGR_RING_START_PATTERN:
+			if((0 > arg0) || ((unsigned int)arg0 >= NUM_PATTERNS))
+			{
+				return -1;
+			}
+			return led->setBlink(getPattern((blinkPatternType_t)arg0), arg1);
+		case LEDMGR_RING_START_CUSTOM_PATTERN:
+			return playPatternOn(*led, (unsigned int)arg0, arg1);
+		case LEDMGR_RING_FLARE:
+			if((0 >= arg0) || (0 >= arg1))
+			{
+				return -1;
+			}
+			led->executeFlare(arg0, arg1);
+			return 0;
+		case LEDMGR_RING_PUSH_LAYER:
+			led->saveState();
+			return 0;
+		case LEDMGR_RING_POP_LAYER:
+			led->restoreState();
+			return 0;
+		default:
+			return -1;
+	}
+}
+
+/**
+ * @brief This API publishes the error flags and power state. Called with m_mutex held.
+ */
+void ledMgrBase::publishGlobals()
+{
+	if(NULL == m_status_page)
+	{
+		return;
+	}
+	begin_status_update(&m_status_page->sequence);
+	m_status_page->error_flags = m_error_flags;
+	m_status_page->power_state = m_is_powered_on;
+	end_status_update(&m_status_page->sequence);
+}
+
+const keyframePattern_t * ledMgrBase::findCheckpointPattern(const checkpointLayer_t &layer) const
+{
+	if(CHECKPOINT_PATTERN_KEYFRAME == layer.pattern_source)
+	{
+		for(unsigned int i = 0; i < NUM_PATTERNS; i++)
+		{
+			const keyframePattern_t &pattern = g_blink_patterns[i].pattern;
+			if((layer.pattern_id == pattern.id) && (layer.num_keyframes == pattern.num_keyframes))
+			{
+				return &pattern;
+			}
+		}
+	}
+	return NULL;
 }
 
 
@@ -21,7 +21,16 @@
 #include <vector>
 #include "ledmgr_types.hpp"
 #include "indicator.hpp"
+#include "indicatorgroup.hpp"
+#include "syncgroup.hpp"
+#include "checkpoint.hpp"
+#include "statuspage.hpp"
+#include "patternstore.hpp"
+#include "commandring.hpp"
+#include "debouncer.hpp"
+#include "rules.hpp"
 #include "pthread.h"
+#include "lockstats.hpp"
 #include "fp_profile.hpp"
 
 /**
@@ -29,6 +38,20 @@
  * @{
  */
 #define IARMBUS_OWNER_NAME "ledmgr"
+#define MAX_SYSSTATE_IDS 64	/**< Size of the sys-state interest bitmap */
+
+typedef enum
+{
+	EVENT_CLASS_SYSTEM_STATE = 0x01,	/**< sysmgr system-state events */
+	EVENT_CLASS_POWER_MODE = 0x02,		/**< pwrmgr power mode changes */
+	EVENT_CLASS_RESET_SEQUENCE = 0x04,	/**< pwrmgr reset sequence progress */
+	EVENT_CLASS_IR_KEY = 0x08,		/**< irmgr key events */
+	EVENT_CLASS_SYS_MODE = 0x10,		/**< SysModeChange RPC from the bus daemon */
+	EVENT_CLASS_ALL = 0x1F,
+}eventClass_t;
+
+/** Invoked with the new effective event class mask whenever the subscription set changes. */
+typedef void (*subscriptionListener_t)(unsigned int event_classes);
 
 /* @} */ // End of group LED_TYPES
 
@@ -39,16 +62,49 @@ class ledMgrBase
 		int m_is_powered_on;
 		unsigned int m_error_flags;
 		pthread_mutex_t m_mutex;
-		std::vector <blinkPattern_t> m_patterns;
-		std::vector <indicator> m_indicators;
-		/* Detect capabilies. Make a list of indicator objects. */
+		alignas(indicator) unsigned char m_indicator_storage[MAX_INDICATORS][sizeof(indicator)];	/**< Indicators are constructed in place and never move */
+		unsigned int m_num_indicators;
+		std::vector <indicatorGroup *> m_groups;
+		std::vector <syncGroup *> m_sync_groups;
+		unsigned int m_event_interest;
+		unsigned long long m_sysstate_interest;
+		bool m_all_sysstates;		/**< Legacy interest: also forward IDs past the bitmap */
+		subscriptionListener_t m_subscription_listener;
+		pthread_mutex_t m_subscription_mutex;	/**< Serialises calls to the subscription listener */
+		unsigned int m_delivered_interest;	/**< Last interest the listener was given */
+		checkpointSegment_t *m_checkpoint;
+		ledmgr_status_page_t *m_status_page;
+		patternStore m_pattern_store;
+		eventDebouncer m_debouncer;
+		ruleTable m_rules;
+		deepSleepState_t m_deep_sleep_states[MAX_INDICATORS];	/**< Parallel to the indicator arena */
+		std::vector <deepSleepState_t> m_group_deep_sleep_states;	/**< Parallel to m_groups */
+		ledCurrent_t m_led_currents[MAX_INDICATORS];		/**< Parallel to the indicator arena */
+		bool m_engine_suspended;
+
+		void setEventInterest(unsigned int event_classes, const unsigned int *state_ids, unsigned int num_state_ids);
+		int setDebounce(unsigned int state_id, unsigned int rise_ms, unsigned int fall_ms, unsigned int min_display_ms = 0);
+		int setDeepSleepState(const std::string &name, bool lit, unsigned int brightness = 0);
+		int setLedCurrent(const std::string &name, unsigned int current_ua, unsigned int supply_mv);
+		indicator& addIndicator(const std::string &name, ledBackend &backend = getDefaultLedBackend());
+		int detectIndicators(ledBackend &backend = getDefaultLedBackend());
+		indicator* getIndicatorAt(unsigned int index);
 	public:
 		ledMgrBase();
 		~ledMgrBase();
 		virtual int createBlinkPatterns();
-		const blinkPattern_t * getPattern(blinkPatternType_t pattern) const;
+		const keyframePattern_t * getPattern(blinkPatternType_t pattern) const;
 		void diagnostics();
+		int getEnergy(const char *name, energyBucket_t *buckets, unsigned int max_buckets, unsigned int &num_buckets);
+		indicator& getIndicator(const char *name);
 		indicator& getIndicator(const std::string &name);
+		indicator* findIndicator(const char *name);
+		indicator* findIndicatorAt(unsigned int index);
+		indicatorGroup& addIndicatorGroup(const std::string &name, const std::string &member_prefix, unsigned int num_members);
+		indicatorGroup& getIndicatorGroup(const std::string &name);
+		indicatorGroup* findIndicatorGroup(const std::string &name);
+		int joinSyncGroup(const std::string &name, indicator &member, const keyframePattern_t *pattern);
+		void leaveSyncGroup(indicator &member);
 		virtual void handleCDLEvents(unsigned int event){}
 		virtual void handleModeChange(unsigned int mode){}
 		virtual void handleGatewayConnectionEvent(unsigned int state, unsigned int error){}
@@ -58,6 +114,39 @@ class ledMgrBase
 		void setPowerState(int state);
 		int getPowerState();
 		bool setError(unsigned int position, bool value);
+		void subscribeEvents(unsigned int event_classes);
+		void unsubscribeEvents(unsigned int event_classes);
+		int subscribeSysState(unsigned int state_id);
+		int unsubscribeSysState(unsigned int state_id);
+		bool isSysStateSubscribed(unsigned int state_id);
+		unsigned int getEventInterest();
+		void setSubscriptionListener(subscriptionListener_t listener);
+		eventDebouncer& getDebouncer();
+		int loadRules(const char *path);
+		void setSysMode(unsigned int mode);
+		void setSysStateValue(unsigned int state_id, int value);
+		int startCheckpointing();
+		void stopCheckpointing();
+		int registerPattern(const keyframe_t *keyframes, unsigned int num_keyframes, const uint32_t *palette,
+			unsigned int num_colors, unsigned int &handle);
+		int releasePattern(unsigned int handle);
+		int playPattern(const char *indicator_name, unsigned int handle, int repetitions);
+		bool isPatternInUse(const keyframePattern_t *pattern);
+		int startStatusPage();
+		void stopStatusPage();
+		int startCommandRings();
+		void stopCommandRings();
+		int executeRingCommand(const ledmgr_ring_command_t &command);
+	private:
+		int playPatternOn(indicator &led, unsigned int handle, int repetitions);
+		void applyRulesLocked();
+		void suspendEngineLocked();
+		void resumeEngineLocked();
+		void checkpointGlobals();
+		void publishGlobals();
+		const keyframePattern_t * findCheckpointPattern(const checkpointLayer_t &layer) const;
+		unsigned int getEventInterestLocked() const;
+		void notifySubscriptionChange();
 };
 
 #endif /*LEDMGRBASE_H*/
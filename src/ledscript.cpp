@@ -0,0 +1,202 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifdef LEDMGR_COROUTINES
+#include <new>
+#include "ledscript.hpp"
+#include "indicator.hpp"
+#include "ledtiming.hpp"
+
+static pthread_mutex_t g_frame_mutex = PTHREAD_MUTEX_INITIALIZER;
+alignas(std::max_align_t) static unsigned char g_frames[MAX_LED_SCRIPTS][LED_SCRIPT_FRAME_SIZE];
+static bool g_frame_in_use[MAX_LED_SCRIPTS];
+static unsigned int g_active_scripts = 0;
+static unsigned int g_peak_frame_size = 0;
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+/**
+ * @brief Allocates a script's coroutine frame from the pool.
+ *
+ * @return  Returns the frame, or nullptr if it is too large or the pool is exhausted; the script is
+ * then returned empty and never runs.
+ */
+void * ledScript::promise_type::operator new(std::size_t size) noexcept
+{
+	void *frame = nullptr;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_frame_mutex));
+	if(g_peak_frame_size < size)
+	{
+		g_peak_frame_size = size;
+	}
+	if(LED_SCRIPT_FRAME_SIZE < size)
+	{
+		ERROR("Script frame of %u bytes exceeds %u!\n", (unsigned int)size, LED_SCRIPT_FRAME_SIZE);
+	}
+	else
+	{
+		for(unsigned int i = 0; i < MAX_LED_SCRIPTS; i++)
+		{
+			if(!g_frame_in_use[i])
+			{
+				g_frame_in_use[i] = true;
+				g_active_scripts++;
+				frame = g_frames[i];
+				break;
+			}
+		}
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_frame_mutex));
+	return frame;
+}
+
+void ledScript::promise_type::operator delete(void *frame, std::size_t size)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_frame_mutex));
+	unsigned int index = ((unsigned char *)frame - &g_frames[0][0]) / LED_SCRIPT_FRAME_SIZE;
+	g_frame_in_use[index] = false;
+	g_active_scripts--;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_frame_mutex));
+}
+
+/**
+ * @brief This API reports how many scripts are running and the largest frame a script has asked for.
+ */
+void get_led_script_stats(unsigned int &active_scripts, unsigned int &peak_frame_size)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_frame_mutex));
+	active_scripts = g_active_scripts;
+	peak_frame_size = g_peak_frame_size;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_frame_mutex));
+}
+
+/*Runs with the indicator's lock held, from inside the script's resumption.*/
+void scriptSleep::await_suspend(ledScript::handle_t handle)
+{
+	handle.promise().owner->scheduleScript(m_milliseconds);
+}
+
+void scriptEvent::awaiter::await_suspend(ledScript::handle_t handle)
+{
+	led = handle.promise().owner;
+	led->waitScriptEvent(&event);
+}
+
+int scriptEvent::awaiter::await_resume() const
+{
+	return led->m_script_event_value;
+}
+
+/**
+ * @brief Callback function fired on the LED timing loop after a script event was signalled.
+ *
+ * @param[in] data      address of the scriptEvent.
+ *
+ * @return  Returns false; every signal registers its own callback.
+ */
+static gboolean masterScriptEventCallbackFunction(gpointer data)
+{
+	((scriptEvent *)data)->dispatch();
+	return false;
+}
+
+scriptEvent::scriptEvent()
+{
+	m_waiters = nullptr;
+	m_value = 0;
+	m_source_id = 0;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_init(&m_mutex, NULL));
+}
+
+/*Scripts waiting on the event must be stopped first.*/
+scriptEvent::~scriptEvent()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	if(0 != m_source_id)
+	{
+		led_source_remove(m_source_id);
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	pthread_mutex_destroy(&m_mutex);
+}
+
+/**
+ * @brief This API wakes the scripts waiting on the event, on the LED timing loop.
+ *
+ * @param[in] value     returned by their co_await.
+ */
+void scriptEvent::signal(int value)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	m_value = value;
+	if(0 == m_source_id)
+	{
+		m_source_id = led_timeout_add(0, masterScriptEventCallbackFunction, (gpointer)this);
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/*Scripts that start waiting while the current ones run are left for the next signal.*/
+void scriptEvent::dispatch()
+{
+	indicator *waiters[MAX_INDICATORS];
+	unsigned int num_waiters = 0;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	m_source_id = 0;
+	int value = m_value;
+	for(indicator *led = m_waiters; (nullptr != led) && (MAX_INDICATORS > num_waiters); led = led->m_next_event_waiter)
+	{
+		waiters[num_waiters++] = led;
+	}
+	m_waiters = nullptr;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+
+	for(unsigned int i = 0; i < num_waiters; i++)
+	{
+		waiters[i]->scriptEventCallback(this, value);
+	}
+}
+
+void scriptEvent::addWaiter(indicator *led)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	led->m_next_event_waiter = m_waiters;
+	m_waiters = led;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+void scriptEvent::removeWaiter(indicator *led)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	for(indicator **link = &m_waiters; nullptr != *link; link = &(*link)->m_next_event_waiter)
+	{
+		if(led == *link)
+		{
+			*link = led->m_next_event_waiter;
+			break;
+		}
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/** @} */  //END OF GROUP LED_APIS
+
+#endif /*LEDMGR_COROUTINES*/
@@ -0,0 +1,141 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef LEDSCRIPT_H
+#define LEDSCRIPT_H
+#ifdef LEDMGR_COROUTINES
+#include <coroutine>
+#include <cstddef>
+#include "ledmgr_types.hpp"
+#include "pthread.h"
+#include "ledloop.hpp"
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+#define MAX_LED_SCRIPTS 8		/**< Scripts that can run at once */
+#define LED_SCRIPT_FRAME_SIZE 512	/**< Bytes available to each script's coroutine frame */
+
+/* @} */ // End of group LED_TYPES
+
+class indicator;
+
+/*LED behaviour written as a straight-line C++20 coroutine, run on the LED timing loop by indicator::runScript():
+ *
+ *	ledScript blinkThenHold(indicator &led, unsigned int times)
+ *	{
+ *		for(unsigned int i = 0; i < times; i++)
+ *		{
+ *			led.driveLevel(KEYFRAME_ON);
+ *			co_await scriptSleep(200);
+ *			led.driveLevel(KEYFRAME_OFF);
+ *			co_await scriptSleep(200);
+ *		}
+ *		led.driveLevel(KEYFRAME_ON);
+ *	}
+ *
+ *	led.runScript(blinkThenHold(led, 3));
+ *
+ * The frame comes from a fixed pool of MAX_LED_SCRIPTS blocks, and awaiting allocates nothing. A script that
+ * doesn't fit the pool is never started. Anything that takes the indicator over (setState(), setBlink(),
+ * another script) destroys the frame at its current suspension point, running the destructors of its locals.*/
+class ledScript
+{
+	public:
+		struct promise_type
+		{
+			indicator *owner;
+
+			promise_type() : owner(nullptr) {}
+			ledScript get_return_object() { return ledScript(std::coroutine_handle <promise_type>::from_promise(*this)); }
+			static ledScript get_return_object_on_allocation_failure() { return ledScript(); }
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			std::suspend_always final_suspend() noexcept { return {}; }
+			void return_void() {}
+			void unhandled_exception() { ERROR("Script threw, stopping it.\n"); }
+			static void * operator new(std::size_t size) noexcept;
+			static void operator delete(void *frame, std::size_t size);
+		};
+		typedef std::coroutine_handle <promise_type> handle_t;
+
+		ledScript() : m_handle() {}
+		explicit ledScript(handle_t handle) : m_handle(handle) {}
+		ledScript(ledScript &&other) noexcept : m_handle(other.m_handle) { other.m_handle = nullptr; }
+		~ledScript() { if(m_handle) m_handle.destroy(); }
+		bool isValid() const { return static_cast <bool>(m_handle); }
+		handle_t release() { handle_t handle = m_handle; m_handle = nullptr; return handle; }
+
+	private:
+		handle_t m_handle;
+
+		ledScript(const ledScript &);
+		ledScript& operator=(const ledScript &);
+};
+
+/*co_await scriptSleep(ms): resumes the script from an LED timer.*/
+class scriptSleep
+{
+	private:
+		unsigned int m_milliseconds;
+
+	public:
+		explicit scriptSleep(unsigned int milliseconds) : m_milliseconds(milliseconds) {}
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(ledScript::handle_t handle);
+		void await_resume() const noexcept {}
+};
+
+/*Something scripts wait for, e.g. download progress: "int percent = co_await progress;". signal() may be
+ * called from any thread; waiting scripts resume on the LED timing loop with the value. Signals that arrive
+ * before the waiters have run are coalesced, and the last value wins. Waiters are chained through
+ * the indicators, so waiting allocates nothing.*/
+class scriptEvent
+{
+	private:
+		pthread_mutex_t m_mutex;
+		indicator *m_waiters;
+		int m_value;
+		guint m_source_id;
+
+		scriptEvent(const scriptEvent &);
+		scriptEvent& operator=(const scriptEvent &);
+
+	public:
+		struct awaiter
+		{
+			scriptEvent &event;
+			indicator *led;
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(ledScript::handle_t handle);
+			int await_resume() const;
+		};
+
+		scriptEvent();
+		~scriptEvent();
+		void signal(int value);
+		void dispatch();
+		awaiter operator co_await() { return awaiter{*this, nullptr}; }
+		void addWaiter(indicator *led);
+		void removeWaiter(indicator *led);
+};
+
+void get_led_script_stats(unsigned int &active_scripts, unsigned int &peak_frame_size);
+
+#endif /*LEDMGR_COROUTINES*/
+#endif /*LEDSCRIPT_H*/
@@ -0,0 +1,488 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <algorithm>
+#include "ledtiming.hpp"
+#include "ledmgr_types.hpp"
+#include "pthread.h"
+
+#define TIMER_INDEX_BITS 7	/**< Low bits of a timer ID select its slot */
+#define TIMING_STACK_PREFAULT (32 * 1024)
+
+typedef struct
+{
+	guint id;		/**< 0 while the slot is free */
+	guint interval_ms;
+	gint64 deadline_us;
+	GSourceFunc function;
+	gpointer data;
+	gint64 remaining_us;	/**< Time left when suspended */
+}ledTimer_t;
+
+static pthread_mutex_t g_timing_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t g_dispatch_mutex = PTHREAD_MUTEX_INITIALIZER;	/**< Held around callbacks; taken before g_timing_mutex */
+static pthread_cond_t g_timing_cond;
+static ledTimer_t g_timers[MAX_LED_TIMERS];
+static unsigned int g_num_timers = 0;
+static guint g_next_serial = 1;
+static bool g_rt_running = false;
+static pthread_t g_rt_thread;
+static ledWakeup_t *g_timing_wakeup = NULL;	/**< Wakes the main loop for the earliest deadline, outside real-time mode */
+static __thread guint g_current_timer = 0;
+static bool g_suspended = false;
+static gint64 g_suspended_at_us = 0;
+static gint64 g_suspended_total_us = 0;
+
+static unsigned long long g_dispatched = 0;
+static uint32_t g_lateness[LATENCY_SAMPLES];
+static unsigned int g_num_lateness = 0;
+static unsigned int g_lateness_head = 0;
+static unsigned int g_max_lateness = 0;
+
+/*Records how late a dispatch is. Called with g_timing_mutex held.*/
+static void record_lateness(gint64 deadline_us, gint64 now_us)
+{
+	uint32_t lateness_us = (now_us > deadline_us) ? (uint32_t)(now_us - deadline_us) : 0;
+	g_dispatched++;
+	g_lateness[g_lateness_head] = lateness_us;
+	g_lateness_head = (g_lateness_head + 1) % LATENCY_SAMPLES;
+	if(LATENCY_SAMPLES > g_num_lateness)
+	{
+		g_num_lateness++;
+	}
+	g_max_lateness = std::max(g_max_lateness, lateness_us);
+}
+
+static ledTimer_t * find_timer(guint timer_id)
+{
+	ledTimer_t *timer = &g_timers[timer_id & (MAX_LED_TIMERS - 1)];
+	return ((0 != timer_id) && (timer_id == timer->id)) ? timer : NULL;
+}
+
+static void free_timer(ledTimer_t *timer)
+{
+	timer->id = 0;
+	g_num_timers--;
+}
+
+static ledTimer_t * earliest_timer()
+{
+	ledTimer_t *next = NULL;
+	for(unsigned int i = 0; i < MAX_LED_TIMERS; i++)
+	{
+		if((0 != g_timers[i].id) && ((NULL == next) || (g_timers[i].deadline_us < next->deadline_us)))
+		{
+			next = &g_timers[i];
+		}
+	}
+	return next;
+}
+
+/*Points whoever waits for timers at the earliest deadline. Called with g_timing_mutex held whenever the
+ * timer set changes.*/
+static void reschedule_locked()
+{
+	if(g_rt_running)
+	{
+		REPORT_IF_UNEQUAL(0, pthread_cond_signal(&g_timing_cond));
+	}
+	else if(NULL != g_timing_wakeup)
+	{
+		ledTimer_t *next = g_suspended ? NULL : earliest_timer();
+		led_wakeup_set(g_timing_wakeup, (NULL != next) ? next->deadline_us : -1);
+	}
+}
+
+/*Runs one expired timer. Called with g_timing_mutex held; drops it around the callback, since the
+ * callback may arm and remove timers. Returns whether the timer is still armed.*/
+static gboolean dispatch_timer(ledTimer_t *timer, gint64 now_us)
+{
+	guint timer_id = timer->id;
+	GSourceFunc function = timer->function;
+	gpointer data = timer->data;
+	record_lateness(timer->deadline_us, now_us);
+
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_timing_mutex));
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_dispatch_mutex));
+	g_current_timer = timer_id;
+	gboolean keep = function(data);
+	g_current_timer = 0;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_dispatch_mutex));
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_timing_mutex));
+
+	if(timer != find_timer(timer_id))
+	{
+		return FALSE;	/*Removed by the callback, or by another thread meanwhile*/
+	}
+	if(!keep)
+	{
+		free_timer(timer);
+		return FALSE;
+	}
+	if(g_suspended)
+	{
+		timer->remaining_us = timer->interval_ms * 1000;	/*Suspended while the callback ran*/
+		return FALSE;
+	}
+	/*Keep the cadence of the original deadline.*/
+	timer->deadline_us += timer->interval_ms * 1000;
+	gint64 finished_us = led_monotonic_us();
+	if(timer->deadline_us < finished_us)
+	{
+		/*Overran a whole interval; start a fresh one rather than catching up with back-to-back edges.*/
+		timer->deadline_us = finished_us + timer->interval_ms * 1000;
+	}
+	return TRUE;
+}
+
+/*Runs every timer that is due on the main loop, then sleeps until the next deadline. Arming a timer
+ * moves a ready time rather than adding a main loop source, so steady-state blinking never allocates.*/
+static gboolean masterTimingCallbackFunction(gpointer data)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_timing_mutex));
+	gint64 now_us = led_monotonic_us();
+	for(unsigned int i = 0; (i < MAX_LED_TIMERS) && !g_rt_running && !g_suspended; i++)
+	{
+		ledTimer_t *next = earliest_timer();
+		if((NULL == next) || (next->deadline_us > now_us))
+		{
+			break;
+		}
+		dispatch_timer(next, now_us);
+	}
+	reschedule_locked();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_timing_mutex));
+	return G_SOURCE_CONTINUE;
+}
+
+static void * timing_thread(void *context)
+{
+	/*Fault the stack in now rather than on the first deep call.*/
+	volatile char stack_prefault[TIMING_STACK_PREFAULT];
+	memset((void *)stack_prefault, 0, sizeof(stack_prefault));
+
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_timing_mutex));
+	while(g_rt_running)
+	{
+		if(g_suspended)
+		{
+			REPORT_IF_UNEQUAL(0, pthread_cond_wait(&g_timing_cond, &g_timing_mutex));
+			continue;
+		}
+		ledTimer_t *next = earliest_timer();
+		if(NULL == next)
+		{
+			REPORT_IF_UNEQUAL(0, pthread_cond_wait(&g_timing_cond, &g_timing_mutex));
+			continue;
+		}
+		gint64 now_us = led_monotonic_us();
+		if(next->deadline_us > now_us)
+		{
+			/*Absolute CLOCK_MONOTONIC deadline, woken early only when the timer set changes.*/
+			struct timespec deadline;
+			deadline.tv_sec = next->deadline_us / G_USEC_PER_SEC;
+			deadline.tv_nsec = (next->deadline_us % G_USEC_PER_SEC) * 1000;
+			int ret = pthread_cond_timedwait(&g_timing_cond, &g_timing_mutex, &deadline);
+			if((0 != ret) && (ETIMEDOUT != ret))
+			{
+				ERROR("Timing thread wait failed with %d!\n", ret);
+			}
+			continue;
+		}
+		dispatch_timer(next, now_us);
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_timing_mutex));
+	return NULL;
+}
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+/**
+ * @brief This API arms an LED timer, on the real-time thread if it runs and on the main loop otherwise.
+ *
+ * @param[in] interval_ms   time until the first call, and between calls while the callback returns TRUE.
+ * @param[in] function      callback.
+ * @param[in] data          callback argument.
+ *
+ * @return  Returns the timer ID, or 0 if all timers are in use.
+ */
+guint led_timeout_add(guint interval_ms, GSourceFunc function, gpointer data)
+{
+	guint timer_id = 0;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_timing_mutex));
+	if(!g_rt_running && (NULL == g_timing_wakeup))
+	{
+		g_timing_wakeup = led_wakeup_new(masterTimingCallbackFunction, NULL);
+	}
+	for(unsigned int i = 0; i < MAX_LED_TIMERS; i++)
+	{
+		ledTimer_t &timer = g_timers[(g_next_serial + i) & (MAX_LED_TIMERS - 1)];
+		if(0 != timer.id)
+		{
+			continue;
+		}
+		g_next_serial += i;
+		timer_id = g_next_serial++;
+		if(0 == (timer_id >> TIMER_INDEX_BITS))
+		{
+			timer_id += MAX_LED_TIMERS;	/*Keep IDs non-zero*/
+			g_next_serial += MAX_LED_TIMERS;
+		}
+		timer.id = timer_id;
+		timer.interval_ms = interval_ms;
+		timer.deadline_us = led_monotonic_us() + (interval_ms * 1000);
+		timer.function = function;
+		timer.data = data;
+		timer.remaining_us = interval_ms * 1000;
+		g_num_timers++;
+		reschedule_locked();	/*While suspended, resume_led_timers() arms it.*/
+		break;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_timing_mutex));
+	if(0 == timer_id)
+	{
+		ERROR("Out of LED timers!\n");
+	}
+	return timer_id;
+}
+
+/**
+ * @brief This API disarms an LED timer. It may be called from the timer's own callback.
+ *
+ * @return  Returns TRUE if the timer was armed.
+ */
+gboolean led_source_remove(guint timer_id)
+{
+	gboolean ret = FALSE;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_timing_mutex));
+	ledTimer_t *timer = find_timer(timer_id);
+	if(NULL != timer)
+	{
+		free_timer(timer);
+		reschedule_locked();
+		ret = TRUE;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_timing_mutex));
+	return ret;
+}
+
+/**
+ * @brief This API returns the ID of the LED timer whose callback the calling thread is running, or 0.
+ */
+guint led_current_timer()
+{
+	return g_current_timer;
+}
+
+/**
+ * @brief This API keeps LED timer callbacks from running until release_led_timers(), so that a group of
+ * changes lands between two edges wherever the timers run. Timers that fall due meanwhile run late.
+ * Must not be called from a timer callback.
+ */
+void hold_led_timers()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_dispatch_mutex));
+}
+
+void release_led_timers()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_dispatch_mutex));
+}
+
+/**
+ * @brief This API freezes every LED timer in one pass, e.g. for deep sleep. Each keeps the time it had
+ * left, so patterns pick up at the phase they were at when resumed.
+ */
+void suspend_led_timers()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_timing_mutex));
+	if(!g_suspended)
+	{
+		g_suspended = true;
+		g_suspended_at_us = led_monotonic_us();
+		for(unsigned int i = 0; i < MAX_LED_TIMERS; i++)
+		{
+			ledTimer_t &timer = g_timers[i];
+			if(0 == timer.id)
+			{
+				continue;
+			}
+			timer.remaining_us = std::max(timer.deadline_us - g_suspended_at_us, (gint64)0);
+		}
+		reschedule_locked();
+		INFO("Suspended %u LED timers\n", g_num_timers);
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_timing_mutex));
+}
+
+/**
+ * @brief This API re-arms the timers frozen by suspend_led_timers() with the time they had left.
+ */
+void resume_led_timers()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_timing_mutex));
+	if(g_suspended)
+	{
+		gint64 now_us = led_monotonic_us();
+		g_suspended = false;
+		g_suspended_total_us += now_us - g_suspended_at_us;
+		for(unsigned int i = 0; i < MAX_LED_TIMERS; i++)
+		{
+			ledTimer_t &timer = g_timers[i];
+			if(0 == timer.id)
+			{
+				continue;
+			}
+			timer.deadline_us = now_us + timer.remaining_us;
+		}
+		reschedule_locked();
+		INFO("Resumed %u LED timers\n", g_num_timers);
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_timing_mutex));
+}
+
+/**
+ * @brief This API returns CLOCK_MONOTONIC in microseconds, less the time LED timers spent suspended.
+ * Timelines anchored to it, such as sync groups, resume in phase.
+ */
+gint64 led_timing_now_us()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_timing_mutex));
+	gint64 now_us = (g_suspended ? g_suspended_at_us : led_monotonic_us()) - g_suspended_total_us;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_timing_mutex));
+	return now_us;
+}
+
+/**
+ * @brief This API moves LED timing to a SCHED_FIFO thread and locks the daemon's memory, so that neither
+ * CPU load nor paging delays an edge. Needs CAP_SYS_NICE and CAP_IPC_LOCK (call it before dropping
+ * privileges), and must be called before any LED timer is armed.
+ *
+ * @param[in] priority   SCHED_FIFO priority of the timing thread.
+ *
+ * @return  Returns 0 on success, -1 if timers stay on the main loop.
+ */
+int start_rt_timing(int priority)
+{
+	int ret = -1;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_timing_mutex));
+	if(g_rt_running || (0 != g_num_timers))
+	{
+		ERROR("Real-time timing must be started before any LED timer is armed!\n");
+		REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_timing_mutex));
+		return -1;
+	}
+	pthread_condattr_t cond_attribute;
+	REPORT_IF_UNEQUAL(0, pthread_condattr_init(&cond_attribute));
+	REPORT_IF_UNEQUAL(0, pthread_condattr_setclock(&cond_attribute, CLOCK_MONOTONIC));
+	REPORT_IF_UNEQUAL(0, pthread_cond_init(&g_timing_cond, &cond_attribute));
+	pthread_condattr_destroy(&cond_attribute);
+
+	if(0 != mlockall(MCL_CURRENT | MCL_FUTURE))
+	{
+		ERROR("Could not lock memory (errno %d); edges may stall on page faults.\n", errno);
+	}
+	pthread_attr_t attribute;
+	struct sched_param param;
+	memset(&param, 0, sizeof(param));
+	param.sched_priority = priority;
+	REPORT_IF_UNEQUAL(0, pthread_attr_init(&attribute));
+	REPORT_IF_UNEQUAL(0, pthread_attr_setinheritsched(&attribute, PTHREAD_EXPLICIT_SCHED));
+	REPORT_IF_UNEQUAL(0, pthread_attr_setschedpolicy(&attribute, SCHED_FIFO));
+	REPORT_IF_UNEQUAL(0, pthread_attr_setschedparam(&attribute, &param));
+	g_rt_running = true;
+	int error = pthread_create(&g_rt_thread, &attribute, timing_thread, NULL);
+	pthread_attr_destroy(&attribute);
+	if(0 == error)
+	{
+		INFO("LED timing runs on a SCHED_FIFO thread at priority %d\n", priority);
+		ret = 0;
+	}
+	else
+	{
+		ERROR("Could not start the real-time timing thread (error %d)!\n", error);
+		g_rt_running = false;
+		pthread_cond_destroy(&g_timing_cond);
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_timing_mutex));
+	return ret;
+}
+
+/**
+ * @brief This API stops the real-time timing thread. Timers still armed no longer fire, but stay valid
+ * for led_source_remove() so that their owners can be torn down as usual.
+ */
+void stop_rt_timing()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_timing_mutex));
+	if(!g_rt_running)
+	{
+		REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_timing_mutex));
+		return;
+	}
+	g_rt_running = false;
+	REPORT_IF_UNEQUAL(0, pthread_cond_signal(&g_timing_cond));
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_timing_mutex));
+	REPORT_IF_UNEQUAL(0, pthread_join(g_rt_thread, NULL));
+	pthread_cond_destroy(&g_timing_cond);
+	munlockall();
+}
+
+/**
+ * @brief This API reports how late LED timers have been dispatched, over the most recent dispatches.
+ */
+void get_led_timing_stats(ledTimingStats_t &stats)
+{
+	static uint32_t sorted[LATENCY_SAMPLES];
+	static pthread_mutex_t sorted_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&sorted_mutex));
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_timing_mutex));
+	stats.dispatched = g_dispatched;
+	stats.num_samples = g_num_lateness;
+	stats.max_us = g_max_lateness;
+	stats.realtime = g_rt_running;
+	stats.suspended = g_suspended;
+	memcpy(sorted, g_lateness, g_num_lateness * sizeof(sorted[0]));
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_timing_mutex));
+
+	std::sort(sorted, sorted + stats.num_samples);
+	stats.p50_us = (0 != stats.num_samples) ? sorted[(stats.num_samples - 1) / 2] : 0;
+	stats.p99_us = (0 != stats.num_samples) ? sorted[((stats.num_samples - 1) * 99) / 100] : 0;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&sorted_mutex));
+}
+
+void reset_led_timing_stats()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_timing_mutex));
+	g_dispatched = 0;
+	g_num_lateness = 0;
+	g_lateness_head = 0;
+	g_max_lateness = 0;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_timing_mutex));
+}
+
+/** @} */  //END OF GROUP LED_APIS
@@ -0,0 +1,72 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef LEDTIMING_H
+#define LEDTIMING_H
+#include <stdint.h>
+#include "ledloop.hpp"
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+#define MAX_LED_TIMERS 128		/**< Timers armed at once, across all indicators and groups */
+#define LATENCY_SAMPLES 4096		/**< Most recent dispatches kept for percentiles */
+#define DEFAULT_RT_TIMING_PRIORITY 10	/**< SCHED_FIFO priority of the timing thread */
+
+typedef struct
+{
+	unsigned long long dispatched;	/**< Timer callbacks run since the last reset */
+	unsigned int num_samples;	/**< Dispatches the percentiles below are taken over */
+	unsigned int p50_us;		/**< Lateness of a dispatch against its deadline */
+	unsigned int p99_us;
+	unsigned int max_us;
+	bool realtime;			/**< Timers run on the real-time thread */
+	bool suspended;			/**< Timers are frozen by suspend_led_timers() */
+}ledTimingStats_t;
+
+/* @} */ // End of group LED_TYPES
+
+/*Scheduling interface of the LED engine: every blink, flare, color, group and script timer goes through
+ * here rather than straight to the main loop. By default timers share one main loop wakeup (ledloop.hpp),
+ * set for the earliest deadline, so arming a timer allocates nothing. start_rt_timing() moves them to
+ * a dedicated SCHED_FIFO thread that sleeps to absolute deadlines, so load on the rest of the box no
+ * longer shows up as uneven blinking. Callbacks then run on that thread.
+ *
+ * Same contract as g_timeout_add(): the callback returns TRUE to run again after another interval.
+ *
+ * suspend_led_timers() freezes every timer in one pass, keeping the time each had left, and nothing
+ * wakes up until resume_led_timers() re-arms them with that time, timer IDs unchanged. Timers armed in
+ * between start frozen. led_timing_now_us() is the monotonic clock with the suspended time taken out.
+ *
+ * hold_led_timers() makes the caller's changes atomic with respect to timer edges: no callback starts
+ * until release_led_timers().*/
+guint led_timeout_add(guint interval_ms, GSourceFunc function, gpointer data);
+gboolean led_source_remove(guint timer_id);
+guint led_current_timer();
+void hold_led_timers();
+void release_led_timers();
+void suspend_led_timers();
+void resume_led_timers();
+gint64 led_timing_now_us();
+int start_rt_timing(int priority);
+void stop_rt_timing();
+void get_led_timing_stats(ledTimingStats_t &stats);
+void reset_led_timing_stats();
+
+#endif /*LEDTIMING_H*/
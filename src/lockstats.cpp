@@ -0,0 +1,96 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include "lockstats.hpp"
+
+#ifdef LOCK_STATS
+static lockStats_t g_lock_stats[LOCK_CLASS_MAX];
+
+static unsigned long long now_ns()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((unsigned long long)now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+/**
+ * @brief This API acquires the mutex and accounts for the time spent waiting on it. The uncontended
+ * case costs a trylock and no clock reads.
+ *
+ * @param[in] mutex		mutex to lock.
+ * @param[in] lock_class	statistics bucket.
+ *
+ * @return  Returns the pthread_mutex_lock result.
+ */
+int lock_mutex_timed(pthread_mutex_t *mutex, lockClass_t lock_class)
+{
+	lockStats_t &stats = g_lock_stats[lock_class];
+	int ret = pthread_mutex_trylock(mutex);
+	if(EBUSY == ret)
+	{
+		unsigned long long start = now_ns();
+		ret = pthread_mutex_lock(mutex);
+		unsigned long long waited = now_ns() - start;
+		__atomic_add_fetch(&stats.contended, 1, __ATOMIC_RELAXED);
+		__atomic_add_fetch(&stats.wait_time_ns, waited, __ATOMIC_RELAXED);
+		unsigned long long max_wait = __atomic_load_n(&stats.max_wait_ns, __ATOMIC_RELAXED);
+		while((waited > max_wait) && !__atomic_compare_exchange_n(&stats.max_wait_ns, &max_wait, waited,
+					true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+	}
+	if(0 == ret)
+	{
+		__atomic_add_fetch(&stats.acquisitions, 1, __ATOMIC_RELAXED);
+	}
+	return ret;
+}
+
+/**
+ * @brief This API returns a snapshot of the statistics for one lock class.
+ */
+void get_lock_stats(lockClass_t lock_class, lockStats_t *stats)
+{
+	stats->acquisitions = __atomic_load_n(&g_lock_stats[lock_class].acquisitions, __ATOMIC_RELAXED);
+	stats->contended = __atomic_load_n(&g_lock_stats[lock_class].contended, __ATOMIC_RELAXED);
+	stats->wait_time_ns = __atomic_load_n(&g_lock_stats[lock_class].wait_time_ns, __ATOMIC_RELAXED);
+	stats->max_wait_ns = __atomic_load_n(&g_lock_stats[lock_class].max_wait_ns, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief This API clears the statistics of all lock classes.
+ */
+void reset_lock_stats()
+{
+	for(int i = 0; i < LOCK_CLASS_MAX; i++)
+	{
+		__atomic_store_n(&g_lock_stats[i].acquisitions, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&g_lock_stats[i].contended, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&g_lock_stats[i].wait_time_ns, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&g_lock_stats[i].max_wait_ns, 0, __ATOMIC_RELAXED);
+	}
+}
+
+/** @} */  //END OF GROUP LED_APIS
+#endif /*LOCK_STATS*/
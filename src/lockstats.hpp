@@ -0,0 +1,58 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef LOCKSTATS_H
+#define LOCKSTATS_H
+#include <pthread.h>
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+typedef enum
+{
+	LOCK_CLASS_INDICATOR = 0,	/**< indicator::m_mutex (recursive) */
+	LOCK_CLASS_LEDMGRBASE,		/**< ledMgrBase::m_mutex (error-check) */
+	LOCK_CLASS_PATTERNSTORE,	/**< patternStore::m_mutex */
+	LOCK_CLASS_SYNCGROUP,		/**< syncGroup::m_mutex (recursive) */
+	LOCK_CLASS_INDICATORGROUP,	/**< indicatorGroup::m_mutex (recursive) */
+	LOCK_CLASS_MAX,
+}lockClass_t;
+
+typedef struct
+{
+	unsigned long long acquisitions;
+	unsigned long long contended;		/**< Acquisitions that had to wait */
+	unsigned long long wait_time_ns;	/**< Total time spent waiting */
+	unsigned long long max_wait_ns;
+}lockStats_t;
+
+/* @} */ // End of group LED_TYPES
+
+/*Building with -DLOCK_STATS routes the locks taken with LOCK_MUTEX through a timed acquisition path,
+ * accounted per lock class. Otherwise LOCK_MUTEX is a plain pthread_mutex_lock.*/
+#ifdef LOCK_STATS
+int lock_mutex_timed(pthread_mutex_t *mutex, lockClass_t lock_class);
+void get_lock_stats(lockClass_t lock_class, lockStats_t *stats);
+void reset_lock_stats();
+#define LOCK_MUTEX(mutex, lock_class) lock_mutex_timed((mutex), (lock_class))
+#else
+#define LOCK_MUTEX(mutex, lock_class) pthread_mutex_lock(mutex)
+#endif
+
+#endif /*LOCKSTATS_H*/
@@ -0,0 +1,287 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <string.h>
+#include "patternstore.hpp"
+
+#define ARENA_ALIGNMENT 8
+#define FNV_OFFSET_BASIS 2166136261U
+#define FNV_PRIME 16777619U
+
+patternStore::patternStore(patternInUse_t in_use, void *context)
+{
+	m_arena_top = 0;
+	m_in_use = in_use;
+	m_in_use_context = context;
+	for(unsigned int i = 0; i < MAX_CUSTOM_PATTERNS; i++)
+	{
+		m_entries[i].pattern = NULL;
+		m_entries[i].generation = 0;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_init(&m_mutex, NULL));
+}
+
+patternStore::~patternStore()
+{
+	pthread_mutex_destroy(&m_mutex);
+}
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+/**
+ * @brief This API registers a keyframe pattern, or takes another reference on an identical one.
+ *
+ * @param[in] keyframes		keyframes to copy into the store.
+ * @param[in] num_keyframes	number of keyframes, at least 1.
+ * @param[in] palette		colors referenced by the keyframes' color_index.
+ * @param[in] num_colors	number of palette entries.
+ * @param[out] handle		pattern handle. It is also the pattern's id.
+ *
+ * @return  Returns status of the operation.
+ */
+int patternStore::registerPattern(const keyframe_t *keyframes, unsigned int num_keyframes, const uint32_t *palette,
+	unsigned int num_colors, unsigned int &handle)
+{
+	if((NULL == keyframes) || (0 == num_keyframes) || ((0 != num_colors) && (NULL == palette)))
+	{
+		ERROR("Bad inputs!\n");
+		return -1;
+	}
+	uint32_t hash = hashPattern(keyframes, num_keyframes, palette, num_colors);
+
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_PATTERNSTORE));
+	int free_index = -1;
+	for(unsigned int i = 0; i < MAX_CUSTOM_PATTERNS; i++)
+	{
+		entry_t &entry = m_entries[i];
+		if(NULL == entry.pattern)
+		{
+			if(0 > free_index)
+			{
+				free_index = i;
+			}
+		}
+		else if((hash == entry.hash) && isSamePattern(entry.pattern, keyframes, num_keyframes, palette, num_colors))
+		{
+			entry.refcount++;
+			handle = entry.pattern->id;
+			REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+			DEBUG("Pattern 0x%x shared, %u references\n", handle, entry.refcount);
+			return 0;
+		}
+	}
+
+	size_t size = sizeof(keyframePattern_t) + (num_keyframes * sizeof(keyframe_t)) + (num_colors * sizeof(uint32_t));
+	size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+	if((0 > free_index) || (PATTERN_ARENA_SIZE - m_arena_top < size))
+	{
+		reclaim();
+		for(unsigned int i = 0; (0 > free_index) && (i < MAX_CUSTOM_PATTERNS); i++)
+		{
+			if(NULL == m_entries[i].pattern)
+			{
+				free_index = i;
+			}
+		}
+		if((0 > free_index) || (PATTERN_ARENA_SIZE - m_arena_top < size))
+		{
+			REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+			ERROR("Pattern store is full!\n");
+			return -1;
+		}
+	}
+
+	/*Descriptor, keyframes and palette go into one allocation at the top of the arena.*/
+	keyframePattern_t *pattern = (keyframePattern_t *)&m_arena[m_arena_top];
+	keyframe_t *pattern_keyframes = (keyframe_t *)(pattern + 1);
+	uint32_t *pattern_palette = (uint32_t *)(pattern_keyframes + num_keyframes);
+	memcpy(pattern_keyframes, keyframes, num_keyframes * sizeof(keyframe_t));
+	if(0 != num_colors)
+	{
+		memcpy(pattern_palette, palette, num_colors * sizeof(uint32_t));
+	}
+
+	entry_t &entry = m_entries[free_index];
+	entry.generation++;
+	if(0 == entry.generation)
+	{
+		entry.generation = 1;
+	}
+	/*Handles start at 0x10001, clear of the built-in blinkPatternType_t ids.*/
+	handle = ((unsigned int)entry.generation << 16) | (free_index + 1);
+	pattern->id = handle;
+	pattern->num_keyframes = num_keyframes;
+	pattern->keyframes = pattern_keyframes;
+	pattern->num_colors = num_colors;
+	pattern->palette = (0 != num_colors) ? pattern_palette : NULL;
+
+	entry.pattern = pattern;
+	entry.offset = m_arena_top;
+	entry.hash = hash;
+	entry.refcount = 1;
+	m_arena_top += size;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	INFO("Registered pattern 0x%x, %u keyframes, arena at %u bytes\n", handle, num_keyframes, (unsigned int)m_arena_top);
+	return 0;
+}
+
+/**
+ * @brief This API drops a reference taken by registerPattern(). Unreferenced patterns are reclaimed once
+ * no indicator is playing them.
+ *
+ * @return  Returns status of the operation.
+ */
+int patternStore::releasePattern(unsigned int handle)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_PATTERNSTORE));
+	int index = findEntry(handle);
+	if((0 > index) || (0 == m_entries[index].refcount))
+	{
+		REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+		ERROR("Unknown pattern handle 0x%x!\n", handle);
+		return -1;
+	}
+	m_entries[index].refcount--;
+	if(0 == m_entries[index].refcount)
+	{
+		reclaim();
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return 0;
+}
+
+/**
+ * @brief Holds the store lock. While it is held no pattern is reclaimed, so a pattern returned by
+ * lookupLocked() can be handed to an indicator safely.
+ */
+void patternStore::lock()
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_PATTERNSTORE));
+}
+
+void patternStore::unlock()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API returns the referenced pattern behind a handle. Call with the store lock held.
+ *
+ * @return  Returns the pattern, or NULL if the handle is stale or released.
+ */
+const keyframePattern_t * patternStore::lookupLocked(unsigned int handle) const
+{
+	int index = findEntry(handle);
+	if((0 > index) || (0 == m_entries[index].refcount))
+	{
+		return NULL;
+	}
+	return m_entries[index].pattern;
+}
+
+/**
+ * @brief This API returns the number of arena bytes in use, including dead patterns not yet reclaimed.
+ */
+size_t patternStore::getArenaUsed()
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_PATTERNSTORE));
+	size_t used = m_arena_top;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return used;
+}
+
+/** @} */  //END OF GROUP LED_APIS
+
+/*FNV-1a over the keyframe fields (not the bitfield storage) and the palette.*/
+uint32_t patternStore::hashPattern(const keyframe_t *keyframes, unsigned int num_keyframes, const uint32_t *palette,
+	unsigned int num_colors)
+{
+	uint32_t hash = FNV_OFFSET_BASIS;
+	for(unsigned int i = 0; i < num_keyframes; i++)
+	{
+		uint32_t fields[2] = {keyframes[i].duration,
+			((uint32_t)keyframes[i].brightness << 16) | ((uint32_t)keyframes[i].color_index << 8) | keyframes[i].easing};
+		const unsigned char *bytes = (const unsigned char *)fields;
+		for(unsigned int j = 0; j < sizeof(fields); j++)
+		{
+			hash = (hash ^ bytes[j]) * FNV_PRIME;
+		}
+	}
+	const unsigned char *bytes = (const unsigned char *)palette;
+	for(unsigned int j = 0; j < num_colors * sizeof(uint32_t); j++)
+	{
+		hash = (hash ^ bytes[j]) * FNV_PRIME;
+	}
+	return hash;
+}
+
+bool patternStore::isSamePattern(const keyframePattern_t *pattern, const keyframe_t *keyframes, unsigned int num_keyframes,
+	const uint32_t *palette, unsigned int num_colors)
+{
+	if((num_keyframes != pattern->num_keyframes) || (num_colors != pattern->num_colors))
+	{
+		return false;
+	}
+	for(unsigned int i = 0; i < num_keyframes; i++)
+	{
+		const keyframe_t &lhs = pattern->keyframes[i];
+		const keyframe_t &rhs = keyframes[i];
+		if((lhs.duration != rhs.duration) || (lhs.brightness != rhs.brightness) || (lhs.color_index != rhs.color_index) ||
+			(lhs.easing != rhs.easing))
+		{
+			return false;
+		}
+	}
+	return (0 == num_colors) || (0 == memcmp(pattern->palette, palette, num_colors * sizeof(uint32_t)));
+}
+
+int patternStore::findEntry(unsigned int handle) const
+{
+	unsigned int index = (handle & 0xFFFF) - 1;
+	if((MAX_CUSTOM_PATTERNS <= index) || (NULL == m_entries[index].pattern) || (handle != m_entries[index].pattern->id))
+	{
+		return -1;
+	}
+	return index;
+}
+
+/*Pops unreferenced, idle patterns off the top of the arena. Called with the store lock held.*/
+void patternStore::reclaim()
+{
+	while(0 != m_arena_top)
+	{
+		entry_t *top = NULL;
+		for(unsigned int i = 0; i < MAX_CUSTOM_PATTERNS; i++)
+		{
+			if((NULL != m_entries[i].pattern) && ((NULL == top) || (m_entries[i].offset > top->offset)))
+			{
+				top = &m_entries[i];
+			}
+		}
+		if((NULL == top) || (0 != top->refcount) || m_in_use(top->pattern, m_in_use_context))
+		{
+			break;
+		}
+		DEBUG("Reclaimed pattern 0x%x\n", top->pattern->id);
+		m_arena_top = top->offset;
+		top->pattern = NULL;
+	}
+}
@@ -0,0 +1,87 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef PATTERNSTORE_H
+#define PATTERNSTORE_H
+#include <stddef.h>
+#include <stdint.h>
+#include "ledmgr_types.hpp"
+#include "pthread.h"
+#include "lockstats.hpp"
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+#define PATTERN_ARENA_SIZE 16384	/**< Bytes of runtime pattern storage */
+#define MAX_CUSTOM_PATTERNS 64
+
+/** Returns true while any indicator may still read the pattern. */
+typedef bool (*patternInUse_t)(const keyframePattern_t *pattern, void *context);
+
+/* @} */ // End of group LED_TYPES
+
+/*Runtime-registered keyframe patterns. Each pattern (descriptor, keyframes and palette) is one
+ * allocation in a bump arena and never moves. Identical patterns are hash-consed: registering the
+ * same content again returns the existing handle with its reference count raised.
+ *
+ * A pattern is reclaimed once it has no references and no indicator is playing it. Space is given
+ * back from the top of the arena, so a dead pattern below a live one stays until the live one goes;
+ * until then registering the same content revives it.*/
+class patternStore
+{
+	private:
+		typedef struct
+		{
+			keyframePattern_t *pattern;	/**< Start of the allocation, NULL when the entry is free */
+			size_t offset;
+			uint32_t hash;
+			unsigned int refcount;
+			uint16_t generation;
+		}entry_t;
+
+		pthread_mutex_t m_mutex;
+		alignas(8) unsigned char m_arena[PATTERN_ARENA_SIZE];
+		size_t m_arena_top;
+		entry_t m_entries[MAX_CUSTOM_PATTERNS];
+		patternInUse_t m_in_use;
+		void *m_in_use_context;
+
+		patternStore(const patternStore &);
+		patternStore& operator=(const patternStore &);
+
+	public:
+		patternStore(patternInUse_t in_use, void *context);
+		~patternStore();
+		int registerPattern(const keyframe_t *keyframes, unsigned int num_keyframes, const uint32_t *palette,
+			unsigned int num_colors, unsigned int &handle);
+		int releasePattern(unsigned int handle);
+		void lock();
+		void unlock();
+		const keyframePattern_t * lookupLocked(unsigned int handle) const;
+		size_t getArenaUsed();
+	private:
+		static uint32_t hashPattern(const keyframe_t *keyframes, unsigned int num_keyframes, const uint32_t *palette,
+			unsigned int num_colors);
+		static bool isSamePattern(const keyframePattern_t *pattern, const keyframe_t *keyframes, unsigned int num_keyframes,
+			const uint32_t *palette, unsigned int num_colors);
+		int findEntry(unsigned int handle) const;
+		void reclaim();
+};
+
+#endif /*PATTERNSTORE_H*/
@@ -0,0 +1,574 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include "rules.hpp"
+#include "fp_profile.hpp"
+#include "pwrMgr.h"
+#include "libIBusDaemon.h"
+
+typedef struct
+{
+	const char *name;
+	int value;
+}ruleName_t;
+
+static const ruleName_t g_power_names[] =
+{
+	{"off", IARM_BUS_PWRMGR_POWERSTATE_OFF},
+	{"standby", IARM_BUS_PWRMGR_POWERSTATE_STANDBY},
+	{"on", IARM_BUS_PWRMGR_POWERSTATE_ON},
+	{"light_sleep", IARM_BUS_PWRMGR_POWERSTATE_STANDBY_LIGHT_SLEEP},
+	{"deep_sleep", IARM_BUS_PWRMGR_POWERSTATE_STANDBY_DEEP_SLEEP},
+	{NULL, 0},
+};
+
+static const ruleName_t g_mode_names[] =
+{
+	{"normal", IARM_BUS_SYS_MODE_NORMAL},
+	{"eas", IARM_BUS_SYS_MODE_EAS},
+	{"warehouse", IARM_BUS_SYS_MODE_WAREHOUSE},
+	{NULL, 0},
+};
+
+static const ruleName_t g_pattern_names[] =
+{
+	{"slow", STATE_SLOW_BLINK},
+	{"double", STATE_DOUBLE_BLINK},
+	{"fast", STATE_FAST_BLINK},
+	{NULL, 0},
+};
+
+typedef struct
+{
+	ruleInput_t input;
+	unsigned int id;
+	bool negate;
+	std::vector <int> values;
+}parsedCondition_t;
+
+typedef struct
+{
+	int priority;
+	unsigned int line;
+	std::vector <parsedCondition_t> conditions;
+	std::vector <uint16_t> masks;	/**< Per condition, the field codes it accepts */
+	std::vector <unsigned int> fields;
+	unsigned int indicator;
+	ruleAction_t action;
+}parsedRule_t;
+
+static bool parse_number(const std::string &text, int &value)
+{
+	char *end = NULL;
+	errno = 0;
+	long number = strtol(text.c_str(), &end, 0);
+	if(text.empty() || ('\0' != *end) || (0 != errno))
+	{
+		return false;
+	}
+	value = (int)number;
+	return true;
+}
+
+/*A value is a name from the table (if any) or a number.*/
+static bool parse_value(const std::string &text, const ruleName_t *names, int &value)
+{
+	for(unsigned int i = 0; (NULL != names) && (NULL != names[i].name); i++)
+	{
+		if(text == names[i].name)
+		{
+			value = names[i].value;
+			return true;
+		}
+	}
+	return parse_number(text, value);
+}
+
+/*<input>=<value>[|<value>...] or <input>!=<value>[|<value>...], where input is power, mode,
+ * error.<bit> or sysstate.<id>.*/
+static bool parse_condition(const std::string &token, parsedCondition_t &condition)
+{
+	size_t op = token.find('=');
+	if((std::string::npos == op) || (0 == op))
+	{
+		return false;
+	}
+	condition.negate = ('!' == token[op - 1]);
+	std::string input = token.substr(0, condition.negate ? op - 1 : op);
+	const ruleName_t *names = NULL;
+	condition.id = 0;
+	int id = 0;
+	if("power" == input)
+	{
+		condition.input = RULE_INPUT_POWER;
+		names = g_power_names;
+	}
+	else if("mode" == input)
+	{
+		condition.input = RULE_INPUT_SYS_MODE;
+		names = g_mode_names;
+	}
+	else if((0 == input.compare(0, 6, "error.")) && parse_number(input.substr(6), id) && (0 <= id) && (32 > id))
+	{
+		condition.input = RULE_INPUT_ERROR;
+		condition.id = id;
+	}
+	else if((0 == input.compare(0, 9, "sysstate.")) && parse_number(input.substr(9), id) && (0 <= id))
+	{
+		condition.input = RULE_INPUT_SYSSTATE;
+		condition.id = id;
+	}
+	else
+	{
+		return false;
+	}
+
+	std::stringstream alternatives(token.substr(op + 1));
+	std::string text;
+	while(std::getline(alternatives, text, '|'))
+	{
+		int value;
+		if(!parse_value(text, names, value) || ((RULE_INPUT_ERROR == condition.input) && (0 != value) && (1 != value)))
+		{
+			return false;
+		}
+		condition.values.push_back(value);
+	}
+	return !condition.values.empty();
+}
+
+/*<priority> [<condition>...] -> <indicator> on|off|none|blink <slow|double|fast> [<repetitions>]*/
+static bool parse_rule(const std::string &line, const std::vector <std::string> &indicator_names, parsedRule_t &rule)
+{
+	std::stringstream tokens(line);
+	std::string token;
+	if(!(tokens >> token) || !parse_number(token, rule.priority))
+	{
+		return false;
+	}
+	while((tokens >> token) && ("->" != token))
+	{
+		parsedCondition_t condition;
+		if(!parse_condition(token, condition))
+		{
+			return false;
+		}
+		rule.conditions.push_back(condition);
+	}
+	if(("->" != token) || !(tokens >> token))
+	{
+		return false;
+	}
+	std::vector <std::string>::const_iterator it = std::find(indicator_names.begin(), indicator_names.end(), token);
+	if(indicator_names.end() == it)
+	{
+		return false;
+	}
+	rule.indicator = it - indicator_names.begin();
+
+	rule.action.pattern = 0;
+	rule.action.repetitions = -1;
+	if(!(tokens >> token))
+	{
+		return false;
+	}
+	if("on" == token)
+	{
+		rule.action.type = RULE_ACTION_ON;
+	}
+	else if("off" == token)
+	{
+		rule.action.type = RULE_ACTION_OFF;
+	}
+	else if("none" == token)
+	{
+		rule.action.type = RULE_ACTION_NONE;
+	}
+	else if("blink" == token)
+	{
+		int pattern, repetitions;
+		rule.action.type = RULE_ACTION_BLINK;
+		if(!(tokens >> token) || !parse_value(token, g_pattern_names, pattern) || (0 > pattern) || (NUM_PATTERNS <= pattern))
+		{
+			return false;
+		}
+		rule.action.pattern = pattern;
+		if(tokens >> token)
+		{
+			if(!parse_number(token, repetitions) || (0 == repetitions) || (-1 > repetitions) || (INT16_MAX < repetitions))
+			{
+				return false;
+			}
+			rule.action.repetitions = repetitions;
+		}
+	}
+	else
+	{
+		return false;
+	}
+	return !(tokens >> token);
+}
+
+static bool higher_priority(const parsedRule_t &lhs, const parsedRule_t &rhs)
+{
+	return lhs.priority > rhs.priority;
+}
+
+static uint32_t encode_action(const ruleAction_t &action)
+{
+	return action.type | (action.pattern << 8) | ((uint32_t)(uint16_t)action.repetitions << 16);
+}
+
+ruleTable::ruleTable()
+{
+	m_num_indicators = 0;
+	m_num_rules = 0;
+	m_key = 0;
+	m_applied_outcome = RULE_NO_OUTCOME;
+	memset(m_applied, 0, sizeof(m_applied));
+	REPORT_IF_UNEQUAL(0, pthread_mutex_init(&m_mutex, NULL));
+}
+
+ruleTable::~ruleTable()
+{
+	pthread_mutex_destroy(&m_mutex);
+}
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+/**
+ * @brief This API reads a rules file and compiles it into the decision table. On any error the rules
+ * stay unloaded and the OEM hooks alone drive the indicators.
+ *
+ * @param[in] path             rules file.
+ * @param[in] indicator_names  indicators rules may name, in arena order.
+ *
+ * @return  Returns 0 on success, 1 if there is no rules file, -1 on error.
+ */
+int ruleTable::load(const char *path, const std::vector <std::string> &indicator_names)
+{
+	FILE *file = fopen(path, "r");
+	if(NULL == file)
+	{
+		return 1;
+	}
+	std::vector <parsedRule_t> rules;
+	char buffer[512];
+	unsigned int line_number = 0;
+	int ret = 0;
+	while(NULL != fgets(buffer, sizeof(buffer), file))
+	{
+		line_number++;
+		std::string line(buffer);
+		line = line.substr(0, line.find('#'));
+		if(std::string::npos == line.find_first_not_of(" \t\r\n"))
+		{
+			continue;
+		}
+		parsedRule_t rule;
+		rule.line = line_number;
+		if(!parse_rule(line, indicator_names, rule))
+		{
+			ERROR("%s:%u: invalid rule\n", path, line_number);
+			ret = -1;
+		}
+		rules.push_back(rule);
+	}
+	fclose(file);
+	if(0 != ret)
+	{
+		return -1;
+	}
+
+	/*One field per input the rules look at, sized for the values they compare against.*/
+	std::vector <ruleField_t> fields;
+	unsigned int key_bits = 0;
+	for(unsigned int r = 0; r < rules.size(); r++)
+	{
+		for(unsigned int c = 0; c < rules[r].conditions.size(); c++)
+		{
+			const parsedCondition_t &condition = rules[r].conditions[c];
+			unsigned int f;
+			for(f = 0; f < fields.size(); f++)
+			{
+				if((fields[f].input == condition.input) && (fields[f].id == condition.id))
+				{
+					break;
+				}
+			}
+			if(fields.size() == f)
+			{
+				ruleField_t field;
+				field.input = condition.input;
+				field.id = condition.id;
+				field.shift = 0;
+				field.width = 0;
+				if(RULE_INPUT_ERROR == condition.input)
+				{
+					field.values.push_back(1);	//Code 1: set, code 0: clear
+				}
+				fields.push_back(field);
+			}
+			rules[r].fields.push_back(f);
+			for(unsigned int v = 0; (RULE_INPUT_ERROR != condition.input) && (v < condition.values.size()); v++)
+			{
+				if(fields[f].values.end() == std::find(fields[f].values.begin(), fields[f].values.end(), condition.values[v]))
+				{
+					fields[f].values.push_back(condition.values[v]);
+				}
+			}
+		}
+	}
+	for(unsigned int f = 0; f < fields.size(); f++)
+	{
+		if(MAX_RULE_FIELD_VALUES < fields[f].values.size())
+		{
+			ERROR("%s: too many distinct values for one input\n", path);
+			return -1;
+		}
+		fields[f].shift = key_bits;
+		while((1U << fields[f].width) <= fields[f].values.size())
+		{
+			fields[f].width++;
+		}
+		key_bits += fields[f].width;
+	}
+	if(MAX_RULE_KEY_BITS < key_bits)
+	{
+		ERROR("%s: rules look at too many inputs (%u key bits)\n", path, key_bits);
+		return -1;
+	}
+
+	/*Condition value lists become masks over their field's codes.*/
+	for(unsigned int r = 0; r < rules.size(); r++)
+	{
+		for(unsigned int c = 0; c < rules[r].conditions.size(); c++)
+		{
+			const parsedCondition_t &condition = rules[r].conditions[c];
+			const ruleField_t &field = fields[rules[r].fields[c]];
+			uint16_t mask = 0;
+			for(unsigned int code = 0; code <= field.values.size(); code++)
+			{
+				int value = (0 == code) ? 0 : field.values[code - 1];
+				bool listed;
+				if(RULE_INPUT_ERROR == condition.input)
+				{
+					listed = (condition.values.end() != std::find(condition.values.begin(), condition.values.end(), (int)code));
+				}
+				else
+				{
+					listed = (0 != code) && (condition.values.end() != std::find(condition.values.begin(), condition.values.end(), value));
+				}
+				if(listed != condition.negate)
+				{
+					mask |= (1 << code);
+				}
+			}
+			rules[r].masks.push_back(mask);
+		}
+	}
+	std::stable_sort(rules.begin(), rules.end(), higher_priority);
+
+	/*For every key, the highest-priority matching rule of each indicator. Equal outcomes are shared.*/
+	unsigned int num_indicators = indicator_names.size();
+	std::vector <uint16_t> table(1U << key_bits, 0);
+	std::vector <ruleAction_t> outcomes;
+	std::map <std::vector <uint32_t>, uint16_t> outcome_ids;
+	std::vector <ruleAction_t> outcome(num_indicators);
+	std::vector <uint32_t> encoded(num_indicators);
+	for(unsigned int key = 0; key < table.size(); key++)
+	{
+		for(unsigned int i = 0; i < num_indicators; i++)
+		{
+			outcome[i].type = RULE_ACTION_NONE;
+			outcome[i].pattern = 0;
+			outcome[i].repetitions = 0;
+			for(unsigned int r = 0; r < rules.size(); r++)
+			{
+				if(i != rules[r].indicator)
+				{
+					continue;
+				}
+				bool match = true;
+				for(unsigned int c = 0; match && (c < rules[r].masks.size()); c++)
+				{
+					const ruleField_t &field = fields[rules[r].fields[c]];
+					unsigned int code = (key >> field.shift) & ((1U << field.width) - 1);
+					match = (0 != (rules[r].masks[c] & (1 << code)));
+				}
+				if(match)
+				{
+					outcome[i] = rules[r].action;
+					break;
+				}
+			}
+			encoded[i] = encode_action(outcome[i]);
+		}
+		std::map <std::vector <uint32_t>, uint16_t>::iterator it = outcome_ids.find(encoded);
+		if(outcome_ids.end() == it)
+		{
+			it = outcome_ids.insert(std::make_pair(encoded, (uint16_t)outcome_ids.size())).first;
+			outcomes.insert(outcomes.end(), outcome.begin(), outcome.end());
+		}
+		table[key] = it->second;
+	}
+
+	lock();
+	m_fields.swap(fields);
+	m_table.swap(table);
+	m_outcomes.swap(outcomes);
+	m_num_indicators = num_indicators;
+	m_num_rules = rules.size();
+	m_key = 0;
+	m_applied_outcome = RULE_NO_OUTCOME;
+	memset(m_applied, 0, sizeof(m_applied));
+	unlock();
+	INFO("Loaded %u rules from %s: %u key bits, %u distinct outcomes\n", m_num_rules, path, key_bits,
+		(unsigned int)outcome_ids.size());
+	return 0;
+}
+
+bool ruleTable::isLoaded() const
+{
+	return !m_table.empty();
+}
+
+/**
+ * @brief This API walks the inputs the loaded rules look at.
+ *
+ * @param[in] index	input to return, from 0.
+ * @param[out] input	kind of input.
+ * @param[out] id	error bit or sys-state ID, 0 for the other inputs.
+ *
+ * @return  Returns 0, or -1 past the last input.
+ */
+int ruleTable::getInput(unsigned int index, ruleInput_t &input, unsigned int &id) const
+{
+	if(m_fields.size() <= index)
+	{
+		return -1;
+	}
+	input = m_fields[index].input;
+	id = m_fields[index].id;
+	return 0;
+}
+
+void ruleTable::lock()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+}
+
+void ruleTable::unlock()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief This API updates one input of the state key. Inputs no rule looks at are ignored.
+ */
+void ruleTable::setInputLocked(ruleInput_t input, unsigned int id, int value)
+{
+	for(unsigned int f = 0; f < m_fields.size(); f++)
+	{
+		if((input == m_fields[f].input) && ((RULE_INPUT_POWER == input) || (RULE_INPUT_SYS_MODE == input) || (id == m_fields[f].id)))
+		{
+			setFieldLocked(m_fields[f], value);
+		}
+	}
+}
+
+void ruleTable::setErrorFlagsLocked(unsigned int error_flags)
+{
+	for(unsigned int f = 0; f < m_fields.size(); f++)
+	{
+		if(RULE_INPUT_ERROR == m_fields[f].input)
+		{
+			setFieldLocked(m_fields[f], (error_flags >> m_fields[f].id) & 0x01);
+		}
+	}
+}
+
+/**
+ * @brief This API looks the current state key up and reports what changed since the last call.
+ *
+ * @param[out] changes  m_num_indicators entries: the action to apply, or RULE_ACTION_NONE where the
+ * indicator's rule outcome is unchanged or left to the OEM hooks.
+ *
+ * @return  Returns true if any indicator needs an update.
+ */
+bool ruleTable::evaluateLocked(ruleAction_t *changes)
+{
+	if(m_table.empty())
+	{
+		return false;
+	}
+	uint16_t outcome = m_table[m_key];
+	if(outcome == m_applied_outcome)
+	{
+		return false;
+	}
+	m_applied_outcome = outcome;
+	bool changed = false;
+	const ruleAction_t *actions = &m_outcomes[outcome * m_num_indicators];
+	for(unsigned int i = 0; i < m_num_indicators; i++)
+	{
+		memset(&changes[i], 0, sizeof(changes[i]));
+		if(encode_action(actions[i]) != encode_action(m_applied[i]))
+		{
+			changes[i] = actions[i];
+			changed |= (RULE_ACTION_NONE != actions[i].type);
+		}
+		m_applied[i] = actions[i];
+	}
+	return changed;
+}
+
+void ruleTable::diagnostics()
+{
+	lock();
+	INFO("%u rules, %u inputs, %u table entries, %u outcomes, key 0x%x\n", m_num_rules, (unsigned int)m_fields.size(),
+		(unsigned int)m_table.size(), (0 == m_num_indicators) ? 0 : (unsigned int)(m_outcomes.size() / m_num_indicators), m_key);
+	unlock();
+}
+
+/** @} */  //END OF GROUP LED_APIS
+
+void ruleTable::setFieldLocked(ruleField_t &field, int value)
+{
+	unsigned int code = 0;
+	for(unsigned int v = 0; v < field.values.size(); v++)
+	{
+		if(value == field.values[v])
+		{
+			code = v + 1;
+			break;
+		}
+	}
+	unsigned int mask = ((1U << field.width) - 1) << field.shift;
+	m_key = (m_key & ~mask) | (code << field.shift);
+}
@@ -0,0 +1,108 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef RULES_H
+#define RULES_H
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "ledmgr_types.hpp"
+#include "pthread.h"
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+#define RULES_FILE_PATH "/etc/ledmgr.rules"
+#define MAX_RULE_KEY_BITS 12		/**< Decision table holds 1 << MAX_RULE_KEY_BITS entries at most */
+#define MAX_RULE_FIELD_VALUES 15	/**< Distinct values one input can be compared against */
+#define RULE_NO_OUTCOME 0xFFFF
+
+typedef enum
+{
+	RULE_INPUT_POWER = 0,	/**< pwrmgr power state */
+	RULE_INPUT_SYS_MODE,	/**< IARM system mode */
+	RULE_INPUT_ERROR,	/**< One bit of the error bitmap */
+	RULE_INPUT_SYSSTATE,	/**< Value of one sysmgr state */
+}ruleInput_t;
+
+typedef enum
+{
+	RULE_ACTION_NONE = 0,	/**< Leave the indicator to the OEM hooks */
+	RULE_ACTION_ON,
+	RULE_ACTION_OFF,
+	RULE_ACTION_BLINK,
+}ruleActionType_t;
+
+typedef struct
+{
+	uint8_t type;		/**< ruleActionType_t */
+	uint8_t pattern;	/**< blinkPatternType_t, for RULE_ACTION_BLINK */
+	int16_t repetitions;	/**< For RULE_ACTION_BLINK, -1 to loop */
+}ruleAction_t;
+
+/* @} */ // End of group LED_TYPES
+
+/*State-to-LED rules (see conf/ledmgr.rules), compiled into a flat decision table. Every input a rule
+ * looks at becomes a small bit field of a packed state key, holding the index of the input's value
+ * among those the rules compare against (0 for any other value). At load time the winning rule for each
+ * indicator is worked out for every possible key. The outcomes are deduplicated, and the table maps
+ * each key to one of them. At run time an input change repacks one field, and the new outcome is a
+ * single table lookup.*/
+class ruleTable
+{
+	private:
+		typedef struct
+		{
+			ruleInput_t input;
+			unsigned int id;		/**< Error bit or sys-state ID */
+			unsigned int shift;
+			unsigned int width;
+			std::vector <int> values;	/**< Code i + 1 stands for values[i] */
+		}ruleField_t;
+
+		pthread_mutex_t m_mutex;
+		std::vector <ruleField_t> m_fields;
+		unsigned int m_num_indicators;
+		unsigned int m_num_rules;
+		std::vector <uint16_t> m_table;		/**< Packed state key to outcome */
+		std::vector <ruleAction_t> m_outcomes;	/**< m_num_indicators actions per outcome */
+		unsigned int m_key;
+		uint16_t m_applied_outcome;
+		ruleAction_t m_applied[MAX_INDICATORS];
+
+		ruleTable(const ruleTable &);
+		ruleTable& operator=(const ruleTable &);
+
+	public:
+		ruleTable();
+		~ruleTable();
+		int load(const char *path, const std::vector <std::string> &indicator_names);
+		bool isLoaded() const;
+		int getInput(unsigned int index, ruleInput_t &input, unsigned int &id) const;
+		void lock();
+		void unlock();
+		void setInputLocked(ruleInput_t input, unsigned int id, int value);
+		void setErrorFlagsLocked(unsigned int error_flags);
+		bool evaluateLocked(ruleAction_t *changes);
+		void diagnostics();
+	private:
+		void setFieldLocked(ruleField_t &field, int value);
+};
+
+#endif /*RULES_H*/
@@ -0,0 +1,148 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ledmgr_types.hpp"
+#include "statuspage.hpp"
+
+static ledmgr_status_page_t *g_status_page = NULL;
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+/**
+ * @brief This API creates (or takes over) the world-readable status page described in ledmgr_status.h.
+ * Readers that mapped the page under a previous instance keep their mapping and see it come back to life.
+ *
+ * @return  Returns status of the operation.
+ */
+int open_status_page()
+{
+	if(NULL != g_status_page)
+	{
+		return 0;
+	}
+	int fd = shm_open(LEDMGR_STATUS_SHM_NAME, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	if(0 > fd)
+	{
+		ERROR("Could not open status page!\n");
+		return -1;
+	}
+	/*Don't let the umask take read access away from other components.*/
+	fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	if(0 != ftruncate(fd, sizeof(ledmgr_status_page_t)))
+	{
+		ERROR("Could not size status page!\n");
+		close(fd);
+		return -1;
+	}
+	void *mapping = mmap(NULL, sizeof(ledmgr_status_page_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(MAP_FAILED == mapping)
+	{
+		ERROR("Could not map status page!\n");
+		return -1;
+	}
+	g_status_page = (ledmgr_status_page_t *)mapping;
+
+	__atomic_store_n(&g_status_page->magic, 0, __ATOMIC_RELEASE);
+	__atomic_store_n(&g_status_page->num_indicators, 0, __ATOMIC_RELEASE);
+	/*A crashed instance may have left a sequence counter odd; start every record afresh.*/
+	memset(g_status_page->indicators, 0, sizeof(g_status_page->indicators));
+	g_status_page->sequence = 0;
+	g_status_page->error_flags = 0;
+	g_status_page->power_state = 0;
+	g_status_page->version = LEDMGR_STATUS_VERSION;
+	g_status_page->size = sizeof(ledmgr_status_page_t);
+	g_status_page->pid = getpid();
+	__atomic_store_n(&g_status_page->magic, LEDMGR_STATUS_MAGIC, __ATOMIC_RELEASE);
+	INFO("Publishing status page %s\n", LEDMGR_STATUS_SHM_NAME);
+	return 0;
+}
+
+/**
+ * @brief This API marks the status page as no longer live and unmaps it. The page itself stays, so that
+ * readers holding a mapping don't fault.
+ */
+void close_status_page()
+{
+	if(NULL != g_status_page)
+	{
+		__atomic_store_n(&g_status_page->magic, 0, __ATOMIC_RELEASE);
+		munmap(g_status_page, sizeof(ledmgr_status_page_t));
+		g_status_page = NULL;
+	}
+}
+
+/**
+ * @brief This API returns the mapped status page, or NULL if it is not being published.
+ */
+ledmgr_status_page_t * get_status_page()
+{
+	return g_status_page;
+}
+
+/**
+ * @brief This API appends a record for the named indicator.
+ *
+ * @return  Returns the record, or NULL if the page is not published or is full.
+ */
+ledmgr_status_indicator_t * claim_status_entry(const std::string &name)
+{
+	if(NULL == g_status_page)
+	{
+		return NULL;
+	}
+	uint32_t index = g_status_page->num_indicators;
+	if(LEDMGR_STATUS_MAX_INDICATORS <= index)
+	{
+		return NULL;
+	}
+	ledmgr_status_indicator_t *entry = &g_status_page->indicators[index];
+	begin_status_update(&entry->sequence);
+	memset(entry->name, 0, LEDMGR_STATUS_NAME_LENGTH);
+	strncpy(entry->name, name.c_str(), LEDMGR_STATUS_NAME_LENGTH - 1);
+	entry->state = STATE_STEADY_OFF;
+	entry->pattern_id = LEDMGR_STATUS_NO_PATTERN;
+	entry->color = LEDMGR_STATUS_NO_COLOR;
+	end_status_update(&entry->sequence);
+	__atomic_store_n(&g_status_page->num_indicators, index + 1, __ATOMIC_RELEASE);
+	return entry;
+}
+
+/**
+ * @brief Opens a seqlock write section. Each record has a single writer at a time (its owner's lock is held).
+ */
+void begin_status_update(uint32_t *sequence)
+{
+	__atomic_store_n(sequence, *sequence + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void end_status_update(uint32_t *sequence)
+{
+	__atomic_store_n(sequence, *sequence + 1, __ATOMIC_RELEASE);
+}
+
+/** @} */  //END OF GROUP LED_APIS
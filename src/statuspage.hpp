@@ -0,0 +1,31 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef STATUSPAGE_H
+#define STATUSPAGE_H
+#include <string>
+#include "ledmgr_status.h"
+
+int open_status_page();
+void close_status_page();
+ledmgr_status_page_t * get_status_page();
+ledmgr_status_indicator_t * claim_status_entry(const std::string &name);
+void begin_status_update(uint32_t *sequence);
+void end_status_update(uint32_t *sequence);
+
+#endif /*STATUSPAGE_H*/
@@ -0,0 +1,209 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <algorithm>
+#include "syncgroup.hpp"
+#include "indicator.hpp"
+#include "ledtiming.hpp"
+
+/**
+ * @addtogroup LED_APIS
+ * @{
+ */
+
+/**
+ * @brief Callback function fired on every keyframe edge of a sync group.
+ *
+ * @param[in] data      address of syncGroup class.
+ *
+ * @return  Returns false; the next edge registers its own callback.
+ */
+static gboolean masterSyncCallbackFunction(gpointer data)
+{
+	syncGroup *ptr = (syncGroup *)data;
+	DEBUG("Enter\n");
+	ptr->edgeCallback();
+	return false;
+}
+
+syncGroup::syncGroup(const std::string &name, const keyframePattern_t *pattern)
+{
+	m_name = name;
+	m_source_id = 0;
+	m_pattern = pattern;
+	m_origin_us = 0;
+	m_period_ms = 0;
+	for(unsigned int i = 0; i < pattern->num_keyframes; i++)
+	{
+		m_period_ms += pattern->keyframes[i].duration;
+	}
+	m_members.reserve(MAX_INDICATORS);	/*Joining on an event must not allocate*/
+
+	pthread_mutexattr_t mutex_attribute;
+	REPORT_IF_UNEQUAL(0, pthread_mutexattr_init(&mutex_attribute));
+	REPORT_IF_UNEQUAL(0, pthread_mutexattr_settype(&mutex_attribute, PTHREAD_MUTEX_RECURSIVE));
+	REPORT_IF_UNEQUAL(0, pthread_mutex_init(&m_mutex, &mutex_attribute));
+	INFO("Sync group %s created, period %u ms\n", m_name.c_str(), m_period_ms);
+}
+
+syncGroup::~syncGroup()
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_SYNCGROUP));
+	while(!m_members.empty())
+	{
+		leave(*m_members.back());
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	pthread_mutex_destroy(&m_mutex);
+}
+
+const std::string& syncGroup::getName() const
+{
+	return m_name;
+}
+
+const keyframePattern_t * syncGroup::getPattern() const
+{
+	return m_pattern;
+}
+
+/**
+ * @brief This API finds the keyframe the shared timeline is in at the given time.
+ *
+ * @param[in] now_us		CLOCK_MONOTONIC time.
+ * @param[out] remaining_ms	time left until the next edge, rounded up.
+ *
+ * @return  Returns the keyframe index.
+ */
+unsigned int syncGroup::getPosition(gint64 now_us, unsigned int &remaining_ms) const
+{
+	unsigned long long phase_us = (unsigned long long)(now_us - m_origin_us) % ((unsigned long long)m_period_ms * 1000);
+	unsigned long long edge_us = 0;
+	unsigned int offset;
+	for(offset = 0; offset < m_pattern->num_keyframes; offset++)
+	{
+		edge_us += (unsigned long long)m_pattern->keyframes[offset].duration * 1000;
+		if(phase_us < edge_us)
+		{
+			break;
+		}
+	}
+	remaining_ms = (unsigned int)((edge_us - phase_us + 999) / 1000);
+	return offset;
+}
+
+void syncGroup::scheduleEdge(unsigned int milliseconds)
+{
+	m_source_id = led_timeout_add(milliseconds, masterSyncCallbackFunction, (gpointer)this);
+	if(0 == m_source_id)
+	{
+		ERROR("Could not register callback!\n");
+	}
+}
+
+/**
+ * @brief This API adds an indicator to the group. The first member sets the timeline origin; later
+ * members pick up the pattern mid-phase.
+ *
+ * @param[in] member   indicator to synchronize.
+ *
+ * @return  Returns status of the operation.
+ */
+int syncGroup::join(indicator &member)
+{
+	if(0 == m_period_ms)
+	{
+		ERROR("Zero-length pattern!\n");
+		return -1;
+	}
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_SYNCGROUP));
+	if(m_members.end() == std::find(m_members.begin(), m_members.end(), &member))
+	{
+		gint64 now_us = led_timing_now_us();
+		if(m_members.empty())
+		{
+			m_origin_us = now_us;
+		}
+		m_members.push_back(&member);
+		member.enterSyncGroup(this);
+
+		unsigned int remaining_ms;
+		unsigned int offset = getPosition(now_us, remaining_ms);
+		member.applySyncedKeyframe(m_pattern, offset);
+		if(0 == m_source_id)
+		{
+			scheduleEdge(remaining_ms);
+		}
+		INFO("%s joined sync group %s at keyframe %u\n", member.getName().c_str(), m_name.c_str(), offset);
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return 0;
+}
+
+/**
+ * @brief This API removes an indicator from the group. The timer stops with the last member.
+ *
+ * @param[in] member   indicator to release. It keeps its current output.
+ */
+void syncGroup::leave(indicator &member)
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_SYNCGROUP));
+	std::vector <indicator *>::iterator iter = std::find(m_members.begin(), m_members.end(), &member);
+	if(m_members.end() != iter)
+	{
+		m_members.erase(iter);
+		member.exitSyncGroup(this);
+		if(m_members.empty() && (0 != m_source_id))
+		{
+			REPORT_IF_UNEQUAL(true, led_source_remove(m_source_id));
+			m_source_id = 0;
+		}
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+unsigned int syncGroup::getNumMembers()
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_SYNCGROUP));
+	unsigned int num_members = m_members.size();
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return num_members;
+}
+
+/**
+ * @brief This API applies the keyframe at the current position of the timeline to every member and
+ * schedules the next edge.
+ */
+void syncGroup::edgeCallback()
+{
+	REPORT_IF_UNEQUAL(0, LOCK_MUTEX(&m_mutex, LOCK_CLASS_SYNCGROUP));
+	m_source_id = 0;
+	if(!m_members.empty())
+	{
+		unsigned int remaining_ms;
+		unsigned int offset = getPosition(led_timing_now_us(), remaining_ms);
+		for(std::vector <indicator *>::iterator iter = m_members.begin(); iter != m_members.end(); iter++)
+		{
+			(*iter)->applySyncedKeyframe(m_pattern, offset);
+		}
+		scheduleEdge(remaining_ms);
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/** @} */  //END OF GROUP LED_APIS
@@ -0,0 +1,63 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef SYNCGROUP_H
+#define SYNCGROUP_H
+#include <string>
+#include <vector>
+#include "ledmgr_types.hpp"
+#include "pthread.h"
+#include "lockstats.hpp"
+#include "ledloop.hpp"
+
+class indicator;
+
+/*Named set of indicators that play one keyframe pattern from a shared timeline origin. A single
+ * timer fires once per keyframe edge for the whole group and recomputes the position from the
+ * origin, so members never drift apart. Eased keyframes are held at their start brightness.
+ *
+ * Lock order: syncGroup before indicator.*/
+class syncGroup
+{
+	private:
+		std::string m_name;
+		pthread_mutex_t m_mutex;
+		guint m_source_id;
+		const keyframePattern_t *m_pattern;
+		unsigned int m_period_ms;
+		gint64 m_origin_us;
+		std::vector <indicator *> m_members;
+
+		syncGroup(const syncGroup &);
+		syncGroup& operator=(const syncGroup &);
+
+	public:
+		syncGroup(const std::string &name, const keyframePattern_t *pattern);
+		~syncGroup();
+		const std::string& getName() const;
+		const keyframePattern_t * getPattern() const;
+		int join(indicator &member);
+		void leave(indicator &member);
+		unsigned int getNumMembers();
+		void edgeCallback();
+	private:
+		unsigned int getPosition(gint64 now_us, unsigned int &remaining_ms) const;
+		void scheduleEdge(unsigned int milliseconds);
+};
+
+#endif /*SYNCGROUP_H*/
@@ -0,0 +1,43 @@
+#!/bin/sh
+##########################################################################
+# If not stated otherwise in this file or this component's Licenses.txt
+# file the following copyright and licenses apply:
+#
+# Copyright 2016 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+# Reports the footprint of ledmgr builds: section sizes and file size of each binary given, then the
+# steady-state resident set of the running daemon, if any.
+#
+# Usage: footprint.sh <size-tool> <binary>...
+
+SIZE_TOOL=$1
+shift
+
+echo "== Binary size"
+for binary in "$@"; do
+	$SIZE_TOOL "$binary" | tail -n 1 | awk -v name="$binary" '{ printf "%-16s text %8d  data %6d  bss %6d  total %8d\n", name, $1, $2, $3, $4 }'
+	printf "%-16s file %8d bytes\n" "$binary" "$(wc -c < "$binary")"
+done
+
+echo "== Steady-state memory of the running ledmgr"
+pid=$(pidof ledmgr 2>/dev/null | cut -d ' ' -f 1)
+if [ -z "$pid" ]; then
+	echo "ledmgr is not running; start it and let it settle to measure RSS."
+	exit 0
+fi
+grep -E '^(VmRSS|VmHWM|RssAnon|RssFile|VmData)' /proc/$pid/status
+if [ -r /proc/$pid/smaps_rollup ]; then
+	grep -E '^(Pss|Private_Dirty):' /proc/$pid/smaps_rollup
+fi
@@ -0,0 +1,322 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/*Checks that the LED engine does not allocate once it is running. malloc and friends (and with them
+ * operator new) are interposed and counted. The tool cycles through blink stepping, flares, debounced
+ * gateway flaps, error transitions, power changes in and out of deep sleep and pattern RPCs. The first
+ * round warms up whatever is created on first use (stdio buffers, sync groups); from the second round on,
+ * every allocation is reported with a backtrace and fails the run.
+ *
+ * Usage: ledmgr_alloccheck [--indicator <name>] [--rounds <n>]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <execinfo.h>
+
+#include "sysMgr.h"
+#include "pwrMgr.h"
+#include "ledmgr_types.hpp"
+#include "ledmgr_ipc.h"
+#include "ledmgr.hpp"
+#include "ledtiming.hpp"
+#include "eventhandlers.hpp"
+#include "standin.hpp"
+
+#define STEP_MS 200
+#define MAX_REPORTED_ALLOCATIONS 4
+#define BACKTRACE_DEPTH 16
+
+extern "C"
+{
+void * __libc_malloc(size_t size);
+void * __libc_calloc(size_t count, size_t size);
+void * __libc_realloc(void *ptr, size_t size);
+void * __libc_memalign(size_t alignment, size_t size);
+}
+
+static volatile bool g_counting = false;
+static unsigned long g_allocations = 0;
+static unsigned long g_allocated_bytes = 0;
+static __thread bool g_in_hook = false;
+
+/*Counts an allocation made after the barrier, and shows where the first few came from.*/
+static void count_allocation(size_t size)
+{
+	if(!g_counting || g_in_hook)
+	{
+		return;
+	}
+	g_in_hook = true;
+	unsigned long count = __sync_add_and_fetch(&g_allocations, 1);
+	__sync_add_and_fetch(&g_allocated_bytes, size);
+	if(MAX_REPORTED_ALLOCATIONS >= count)
+	{
+		void *frames[BACKTRACE_DEPTH];
+		fprintf(stderr, "Allocation of %zu bytes in steady state:\n", size);	/*stderr is unbuffered*/
+		backtrace_symbols_fd(frames, backtrace(frames, BACKTRACE_DEPTH), fileno(stderr));
+	}
+	g_in_hook = false;
+}
+
+extern "C"
+{
+void * malloc(size_t size)
+{
+	count_allocation(size);
+	return __libc_malloc(size);
+}
+
+void * calloc(size_t count, size_t size)
+{
+	count_allocation(count * size);
+	return __libc_calloc(count, size);
+}
+
+void * realloc(void *ptr, size_t size)
+{
+	count_allocation(size);
+	return __libc_realloc(ptr, size);
+}
+
+void * memalign(size_t alignment, size_t size)
+{
+	count_allocation(size);
+	return __libc_memalign(alignment, size);
+}
+
+void * aligned_alloc(size_t alignment, size_t size)
+{
+	count_allocation(size);
+	return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+	count_allocation(size);
+	*ptr = __libc_memalign(alignment, size);
+	return (NULL != *ptr) ? 0 : ENOMEM;
+}
+}
+
+static const keyframe_t g_blink_keyframes[] = {
+	{100, KEYFRAME_ON, KEYFRAME_COLOR_KEEP, EASING_STEP},
+	{150, KEYFRAME_OFF, KEYFRAME_COLOR_KEEP, EASING_STEP},
+	{50, 40, KEYFRAME_COLOR_KEEP, EASING_LINEAR},
+	{100, KEYFRAME_OFF, KEYFRAME_COLOR_KEEP, EASING_STEP},
+};
+static const keyframePattern_t g_blink = {0xF1, 4, g_blink_keyframes, 0, NULL};
+
+typedef enum
+{
+	STEP_BLINK = 0,
+	STEP_FLARE,
+	STEP_GATEWAY_DOWN,
+	STEP_GATEWAY_FLAP,
+	STEP_GATEWAY_DOWN_AGAIN,
+	STEP_ERROR_SET,
+	STEP_PLAY_PATTERN,
+	STEP_ERROR_CLEAR,
+	STEP_STANDBY,
+	STEP_ON,
+	STEP_DEEP_SLEEP,
+	STEP_FLARE_ASLEEP,
+	STEP_WAKE_UP,
+	STEP_LOOKUP,
+	STEP_IDLE,
+	STEP_GATEWAY_UP = STEP_IDLE + 12,	/**< After the debounced disconnect has been delivered */
+	STEP_SETTLE,
+	NUM_STEPS = STEP_SETTLE + 24,		/**< Long enough for the reconnect to be delivered */
+}allocCheckStep_t;
+
+typedef struct
+{
+	ledWakeup_t *step_wakeup;
+	indicator *target;
+	const char *indicator_name;
+	unsigned int pattern_handle;
+	unsigned int rounds;
+	unsigned int round;
+	unsigned int step;
+}allocCheck_t;
+
+static void deliver_gateway(int state)
+{
+	IARM_Bus_SYSMgr_EventData_t event;
+	memset(&event, 0, sizeof(event));
+	event.data.systemStates.stateId = IARM_BUS_SYSMGR_SYSSTATE_GATEWAY_CONNECTION;
+	event.data.systemStates.state = state;
+	standin_bus_deliver(IARM_BUS_SYSMGR_NAME, IARM_BUS_SYSMGR_EVENT_SYSTEMSTATE, &event, sizeof(event));
+}
+
+static void deliver_power(int state)
+{
+	IARM_Bus_PWRMgr_EventData_t event;
+	memset(&event, 0, sizeof(event));
+	event.data.state.newState = (IARM_Bus_PowerState_t)state;
+	standin_bus_set_power_state(state);
+	standin_bus_deliver(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_EVENT_MODECHANGED, &event, sizeof(event));
+}
+
+static void run_step(allocCheck_t *check)
+{
+	ledMgr &mgr = ledMgr::getInstance();
+	switch(check->step)
+	{
+		case STEP_BLINK:
+		case STEP_IDLE:
+			check->target->setBlink(&g_blink);
+			break;
+		case STEP_FLARE:
+		case STEP_FLARE_ASLEEP:
+			check->target->executeFlare(20, 100);
+			break;
+		case STEP_GATEWAY_DOWN:
+		case STEP_GATEWAY_DOWN_AGAIN:
+			deliver_gateway(0);
+			break;
+		case STEP_GATEWAY_FLAP:
+		case STEP_GATEWAY_UP:
+			deliver_gateway(1);
+			break;
+		case STEP_ERROR_SET:
+		case STEP_ERROR_CLEAR:
+			mgr.setError(1, (STEP_ERROR_SET == check->step));
+			break;
+		case STEP_PLAY_PATTERN:
+		{
+			IARM_Bus_LEDMgr_PlayPattern_Param_t param;
+			memset(&param, 0, sizeof(param));
+			strncpy(param.indicator, check->indicator_name, sizeof(param.indicator));
+			param.handle = check->pattern_handle;
+			param.repetitions = 2;
+			standin_bus_call(IARM_BUS_LEDMGR_API_PlayPattern, &param);
+			break;
+		}
+		case STEP_STANDBY:
+			deliver_power(IARM_BUS_PWRMGR_POWERSTATE_STANDBY);
+			break;
+		case STEP_ON:
+		case STEP_WAKE_UP:
+			deliver_power(IARM_BUS_PWRMGR_POWERSTATE_ON);
+			break;
+		case STEP_DEEP_SLEEP:
+			deliver_power(IARM_BUS_PWRMGR_POWERSTATE_STANDBY_DEEP_SLEEP);
+			break;
+		case STEP_LOOKUP:
+			mgr.getIndicator(check->indicator_name).setState(STATE_STEADY_ON);
+			break;
+		default:
+			break;
+	}
+}
+
+static gboolean step_callback(gpointer data)
+{
+	allocCheck_t *check = (allocCheck_t *)data;
+	run_step(check);
+	if(NUM_STEPS == ++check->step)
+	{
+		check->step = 0;
+		if(0 == check->round++)
+		{
+			printf("Warm-up round done; counting allocations from here on\n");
+			g_counting = true;
+		}
+		else if(check->rounds == check->round)
+		{
+			g_counting = false;
+			led_loop_quit();
+			return G_SOURCE_CONTINUE;
+		}
+	}
+	led_wakeup_set(check->step_wakeup, led_monotonic_us() + (STEP_MS * 1000));
+	return G_SOURCE_CONTINUE;
+}
+
+int main(int argc, char *argv[])
+{
+	allocCheck_t check;
+	memset(&check, 0, sizeof(check));
+	check.indicator_name = "Power";
+	check.rounds = 3;
+	for(int i = 1; i < argc; i++)
+	{
+		if((0 == strcmp(argv[i], "--indicator")) && (i + 1 < argc))
+		{
+			check.indicator_name = argv[++i];
+		}
+		else if((0 == strcmp(argv[i], "--rounds")) && (i + 1 < argc))
+		{
+			check.rounds = strtoul(argv[++i], NULL, 10);
+		}
+		else
+		{
+			printf("Usage: %s [--indicator <name>] [--rounds <n>]\n", argv[0]);
+			return -1;
+		}
+	}
+	if(2 > check.rounds)
+	{
+		check.rounds = 2;	/*Warm-up plus at least one counted round*/
+	}
+
+	setlinebuf(stdout);
+	ledMgr &mgr = ledMgr::getInstance();
+	mgr.createBlinkPatterns();
+	check.target = mgr.findIndicator(check.indicator_name);
+	if(NULL == check.target)
+	{
+		printf("No indicator %s\n", check.indicator_name);
+		return -1;
+	}
+	if(0 != init_event_handlers())
+	{
+		ERROR("Error initializing event handlers!\n");
+		return -1;
+	}
+	if(0 != mgr.registerPattern(g_blink_keyframes, 2, NULL, 0, check.pattern_handle))
+	{
+		ERROR("Could not register a pattern!\n");
+		return -1;
+	}
+	deliver_power(IARM_BUS_PWRMGR_POWERSTATE_ON);
+
+	/*backtrace() loads its unwinder on first use; do that before counting.*/
+	void *frames[BACKTRACE_DEPTH];
+	backtrace(frames, BACKTRACE_DEPTH);
+
+	check.step_wakeup = led_wakeup_new(step_callback, &check);
+	led_wakeup_set(check.step_wakeup, led_monotonic_us() + (STEP_MS * 1000));
+	led_loop_run();
+
+	unsigned int raw_events = 0;
+	unsigned int delivered_events = 0;
+	mgr.getDebouncer().getCounters(IARM_BUS_SYSMGR_SYSSTATE_GATEWAY_CONNECTION, raw_events, delivered_events);
+	ledTimingStats_t stats;
+	get_led_timing_stats(stats);
+	printf("%u rounds of %u steps: %llu LED timer dispatches, %u gateway events (%u delivered)\n", check.rounds - 1,
+		(unsigned int)NUM_STEPS, stats.dispatched, raw_events, delivered_events);
+	printf("%lu allocations (%lu bytes) after the warm-up round - %s\n", g_allocations, g_allocated_bytes,
+		((0 == g_allocations) ? "PASS" : "FAIL"));
+
+	led_wakeup_free(check.step_wakeup);
+	term_event_handlers();
+	return ((0 == g_allocations) ? 0 : 1);
+}
@@ -0,0 +1,110 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/*Benchmarks the indicatorGroup frame engine at 24, 64 and 256 LEDs against a backend that only
+ * counts writes.
+ *
+ * Usage: ledmgr_groupbench [--frames <N>]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ledmgr_types.hpp"
+#include "indicatorgroup.hpp"
+
+class countingBackend : public ledBackend
+{
+	public:
+		int m_num_handles;
+		unsigned long long m_num_writes;
+
+		countingBackend() : m_num_handles(0), m_num_writes(0) {}
+		virtual int open(const std::string &name) { return m_num_handles++; }
+		virtual int setState(int handle, bool enable) { m_num_writes++; return 0; }
+		virtual int setBrightness(int handle, unsigned int intensity) { m_num_writes++; return 0; }
+		virtual int getBrightness(int handle, unsigned int &intensity) { intensity = 100; return 0; }
+		virtual int setColor(int handle, unsigned int color) { m_num_writes++; return 0; }
+		virtual int getColor(int handle, unsigned int &color) { color = 0; return 0; }
+};
+
+static unsigned long long now_ns()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((unsigned long long)now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+	static const unsigned int sizes[] = {24, 64, 256};
+	static const groupEffect_t effects[] = {GROUP_EFFECT_BREATHE, GROUP_EFFECT_SPIN, GROUP_EFFECT_CHASE};
+	static const char * const effect_names[] = {"solid", "breathe", "spin", "chase"};
+	unsigned int num_frames = 100000;
+
+	if((3 == argc) && (0 == strcmp(argv[1], "--frames")))
+	{
+		num_frames = strtoul(argv[2], NULL, 10);
+	}
+	if(0 == num_frames)
+	{
+		fprintf(stderr, "Usage: %s [--frames <N>]\n", argv[0]);
+		return -1;
+	}
+
+	/*Keep the engine's logging out of the measurement.*/
+	if(NULL == freopen("/dev/null", "w", stdout))
+	{
+		fprintf(stderr, "Could not silence stdout!\n");
+	}
+	fprintf(stderr, "%5s %-8s %14s %14s %12s %14s %14s\n", "LEDs", "effect", "render ns/frm", "frame ns/frm",
+			"ns/LED", "writes/frm", "wakeups/frm");
+	for(unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+	{
+		for(unsigned int e = 0; e < sizeof(effects) / sizeof(effects[0]); e++)
+		{
+			countingBackend backend;
+			indicatorGroup group("Bench", "Ring", sizes[s], backend);
+			/*1s period at 40ms frames, as in a typical spinner.*/
+			group.start(effects[e], 1000);
+			group.stop(true);
+
+			unsigned long long start = now_ns();
+			for(unsigned int f = 0; f < num_frames; f++)
+			{
+				group.renderFrame();
+			}
+			unsigned long long render_ns = now_ns() - start;
+
+			unsigned long long writes_before = backend.m_num_writes;
+			start = now_ns();
+			for(unsigned int f = 0; f < num_frames; f++)
+			{
+				group.tick();
+			}
+			unsigned long long frame_ns = now_ns() - start;
+
+			fprintf(stderr, "%5u %-8s %14.1f %14.1f %12.2f %14.2f %14u\n", sizes[s], effect_names[effects[e]],
+					(double)render_ns / num_frames, (double)frame_ns / num_frames,
+					(double)frame_ns / num_frames / sizes[s],
+					(double)(backend.m_num_writes - writes_before) / num_frames, 1);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,197 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/*Measures blink edge jitter: how late LED timers fire against their deadlines, as p50/p99/max, first
+ * with timing on the main loop and then on the real-time timing thread. Patterns play on four indicators
+ * while threads at normal priority burn every CPU and churn memory.
+ *
+ * Usage: ledmgr_jitter [--seconds <N>] [--priority <P>] [--no-load]
+ *
+ * The real-time pass needs CAP_SYS_NICE (run as root); without it only the main loop pass is reported.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include <glib.h>
+#include "pthread.h"
+
+#include "ledmgr_types.hpp"
+#include "indicator.hpp"
+#include "ledtiming.hpp"
+
+#define NUM_LEDS 4
+#define CHURN_BLOCK_SIZE (64 * 1024 * 1024)
+
+class nullBackend : public ledBackend
+{
+	public:
+		int m_num_handles;
+
+		nullBackend() : m_num_handles(0) {}
+		virtual int open(const std::string &name) { return m_num_handles++; }
+		virtual int setState(int handle, bool enable) { return 0; }
+		virtual int setBrightness(int handle, unsigned int intensity) { return 0; }
+		virtual int getBrightness(int handle, unsigned int &intensity) { intensity = 100; return 0; }
+		virtual int setColor(int handle, unsigned int color) { return 0; }
+		virtual int getColor(int handle, unsigned int &color) { color = 0; return 0; }
+};
+
+static blinkOp_t g_fast_ops[] = {{50, true}, {50, false}};
+static blinkOp_t g_uneven_ops[] = {{30, true}, {70, false}};
+static blinkOp_t g_double_ops[] = {{20, true}, {60, false}, {20, true}, {300, false}};
+static blinkOp_t g_slow_ops[] = {{250, true}, {250, false}};
+static const blinkPattern_t g_patterns[NUM_LEDS] = {
+	{0, 2, g_fast_ops},
+	{1, 2, g_uneven_ops},
+	{2, 4, g_double_ops},
+	{3, 2, g_slow_ops},
+};
+
+static volatile bool g_loaded = false;
+
+static void * cpu_load_thread(void *context)
+{
+	while(g_loaded)
+	{
+	}
+	return NULL;
+}
+
+static void * memory_load_thread(void *context)
+{
+	long page_size = sysconf(_SC_PAGESIZE);
+	while(g_loaded)
+	{
+		char *block = (char *)malloc(CHURN_BLOCK_SIZE);
+		if(NULL == block)
+		{
+			usleep(10000);
+			continue;
+		}
+		for(long i = 0; i < CHURN_BLOCK_SIZE; i += page_size)
+		{
+			block[i] = (char)i;
+		}
+		free(block);
+	}
+	return NULL;
+}
+
+static gboolean quit_callback(gpointer data)
+{
+	g_main_loop_quit((GMainLoop *)data);
+	return false;
+}
+
+static void run_pass(const char *label, std::vector <indicator *> &leds, unsigned int seconds)
+{
+	reset_led_timing_stats();
+	for(unsigned int i = 0; i < leds.size(); i++)
+	{
+		leds[i]->setBlink(&g_patterns[i]);
+	}
+	GMainLoop *main_loop = g_main_loop_new(NULL, false);
+	g_timeout_add(seconds * 1000, quit_callback, main_loop);
+	g_main_loop_run(main_loop);
+	g_main_loop_unref(main_loop);
+	for(unsigned int i = 0; i < leds.size(); i++)
+	{
+		leds[i]->setState(STATE_STEADY_OFF);
+	}
+
+	ledTimingStats_t stats;
+	get_led_timing_stats(stats);
+	printf("%-16s %10llu %10u %10u %10u\n", label, stats.dispatched, stats.p50_us, stats.p99_us, stats.max_us);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int seconds = 10;
+	int priority = DEFAULT_RT_TIMING_PRIORITY;
+	bool load = true;
+	for(int i = 1; i < argc; i++)
+	{
+		if((0 == strcmp(argv[i], "--seconds")) && (i + 1 < argc))
+		{
+			seconds = strtoul(argv[++i], NULL, 10);
+		}
+		else if((0 == strcmp(argv[i], "--priority")) && (i + 1 < argc))
+		{
+			priority = strtol(argv[++i], NULL, 10);
+		}
+		else if(0 == strcmp(argv[i], "--no-load"))
+		{
+			load = false;
+		}
+		else
+		{
+			printf("Usage: %s [--seconds <N>] [--priority <P>] [--no-load]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	nullBackend backend;
+	std::vector <indicator *> leds;
+	for(unsigned int i = 0; i < NUM_LEDS; i++)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "Led%u", i);
+		leds.push_back(new indicator(name, backend));
+	}
+
+	std::vector <pthread_t> load_threads;
+	if(load)
+	{
+		g_loaded = true;
+		long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		for(long i = 0; i < (2 * num_cpus) + 1; i++)
+		{
+			pthread_t thread;
+			if(0 == pthread_create(&thread, NULL, (0 == i) ? memory_load_thread : cpu_load_thread, NULL))
+			{
+				load_threads.push_back(thread);
+			}
+		}
+	}
+
+	printf("%s, %u s per pass\n", (load ? "CPU and memory load" : "no load"), seconds);
+	printf("%-16s %10s %10s %10s %10s\n", "timing", "edges", "p50 us", "p99 us", "max us");
+	run_pass("main loop", leds, seconds);
+	if(0 == start_rt_timing(priority))
+	{
+		run_pass("real-time", leds, seconds);
+		stop_rt_timing();
+	}
+	else
+	{
+		printf("%-16s unavailable (needs CAP_SYS_NICE)\n", "real-time");
+	}
+
+	g_loaded = false;
+	for(unsigned int i = 0; i < load_threads.size(); i++)
+	{
+		pthread_join(load_threads[i], NULL);
+	}
+	for(unsigned int i = 0; i < leds.size(); i++)
+	{
+		delete leds[i];
+	}
+	return 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/*Compares the two main loop backends on one scenario: eight indicators blinking as fast as the LED
+ * engine lets them, with no other work. Built twice, as ledmgr_loopbench_glib and ledmgr_loopbench_epoll
+ * (see tools/loopcompare.sh), it reports:
+ *  - startup: from --started-ns (the caller's CLOCK_REALTIME just before exec) or else from main(), to
+ *    the first callback the loop dispatches, so that loading the loop's libraries counts,
+ *  - the resident set after the run,
+ *  - CPU time (user plus system) per blink edge dispatched.
+ *
+ * Usage: ledmgr_loopbench [--seconds <N>] [--started-ns <ns>] [--header]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <vector>
+
+#include "ledmgr_types.hpp"
+#include "indicator.hpp"
+#include "ledloop.hpp"
+#include "ledtiming.hpp"
+
+#define NUM_LEDS 8
+
+#ifdef LEDMGR_EPOLL_LOOP
+#define LOOP_NAME "epoll"
+#else
+#define LOOP_NAME "glib"
+#endif
+
+class nullBackend : public ledBackend
+{
+	public:
+		int m_num_handles;
+
+		nullBackend() : m_num_handles(0) {}
+		virtual int open(const std::string &name) { return m_num_handles++; }
+		virtual int setState(int handle, bool enable) { return 0; }
+		virtual int setBrightness(int handle, unsigned int intensity) { return 0; }
+		virtual int getBrightness(int handle, unsigned int &intensity) { intensity = 100; return 0; }
+		virtual int setColor(int handle, unsigned int color) { return 0; }
+		virtual int getColor(int handle, unsigned int &color) { color = 0; return 0; }
+};
+
+static blinkOp_t g_fast_ops[] = {{10, true}, {10, false}};
+static blinkOp_t g_uneven_ops[] = {{7, true}, {13, false}};
+static blinkOp_t g_double_ops[] = {{5, true}, {15, false}, {5, true}, {25, false}};
+static blinkOp_t g_slow_ops[] = {{50, true}, {50, false}};
+static const blinkPattern_t g_patterns[] = {
+	{0, 2, g_fast_ops},
+	{1, 2, g_uneven_ops},
+	{2, 4, g_double_ops},
+	{3, 2, g_slow_ops},
+};
+
+static uint64_t g_started_ns = 0;
+static uint64_t g_ready_ns = 0;
+
+static uint64_t get_realtime_ns()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	return ((uint64_t)now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+
+static uint64_t get_cpu_us()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return ((uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ULL) +
+		usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+/*Resident set in kB, current and peak.*/
+static void get_rss(unsigned long &rss_kb, unsigned long &peak_kb)
+{
+	rss_kb = peak_kb = 0;
+	FILE *status = fopen("/proc/self/status", "r");
+	if(NULL == status)
+	{
+		return;
+	}
+	char line[128];
+	while(NULL != fgets(line, sizeof(line), status))
+	{
+		sscanf(line, "VmRSS: %lu", &rss_kb);
+		sscanf(line, "VmHWM: %lu", &peak_kb);
+	}
+	fclose(status);
+}
+
+static gboolean ready_callback(gpointer data)
+{
+	g_ready_ns = get_realtime_ns();
+	return FALSE;
+}
+
+static gboolean quit_callback(gpointer data)
+{
+	led_loop_quit();
+	return FALSE;
+}
+
+int main(int argc, char *argv[])
+{
+	uint64_t main_ns = get_realtime_ns();
+	unsigned int seconds = 10;
+	bool header = false;
+	for(int i = 1; i < argc; i++)
+	{
+		if((0 == strcmp(argv[i], "--seconds")) && (i + 1 < argc))
+		{
+			seconds = strtoul(argv[++i], NULL, 10);
+		}
+		else if((0 == strcmp(argv[i], "--started-ns")) && (i + 1 < argc))
+		{
+			g_started_ns = strtoull(argv[++i], NULL, 10);
+		}
+		else if(0 == strcmp(argv[i], "--header"))
+		{
+			header = true;
+		}
+		else
+		{
+			printf("Usage: %s [--seconds <N>] [--started-ns <ns>] [--header]\n", argv[0]);
+			return 1;
+		}
+	}
+	if(0 == g_started_ns)
+	{
+		g_started_ns = main_ns;
+	}
+
+	nullBackend backend;
+	std::vector <indicator *> leds;
+	for(unsigned int i = 0; i < NUM_LEDS; i++)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "Led%u", i);
+		leds.push_back(new indicator(name, backend));
+	}
+	led_timeout_add(0, ready_callback, NULL);
+	led_timeout_add(seconds * 1000, quit_callback, NULL);
+	for(unsigned int i = 0; i < leds.size(); i++)
+	{
+		leds[i]->setBlink(&g_patterns[i % (sizeof(g_patterns) / sizeof(g_patterns[0]))]);
+	}
+	reset_led_timing_stats();
+	uint64_t cpu_before_us = get_cpu_us();
+	led_loop_run();
+	uint64_t cpu_us = get_cpu_us() - cpu_before_us;
+	for(unsigned int i = 0; i < leds.size(); i++)
+	{
+		leds[i]->setState(STATE_STEADY_OFF);
+	}
+
+	ledTimingStats_t stats;
+	get_led_timing_stats(stats);
+	unsigned long rss_kb = 0;
+	unsigned long peak_kb = 0;
+	get_rss(rss_kb, peak_kb);
+	if(header)
+	{
+		printf("%-8s %12s %10s %10s %10s %12s %10s\n", "loop", "startup us", "RSS kB", "peak kB", "edges", "CPU ms", "ns/edge");
+	}
+	printf("%-8s %12llu %10lu %10lu %10llu %12.1f %10llu\n", LOOP_NAME, (unsigned long long)((g_ready_ns - g_started_ns) / 1000),
+		rss_kb, peak_kb, stats.dispatched, cpu_us / 1000.0,
+		(0 != stats.dispatched) ? (unsigned long long)((cpu_us * 1000) / stats.dispatched) : 0ULL);
+
+	for(unsigned int i = 0; i < leds.size(); i++)
+	{
+		delete leds[i];
+	}
+	return 0;
+}
@@ -0,0 +1,209 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/*Feeds a log captured with "ledmgr --record <file>" back into the daemon's event handlers against
+ * the stand-in bus and front panel, then reports the resulting LED timeline and handler throughput.
+ *
+ * Usage: ledmgr_replay <log> [--speed <N> | --max] [--linger <ms>] [--no-timeline]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <glib.h>
+#include <pthread.h>
+
+#include "libIBusDaemon.h"
+#include "pwrMgr.h"
+#include "ledmgr_types.hpp"
+#include "ledmgr.hpp"
+#include "eventhandlers.hpp"
+#include "eventrecorder.hpp"
+#include "standin.hpp"
+
+typedef struct
+{
+	const char *path;
+	double speed;		/**< 0 replays as fast as possible */
+	unsigned int linger_ms;
+	GMainLoop *main_loop;
+
+	unsigned long long num_events;
+	unsigned long long num_delivered;
+	unsigned long long handler_time_us;
+	unsigned long long max_handler_time_us;
+	uint64_t start_us;
+	uint64_t end_us;
+	int result;
+}replayContext_t;
+
+static void sleep_until_us(uint64_t deadline_us)
+{
+	struct timespec deadline;
+	deadline.tv_sec = deadline_us / 1000000;
+	deadline.tv_nsec = (deadline_us % 1000000) * 1000;
+	while(0 != clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL));
+}
+
+static void* replay_thread(void *arg)
+{
+	replayContext_t *ctx = (replayContext_t *)arg;
+	static unsigned char payload[EVENT_LOG_MAX_PAYLOAD];
+	eventLogRecord_t record;
+	uint64_t first_us = 0;
+	int status;
+
+	FILE *log = fopen(ctx->path, "rb");
+	if((NULL == log) || (0 != open_event_log(log)))
+	{
+		ERROR("Could not open %s!\n", ctx->path);
+		ctx->result = -1;
+		if(NULL != log)
+		{
+			fclose(log);
+		}
+		g_main_loop_quit(ctx->main_loop);
+		return NULL;
+	}
+
+	ctx->start_us = get_monotonic_time_us();
+	while(1 == (status = read_event_log(log, &record, payload, sizeof(payload))))
+	{
+		if(0 == ctx->num_events)
+		{
+			first_us = record.timestamp_us;
+		}
+		if(0 < ctx->speed)
+		{
+			sleep_until_us(ctx->start_us + (uint64_t)((record.timestamp_us - first_us) / ctx->speed));
+		}
+
+		uint64_t before_us = get_monotonic_time_us();
+		int delivered;
+		if(EVENT_SOURCE_SYSMODE == record.source)
+		{
+			delivered = (0 == standin_bus_call(IARM_BUS_COMMON_API_SysModeChange, payload) ? 1 : 0);
+		}
+		else
+		{
+			delivered = standin_bus_deliver(get_event_source_owner((eventSource_t)record.source), record.event_id, payload, record.length);
+		}
+		uint64_t elapsed_us = get_monotonic_time_us() - before_us;
+
+		ctx->num_events++;
+		ctx->num_delivered += delivered;
+		ctx->handler_time_us += elapsed_us;
+		if(elapsed_us > ctx->max_handler_time_us)
+		{
+			ctx->max_handler_time_us = elapsed_us;
+		}
+	}
+	ctx->end_us = get_monotonic_time_us();
+	ctx->result = (0 == status ? 0 : -1);
+	fclose(log);
+
+	/*Let patterns started by the last events play out before stopping.*/
+	sleep_until_us(ctx->end_us + ((uint64_t)ctx->linger_ms * 1000));
+	g_main_loop_quit(ctx->main_loop);
+	return NULL;
+}
+
+static void usage(const char *name)
+{
+	printf("Usage: %s <log> [--speed <N> | --max] [--linger <ms>] [--no-timeline]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+	replayContext_t ctx;
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.speed = 1.0;
+	ctx.linger_ms = 2000;
+	bool print_timeline = true;
+
+	if(2 > argc)
+	{
+		usage(argv[0]);
+		return -1;
+	}
+	ctx.path = argv[1];
+	for(int i = 2; i < argc; i++)
+	{
+		if((0 == strcmp(argv[i], "--speed")) && (i + 1 < argc))
+		{
+			ctx.speed = strtod(argv[++i], NULL);
+		}
+		else if(0 == strcmp(argv[i], "--max"))
+		{
+			ctx.speed = 0;
+		}
+		else if((0 == strcmp(argv[i], "--linger")) && (i + 1 < argc))
+		{
+			ctx.linger_ms = strtoul(argv[++i], NULL, 10);
+		}
+		else if(0 == strcmp(argv[i], "--no-timeline"))
+		{
+			print_timeline = false;
+		}
+		else
+		{
+			usage(argv[0]);
+			return -1;
+		}
+	}
+
+	setlinebuf(stdout);
+	getStandinBackend().recordTimeline(print_timeline);
+	ledMgr::getInstance().createBlinkPatterns();
+	if(0 != init_event_handlers())
+	{
+		ERROR("Error initializing event handlers!\n");
+		return -1;
+	}
+
+	ctx.main_loop = g_main_loop_new(NULL, false);
+	pthread_t thread;
+	if(0 != pthread_create(&thread, NULL, replay_thread, &ctx))
+	{
+		ERROR("Could not launch replay thread.\n");
+		return -1;
+	}
+	g_main_loop_run(ctx.main_loop);
+	pthread_join(thread, NULL);
+	g_main_loop_unref(ctx.main_loop);
+	term_event_handlers();
+
+	if(print_timeline)
+	{
+		getStandinBackend().printTimeline(stdout, ctx.start_us);
+	}
+	uint64_t wall_us = (ctx.end_us > ctx.start_us ? ctx.end_us - ctx.start_us : 0);
+	printf("Replayed %llu events (%llu delivered, %llu not subscribed) in %.3f s\n", ctx.num_events, ctx.num_delivered,
+			ctx.num_events - ctx.num_delivered, wall_us / 1e6);
+	if(0 != ctx.num_events)
+	{
+		printf("Handler time: total %llu us, avg %.2f us, max %llu us\n", ctx.handler_time_us,
+				(double)ctx.handler_time_us / ctx.num_events, ctx.max_handler_time_us);
+		if(0 != ctx.handler_time_us)
+		{
+			printf("Handler throughput: %.0f events/s\n", ctx.num_events * 1e6 / ctx.handler_time_us);
+		}
+	}
+	printf("LED writes: %llu\n", getStandinBackend().getWriteCount());
+	return ctx.result;
+}
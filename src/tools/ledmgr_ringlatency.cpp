@@ -0,0 +1,175 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/*End-to-end latency of the command ring against the equivalent IARM call, measured on a running ledmgr.
+ * Both paths start the same registered pattern on the same indicator; a sample covers submission up to
+ * the point where ledmgr has run the command (the IARM call returning, or the ring's tail passing it).
+ * The indicator's state is pushed before and popped after the run.
+ *
+ * Usage: ledmgr_ringlatency [--indicator <name>] [--iterations <N>]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <vector>
+#include <algorithm>
+
+#include "libIBus.h"
+#include "ledmgr_ipc.h"
+#include "ledmgr_ring.h"
+
+static unsigned long long now_ns()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((unsigned long long)now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+
+static void report(const char *path, std::vector <unsigned int> &latency_ns)
+{
+	if(latency_ns.empty())
+	{
+		printf("%-6s no samples\n", path);
+		return;
+	}
+	std::sort(latency_ns.begin(), latency_ns.end());
+	size_t n = latency_ns.size();
+	printf("%-6s samples %6zu  min %8.1f us  p50 %8.1f us  p99 %8.1f us  max %8.1f us\n", path, n,
+		latency_ns[0] / 1000.0, latency_ns[n / 2] / 1000.0, latency_ns[(n * 99) / 100] / 1000.0,
+		latency_ns[n - 1] / 1000.0);
+}
+
+/*Submits one command and waits until ledmgr has run it. Returns -1 if the ring stayed full.*/
+static int ring_submit_and_wait(ledmgr_ring_client_t *client, uint16_t opcode, uint16_t led, int32_t arg0, int32_t arg1)
+{
+	ledmgr_ring_command_t *command = ledmgr_ring_reserve(client);
+	if(NULL == command)
+	{
+		return -1;
+	}
+	command->opcode = opcode;
+	command->indicator = led;
+	command->arg0 = arg0;
+	command->arg1 = arg1;
+	uint32_t sequence = ledmgr_ring_commit(client);
+	while(!ledmgr_ring_is_consumed(client->ring, sequence))
+	{
+		sched_yield();
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *indicator_name = "Power";
+	unsigned int iterations = 1000;
+	for(int i = 1; i < argc; i++)
+	{
+		if((0 == strcmp(argv[i], "--indicator")) && (i + 1 < argc))
+		{
+			indicator_name = argv[++i];
+		}
+		else if((0 == strcmp(argv[i], "--iterations")) && (i + 1 < argc))
+		{
+			iterations = strtoul(argv[++i], NULL, 10);
+		}
+		else
+		{
+			printf("Usage: %s [--indicator <name>] [--iterations <N>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if((IARM_RESULT_SUCCESS != IARM_Bus_Init("ledmgr_ringlatency")) || (IARM_RESULT_SUCCESS != IARM_Bus_Connect()))
+	{
+		printf("Could not connect to the IARM bus\n");
+		return 1;
+	}
+	ledmgr_ring_client_t client;
+	if(0 != ledmgr_ring_connect(&client))
+	{
+		printf("ledmgr is not accepting command ring clients\n");
+		return 1;
+	}
+	int led = ledmgr_ring_find_indicator(client.ring, indicator_name);
+	if(0 > led)
+	{
+		printf("No indicator %s\n", indicator_name);
+		return 1;
+	}
+
+	IARM_Bus_LEDMgr_RegisterPattern_Param_t reg;
+	memset(&reg, 0, sizeof(reg));
+	reg.num_keyframes = 2;
+	reg.keyframes[0].duration = 500;
+	reg.keyframes[0].brightness = LEDMGR_KEYFRAME_ON;
+	reg.keyframes[1].duration = 500;
+	reg.keyframes[1].brightness = LEDMGR_KEYFRAME_OFF;
+	if((IARM_RESULT_SUCCESS != IARM_Bus_Call(IARM_BUS_LEDMGR_NAME, IARM_BUS_LEDMGR_API_RegisterPattern, &reg, sizeof(reg))) ||
+		(0 != reg.result))
+	{
+		printf("Could not register the test pattern\n");
+		return 1;
+	}
+
+	std::vector <unsigned int> ring_ns, iarm_ns;
+	ring_ns.reserve(iterations);
+	iarm_ns.reserve(iterations);
+	ring_submit_and_wait(&client, LEDMGR_RING_PUSH_LAYER, led, 0, 0);
+	for(unsigned int i = 0; i < iterations; i++)
+	{
+		unsigned long long start = now_ns();
+		if(0 == ring_submit_and_wait(&client, LEDMGR_RING_START_CUSTOM_PATTERN, led, reg.handle, -1))
+		{
+			ring_ns.push_back(now_ns() - start);
+		}
+
+		IARM_Bus_LEDMgr_PlayPattern_Param_t play;
+		memset(&play, 0, sizeof(play));
+		strncpy(play.indicator, indicator_name, LEDMGR_INDICATOR_NAME_LENGTH - 1);
+		play.handle = reg.handle;
+		play.repetitions = -1;
+		start = now_ns();
+		if(IARM_RESULT_SUCCESS == IARM_Bus_Call(IARM_BUS_LEDMGR_NAME, IARM_BUS_LEDMGR_API_PlayPattern, &play, sizeof(play)))
+		{
+			iarm_ns.push_back(now_ns() - start);
+		}
+	}
+	ring_submit_and_wait(&client, LEDMGR_RING_POP_LAYER, led, 0, 0);
+
+	IARM_Bus_LEDMgr_ReleasePattern_Param_t release;
+	release.handle = reg.handle;
+	IARM_Bus_Call(IARM_BUS_LEDMGR_NAME, IARM_BUS_LEDMGR_API_ReleasePattern, &release, sizeof(release));
+
+	printf("Starting a pattern on %s, %u iterations\n", indicator_name, iterations);
+	report("ring", ring_ns);
+	report("iarm", iarm_ns);
+	if(!ring_ns.empty() && !iarm_ns.empty())
+	{
+		printf("ring p50 is %.1fx faster\n", (double)iarm_ns[iarm_ns.size() / 2] / ring_ns[ring_ns.size() / 2]);
+	}
+	printf("ring counters: completed %u rejected %u overflows %u\n", client.ring->completed, client.ring->rejected,
+		client.ring->overflows);
+
+	ledmgr_ring_disconnect(&client);
+	IARM_Bus_Disconnect();
+	IARM_Bus_Term();
+	return 0;
+}
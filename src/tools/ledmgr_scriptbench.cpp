@@ -0,0 +1,300 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/*Memory per running LED script against the equivalent hand-written state machine. Each plays "blink N
+ * times, hold, then fade with the download progress" on its own indicator. Both are driven by the same
+ * progress events, and both must produce the same number of backend writes.
+ *
+ * Usage: ledmgr_scriptbench [--pairs <N>]
+ *
+ * Needs a tree configured with --enable-coroutines.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include <glib.h>
+
+#include "ledmgr_types.hpp"
+#include "indicator.hpp"
+
+#ifndef LEDMGR_COROUTINES
+#error "ledmgr_scriptbench needs a tree configured with --enable-coroutines"
+#endif
+
+#define BLINKS 3
+#define BLINK_MS 200
+#define HOLD_MS 1000
+#define FADE_STEP 5		/**< Brightness per fade step */
+#define FADE_STEP_MS 40
+#define PROGRESS_INTERVAL_MS 500
+#define MAX_PAIRS (MAX_LED_SCRIPTS)
+
+class countingBackend : public ledBackend
+{
+	public:
+		int m_num_handles;
+		unsigned long long m_num_writes[2 * MAX_PAIRS];
+
+		countingBackend() : m_num_handles(0) { memset(m_num_writes, 0, sizeof(m_num_writes)); }
+		virtual int open(const std::string &name) { return m_num_handles++; }
+		virtual int setState(int handle, bool enable) { m_num_writes[handle]++; return 0; }
+		virtual int setBrightness(int handle, unsigned int intensity) { m_num_writes[handle]++; return 0; }
+		virtual int getBrightness(int handle, unsigned int &intensity) { intensity = 100; return 0; }
+		virtual int setColor(int handle, unsigned int color) { m_num_writes[handle]++; return 0; }
+		virtual int getColor(int handle, unsigned int &color) { color = 0; return 0; }
+};
+
+static unsigned int fade_target(int percent)
+{
+	return 100 - ((percent * 90) / 100);
+}
+
+static ledScript downloadScript(indicator &led, scriptEvent &progress, bool &done)
+{
+	for(unsigned int i = 0; i < BLINKS; i++)
+	{
+		led.driveLevel(KEYFRAME_ON);
+		co_await scriptSleep(BLINK_MS);
+		led.driveLevel(KEYFRAME_OFF);
+		co_await scriptSleep(BLINK_MS);
+	}
+	led.driveLevel(100);
+	co_await scriptSleep(HOLD_MS);
+
+	unsigned int level = 100;
+	int percent = 0;
+	while(100 > percent)
+	{
+		percent = co_await progress;
+		unsigned int target = fade_target(percent);
+		while(level > target)
+		{
+			level = std::max(target, level - FADE_STEP);
+			led.driveLevel(level);
+			co_await scriptSleep(FADE_STEP_MS);
+		}
+	}
+	led.driveLevel(KEYFRAME_OFF);
+	done = true;
+}
+
+/*The same behaviour, written the way it had to be before scripts.*/
+class downloadMachine
+{
+	private:
+		typedef enum
+		{
+			PHASE_BLINK_ON = 0,
+			PHASE_BLINK_OFF,
+			PHASE_HOLD,
+			PHASE_WAIT_PROGRESS,
+			PHASE_FADE,
+			PHASE_DONE,
+		}phase_t;
+
+		indicator &m_led;
+		phase_t m_phase;
+		unsigned int m_blinks_left;
+		unsigned int m_level;
+		unsigned int m_target;
+		int m_percent;
+		guint m_source_id;
+
+		static gboolean timerCallback(gpointer data)
+		{
+			((downloadMachine *)data)->step();
+			return false;
+		}
+
+		void wait(unsigned int milliseconds)
+		{
+			m_source_id = g_timeout_add(milliseconds, timerCallback, this);
+		}
+
+	public:
+		downloadMachine(indicator &led) : m_led(led), m_phase(PHASE_BLINK_ON), m_blinks_left(BLINKS), m_level(100),
+			m_target(100), m_percent(0), m_source_id(0) {}
+
+		void start()
+		{
+			m_led.setState(STATE_STEADY_OFF);
+			step();
+		}
+
+		bool isDone() const
+		{
+			return (PHASE_DONE == m_phase);
+		}
+
+		void step()
+		{
+			m_source_id = 0;
+			switch(m_phase)
+			{
+				case PHASE_BLINK_ON:
+					m_led.driveLevel(KEYFRAME_ON);
+					m_phase = PHASE_BLINK_OFF;
+					wait(BLINK_MS);
+					break;
+				case PHASE_BLINK_OFF:
+					m_led.driveLevel(KEYFRAME_OFF);
+					m_phase = (0 == --m_blinks_left) ? PHASE_HOLD : PHASE_BLINK_ON;
+					wait(BLINK_MS);
+					break;
+				case PHASE_HOLD:
+					m_led.driveLevel(100);
+					m_phase = PHASE_WAIT_PROGRESS;
+					wait(HOLD_MS);
+					break;
+				case PHASE_FADE:
+					if(m_level > m_target)
+					{
+						m_level = std::max(m_target, m_level - FADE_STEP);
+						m_led.driveLevel(m_level);
+						wait(FADE_STEP_MS);
+						break;
+					}
+					if(100 <= m_percent)
+					{
+						m_led.driveLevel(KEYFRAME_OFF);
+						m_phase = PHASE_DONE;
+						break;
+					}
+					m_phase = PHASE_WAIT_PROGRESS;
+					break;
+				default:
+					break;
+			}
+		}
+
+		void onProgress(int percent)
+		{
+			if((PHASE_WAIT_PROGRESS != m_phase) || (0 != m_source_id))
+			{
+				return;
+			}
+			m_percent = percent;
+			m_target = fade_target(percent);
+			m_phase = PHASE_FADE;
+			step();
+		}
+};
+
+typedef struct
+{
+	GMainLoop *main_loop;
+	scriptEvent *progress;
+	std::vector <downloadMachine *> *machines;
+	bool *scripts_done;
+	unsigned int num_pairs;
+	int percent;
+}benchContext_t;
+
+static gboolean progress_callback(gpointer data)
+{
+	benchContext_t *ctx = (benchContext_t *)data;
+	bool all_done = true;
+	for(unsigned int i = 0; i < ctx->num_pairs; i++)
+	{
+		all_done = all_done && ctx->scripts_done[i] && (*ctx->machines)[i]->isDone();
+	}
+	if(all_done)
+	{
+		g_main_loop_quit(ctx->main_loop);
+		return false;
+	}
+	if(100 > ctx->percent)
+	{
+		ctx->percent += 10;
+	}
+	ctx->progress->signal(ctx->percent);
+	for(unsigned int i = 0; i < ctx->num_pairs; i++)
+	{
+		(*ctx->machines)[i]->onProgress(ctx->percent);
+	}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int num_pairs = 4;
+	if((3 == argc) && (0 == strcmp(argv[1], "--pairs")))
+	{
+		num_pairs = strtoul(argv[2], NULL, 10);
+	}
+	if((0 == num_pairs) || (MAX_PAIRS < num_pairs))
+	{
+		printf("Usage: %s [--pairs <1-%u>]\n", argv[0], MAX_PAIRS);
+		return 1;
+	}
+
+	countingBackend backend;
+	std::vector <indicator *> script_leds, machine_leds;
+	std::vector <downloadMachine *> machines;
+	bool scripts_done[MAX_PAIRS] = {false};
+	scriptEvent progress;
+	for(unsigned int i = 0; i < num_pairs; i++)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "Script%u", i);
+		script_leds.push_back(new indicator(name, backend));
+		snprintf(name, sizeof(name), "Machine%u", i);
+		machine_leds.push_back(new indicator(name, backend));
+		machines.push_back(new downloadMachine(*machine_leds[i]));
+	}
+
+	GMainLoop *main_loop = g_main_loop_new(NULL, false);
+	for(unsigned int i = 0; i < num_pairs; i++)
+	{
+		if(0 != script_leds[i]->runScript(downloadScript(*script_leds[i], progress, scripts_done[i])))
+		{
+			printf("Could not start script %u\n", i);
+			return 1;
+		}
+		machines[i]->start();
+	}
+	benchContext_t ctx = {main_loop, &progress, &machines, scripts_done, num_pairs, 0};
+	g_timeout_add(PROGRESS_INTERVAL_MS, progress_callback, &ctx);
+	g_main_loop_run(main_loop);
+	g_main_loop_unref(main_loop);
+
+	unsigned int active_scripts, frame_size;
+	get_led_script_stats(active_scripts, frame_size);
+	int result = 0;
+	for(unsigned int i = 0; i < num_pairs; i++)
+	{
+		unsigned long long script_writes = backend.m_num_writes[2 * i];
+		unsigned long long machine_writes = backend.m_num_writes[(2 * i) + 1];
+		printf("pair %u: script %llu writes, state machine %llu writes%s\n", i, script_writes, machine_writes,
+			(script_writes == machine_writes) ? "" : "  MISMATCH");
+		result |= (script_writes != machine_writes);
+	}
+	printf("memory per running instance: script frame %u bytes (pool slot %u), state machine %u bytes\n",
+		frame_size, LED_SCRIPT_FRAME_SIZE, (unsigned int)sizeof(downloadMachine));
+	printf("heap allocations per await: script 0, state machine 0; scripts still running: %u\n", active_scripts);
+
+	for(unsigned int i = 0; i < num_pairs; i++)
+	{
+		delete machines[i];
+		delete machine_leds[i];
+		delete script_leds[i];
+	}
+	return result;
+}
@@ -0,0 +1,236 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/*Checks the deep-sleep suspend of the animation engine on the OEM indicators: a 300/300 ms blink runs
+ * next to a spinning indicator group, the box enters deep sleep mid-keyframe, a flare is requested while
+ * asleep, and the box wakes up again. Passes if every group member was switched off for deep sleep, if no
+ * LED timer fired and nothing was written to the front panel while asleep, if the blink resumed at the
+ * phase it was suspended at, and if the group members were switched back on.
+ *
+ * Usage: ledmgr_sleepcheck [--indicator <name>] [--sleep <s>]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <glib.h>
+
+#include "pwrMgr.h"
+#include "ledmgr_types.hpp"
+#include "ledmgr.hpp"
+#include "ledtiming.hpp"
+#include "eventrecorder.hpp"
+#include "standin.hpp"
+
+#define KEYFRAME_MS 300
+#define SUSPEND_AT_MS ((3 * KEYFRAME_MS) + (KEYFRAME_MS / 2))	/**< Mid-keyframe */
+#define SETTLE_MS 1000
+#define PHASE_TOLERANCE_MS 20
+#define GROUP_SIZE 8
+
+static const keyframe_t g_blink_keyframes[] = {
+	{KEYFRAME_MS, KEYFRAME_ON, KEYFRAME_COLOR_KEEP, EASING_STEP},
+	{KEYFRAME_MS, KEYFRAME_OFF, KEYFRAME_COLOR_KEEP, EASING_STEP},
+};
+static const keyframePattern_t g_blink = {0xF0, 2, g_blink_keyframes, 0, NULL};
+
+typedef enum
+{
+	STEP_SUSPEND = 0,
+	STEP_FLARE,
+	STEP_RESUME,
+	STEP_CHECK,
+}sleepCheckStep_t;
+
+typedef struct
+{
+	GMainLoop *main_loop;
+	indicator *target;
+	int group_handles[GROUP_SIZE];
+	unsigned int sleep_ms;
+	sleepCheckStep_t step;
+	uint64_t last_edge_us;
+	uint64_t suspend_us;
+	uint64_t resume_us;
+	unsigned long long writes_at_suspend;
+	bool passed;
+}sleepCheck_t;
+
+/*Time of the last state write at or before the given time, 0 if there is none.*/
+static uint64_t find_edge(const std::vector <ledTransition_t> &timeline, uint64_t before_us, uint64_t after_us)
+{
+	uint64_t edge_us = 0;
+	for(size_t i = 0; i < timeline.size(); i++)
+	{
+		const ledTransition_t &transition = timeline[i];
+		if((LED_ATTRIBUTE_STATE != transition.attribute) || (transition.timestamp_us > before_us))
+		{
+			continue;
+		}
+		if(0 == after_us)
+		{
+			edge_us = transition.timestamp_us;
+		}
+		else if(transition.timestamp_us > after_us)
+		{
+			return transition.timestamp_us;
+		}
+	}
+	return edge_us;
+}
+
+/*Whether the last state written to every group member, after the given time, is the expected one.*/
+static bool group_in_state(const std::vector <ledTransition_t> &timeline, const int *handles, uint64_t after_us, bool lit)
+{
+	for(unsigned int member = 0; member < GROUP_SIZE; member++)
+	{
+		bool found = false;
+		bool member_lit = false;
+		for(size_t i = 0; i < timeline.size(); i++)
+		{
+			const ledTransition_t &transition = timeline[i];
+			if((handles[member] == transition.handle) && (LED_ATTRIBUTE_STATE == transition.attribute) && (transition.timestamp_us >= after_us))
+			{
+				found = true;
+				member_lit = (0 != transition.value);
+			}
+		}
+		if(!found || (lit != member_lit))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static gboolean step_callback(gpointer data)
+{
+	sleepCheck_t *check = (sleepCheck_t *)data;
+	ledMgr &mgr = ledMgr::getInstance();
+	std::vector <ledTransition_t> timeline;
+	switch(check->step)
+	{
+		case STEP_SUSPEND:
+			getStandinBackend().getTimeline(timeline);
+			check->last_edge_us = find_edge(timeline, get_monotonic_time_us(), 0);
+			check->suspend_us = get_monotonic_time_us();
+			mgr.setPowerState(IARM_BUS_PWRMGR_POWERSTATE_STANDBY_DEEP_SLEEP);
+			check->writes_at_suspend = getStandinBackend().getWriteCount();
+			getStandinBackend().getTimeline(timeline);
+			check->passed = group_in_state(timeline, check->group_handles, check->suspend_us, false);
+			printf("group switched off for deep sleep - %s\n", (check->passed ? "PASS" : "FAIL"));
+			reset_led_timing_stats();
+			check->step = STEP_FLARE;
+			g_timeout_add(check->sleep_ms / 2, step_callback, check);
+			break;
+		case STEP_FLARE:
+			/*Arms a timer and writes while asleep; neither may reach the timers or the panel.*/
+			check->target->executeFlare(20, 100);
+			check->step = STEP_RESUME;
+			g_timeout_add(check->sleep_ms - (check->sleep_ms / 2), step_callback, check);
+			break;
+		case STEP_RESUME:
+		{
+			ledTimingStats_t stats;
+			get_led_timing_stats(stats);
+			unsigned long long writes = getStandinBackend().getWriteCount() - check->writes_at_suspend;
+			bool quiet = (0 == stats.dispatched) && (0 == writes);
+			printf("asleep %u ms: %llu LED timer wakeups, %llu front panel writes - %s\n", check->sleep_ms,
+				stats.dispatched, writes, (quiet ? "PASS" : "FAIL"));
+			check->passed = check->passed && quiet;
+			check->resume_us = get_monotonic_time_us();
+			mgr.setPowerState(IARM_BUS_PWRMGR_POWERSTATE_ON);
+			check->step = STEP_CHECK;
+			g_timeout_add(SETTLE_MS, step_callback, check);
+			break;
+		}
+		default:
+		{
+			/*resumeOutput() rewrites the state straight away; the first edge after that is the blink.*/
+			getStandinBackend().getTimeline(timeline);
+			uint64_t first_edge_us = find_edge(timeline, get_monotonic_time_us(), check->resume_us + 1000);
+			long expected_ms = KEYFRAME_MS - (long)((check->suspend_us - check->last_edge_us) / 1000);
+			long actual_ms = (0 != first_edge_us) ? (long)((first_edge_us - check->resume_us) / 1000) : -1;
+			bool in_phase = (0 != check->last_edge_us) && (0 <= actual_ms) && (PHASE_TOLERANCE_MS >= labs(actual_ms - expected_ms));
+			printf("first edge after wake-up: %ld ms, %ld ms expected - %s\n", actual_ms, expected_ms, (in_phase ? "PASS" : "FAIL"));
+			bool group_lit = group_in_state(timeline, check->group_handles, check->resume_us, true);
+			printf("group switched back on after wake-up - %s\n", (group_lit ? "PASS" : "FAIL"));
+			check->passed = check->passed && in_phase && group_lit;
+			g_main_loop_quit(check->main_loop);
+			break;
+		}
+	}
+	return false;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *indicator_name = "Power";
+	unsigned int sleep_s = 5;
+	for(int i = 1; i < argc; i++)
+	{
+		if((0 == strcmp(argv[i], "--indicator")) && (i + 1 < argc))
+		{
+			indicator_name = argv[++i];
+		}
+		else if((0 == strcmp(argv[i], "--sleep")) && (i + 1 < argc))
+		{
+			sleep_s = strtoul(argv[++i], NULL, 10);
+		}
+		else
+		{
+			printf("Usage: %s [--indicator <name>] [--sleep <s>]\n", argv[0]);
+			return -1;
+		}
+	}
+	if(0 == sleep_s)
+	{
+		sleep_s = 1;
+	}
+
+	ledMgr &mgr = ledMgr::getInstance();
+	mgr.createBlinkPatterns();
+	indicator *target = mgr.findIndicator(indicator_name);
+	if(NULL == target)
+	{
+		printf("No indicator %s\n", indicator_name);
+		return -1;
+	}
+	indicatorGroup &group = mgr.addIndicatorGroup("SleepCheckRing", "SleepCheckRing", GROUP_SIZE);
+	getStandinBackend().recordTimeline(true);
+	mgr.setPowerState(IARM_BUS_PWRMGR_POWERSTATE_ON);
+	target->setBlink(&g_blink);
+	group.start(GROUP_EFFECT_SPIN, 1000);
+
+	sleepCheck_t check;
+	memset(&check, 0, sizeof(check));
+	for(unsigned int i = 0; i < GROUP_SIZE; i++)
+	{
+		char member_name[64];
+		snprintf(member_name, sizeof(member_name), "SleepCheckRing%u", i);
+		check.group_handles[i] = getStandinBackend().open(member_name);
+	}
+	check.main_loop = g_main_loop_new(NULL, false);
+	check.target = target;
+	check.sleep_ms = sleep_s * 1000;
+	check.step = STEP_SUSPEND;
+	g_timeout_add(SUSPEND_AT_MS, step_callback, &check);
+	g_main_loop_run(check.main_loop);
+	g_main_loop_unref(check.main_loop);
+	return (check.passed ? 0 : 1);
+}
@@ -0,0 +1,259 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/*Contention stress harness for indicator and ledMgrBase. N producer threads call setBlink, setState,
+ * executeFlare, setError and setPowerState on the OEM indicators while the main loop services the
+ * pattern and flare timers. Reports throughput, per-operation latency percentiles and lock wait time.
+ *
+ * Usage: ledmgr_stress [--threads <N>] [--duration <s>] [--indicator <name>] [--seed <n>]
+ *
+ * Configure with --enable-tsan to build the tools with ThreadSanitizer.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <glib.h>
+#include <pthread.h>
+#include <vector>
+#include <algorithm>
+
+#include "pwrMgr.h"
+#include "ledmgr_types.hpp"
+#include "ledmgr.hpp"
+#include "lockstats.hpp"
+#include "standin.hpp"
+
+#define MAX_SAMPLES_PER_OP 200000	/**< Per thread; later samples are dropped, not the operations */
+
+typedef enum
+{
+	OP_SET_BLINK = 0,
+	OP_SET_STATE,
+	OP_EXECUTE_FLARE,
+	OP_SET_ERROR,
+	OP_SET_POWER_STATE,
+	OP_MAX,
+}stressOp_t;
+
+static const char * const g_op_names[OP_MAX] = {"setBlink", "setState", "executeFlare", "setError", "setPowerState"};
+
+typedef struct
+{
+	pthread_t thread;
+	unsigned int seed;
+	indicator *target;
+	volatile bool *stop;
+	unsigned long long num_ops[OP_MAX];
+	std::vector <unsigned int> latency_ns[OP_MAX];
+}producer_t;
+
+static unsigned long long now_ns()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((unsigned long long)now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+
+static void* producer_thread(void *arg)
+{
+	producer_t *producer = (producer_t *)arg;
+	ledMgr &mgr = ledMgr::getInstance();
+	static const int power_states[] = {IARM_BUS_PWRMGR_POWERSTATE_ON, IARM_BUS_PWRMGR_POWERSTATE_STANDBY,
+		IARM_BUS_PWRMGR_POWERSTATE_STANDBY_LIGHT_SLEEP};
+
+	while(!__atomic_load_n(producer->stop, __ATOMIC_RELAXED))
+	{
+		unsigned int dice = rand_r(&producer->seed);
+		stressOp_t op = (stressOp_t)(dice % OP_MAX);
+		unsigned int arg = dice / OP_MAX;
+
+		unsigned long long start = now_ns();
+		switch(op)
+		{
+			case OP_SET_BLINK:
+				producer->target->setBlink(mgr.getPattern((blinkPatternType_t)(arg % NUM_PATTERNS)), (0 == (arg & 0x8) ? -1 : 1 + (arg % 4)));
+				break;
+			case OP_SET_STATE:
+				producer->target->setState(0 == (arg & 0x1) ? STATE_STEADY_ON : STATE_STEADY_OFF);
+				break;
+			case OP_EXECUTE_FLARE:
+				producer->target->executeFlare(10, 5 + (arg % 20));
+				break;
+			case OP_SET_ERROR:
+				mgr.setError(arg % 4, (0 == (arg & 0x10)));
+				break;
+			case OP_SET_POWER_STATE:
+				mgr.setPowerState(power_states[arg % (sizeof(power_states) / sizeof(power_states[0]))]);
+				break;
+			default:
+				break;
+		}
+		unsigned long long elapsed = now_ns() - start;
+
+		producer->num_ops[op]++;
+		if(MAX_SAMPLES_PER_OP > producer->latency_ns[op].size())
+		{
+			producer->latency_ns[op].push_back(elapsed > 0xFFFFFFFFULL ? 0xFFFFFFFF : (unsigned int)elapsed);
+		}
+	}
+	return NULL;
+}
+
+static gboolean stop_callback(gpointer data)
+{
+	g_main_loop_quit((GMainLoop *)data);
+	return false;
+}
+
+static unsigned int percentile(const std::vector <unsigned int> &sorted, double fraction)
+{
+	if(sorted.empty())
+	{
+		return 0;
+	}
+	size_t index = (size_t)(fraction * (sorted.size() - 1));
+	return sorted[index];
+}
+
+static void print_lock_stats(const char *name, lockClass_t lock_class, double seconds)
+{
+	lockStats_t stats;
+	get_lock_stats(lock_class, &stats);
+	fprintf(stderr, "%-14s %12llu acquisitions, %10llu contended (%.2f%%), wait total %.3f ms (%.2f%% of run), avg %.1f us, max %.1f us\n",
+			name, stats.acquisitions, stats.contended,
+			(0 == stats.acquisitions ? 0.0 : 100.0 * stats.contended / stats.acquisitions),
+			stats.wait_time_ns / 1e6, 100.0 * stats.wait_time_ns / (seconds * 1e9),
+			(0 == stats.contended ? 0.0 : stats.wait_time_ns / 1e3 / stats.contended), stats.max_wait_ns / 1e3);
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [--threads <N>] [--duration <s>] [--indicator <name>] [--seed <n>]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int num_threads = 4;
+	unsigned int duration_s = 10;
+	unsigned int seed = 1;
+	const char *indicator_name = "Power";
+
+	for(int i = 1; i < argc; i++)
+	{
+		if((0 == strcmp(argv[i], "--threads")) && (i + 1 < argc))
+		{
+			num_threads = strtoul(argv[++i], NULL, 10);
+		}
+		else if((0 == strcmp(argv[i], "--duration")) && (i + 1 < argc))
+		{
+			duration_s = strtoul(argv[++i], NULL, 10);
+		}
+		else if((0 == strcmp(argv[i], "--indicator")) && (i + 1 < argc))
+		{
+			indicator_name = argv[++i];
+		}
+		else if((0 == strcmp(argv[i], "--seed")) && (i + 1 < argc))
+		{
+			seed = strtoul(argv[++i], NULL, 10);
+		}
+		else
+		{
+			usage(argv[0]);
+			return -1;
+		}
+	}
+	if(0 == num_threads)
+	{
+		usage(argv[0]);
+		return -1;
+	}
+
+	/*The logging on the hot paths would dominate the measurement; the report goes to stderr.*/
+	if(NULL == freopen("/dev/null", "w", stdout))
+	{
+		ERROR("Could not silence stdout!\n");
+	}
+	ledMgr &mgr = ledMgr::getInstance();
+	mgr.createBlinkPatterns();
+	indicator *target = mgr.findIndicator(indicator_name);
+	if(NULL == target)
+	{
+		fprintf(stderr, "No indicator %s\n", indicator_name);
+		return -1;
+	}
+
+	GMainLoop *main_loop = g_main_loop_new(NULL, false);
+	volatile bool stop = false;
+	std::vector <producer_t> producers(num_threads);
+	reset_lock_stats();
+	unsigned long long start = now_ns();
+	for(unsigned int i = 0; i < num_threads; i++)
+	{
+		producer_t &producer = producers[i];
+		producer.seed = seed + i;
+		producer.target = target;
+		producer.stop = &stop;
+		memset(producer.num_ops, 0, sizeof(producer.num_ops));
+		for(int op = 0; op < OP_MAX; op++)
+		{
+			producer.latency_ns[op].reserve(MAX_SAMPLES_PER_OP);
+		}
+		if(0 != pthread_create(&producer.thread, NULL, producer_thread, &producer))
+		{
+			fprintf(stderr, "Could not launch producer %u\n", i);
+			return -1;
+		}
+	}
+
+	g_timeout_add(duration_s * 1000, stop_callback, main_loop);
+	g_main_loop_run(main_loop);
+	__atomic_store_n(&stop, true, __ATOMIC_RELAXED);
+	for(unsigned int i = 0; i < num_threads; i++)
+	{
+		pthread_join(producers[i].thread, NULL);
+	}
+	double seconds = (now_ns() - start) / 1e9;
+	g_main_loop_unref(main_loop);
+
+	unsigned long long total_ops = 0;
+	fprintf(stderr, "%u producers, %.2f s\n", num_threads, seconds);
+	fprintf(stderr, "%-14s %12s %12s %10s %10s %10s %10s %10s\n", "operation", "count", "ops/s", "p50 us", "p90 us", "p99 us", "p99.9 us", "max us");
+	for(int op = 0; op < OP_MAX; op++)
+	{
+		unsigned long long count = 0;
+		std::vector <unsigned int> samples;
+		for(unsigned int i = 0; i < num_threads; i++)
+		{
+			count += producers[i].num_ops[op];
+			samples.insert(samples.end(), producers[i].latency_ns[op].begin(), producers[i].latency_ns[op].end());
+		}
+		std::sort(samples.begin(), samples.end());
+		total_ops += count;
+		fprintf(stderr, "%-14s %12llu %12.0f %10.1f %10.1f %10.1f %10.1f %10.1f\n", g_op_names[op], count, count / seconds,
+				percentile(samples, 0.5) / 1e3, percentile(samples, 0.9) / 1e3, percentile(samples, 0.99) / 1e3,
+				percentile(samples, 0.999) / 1e3, (samples.empty() ? 0 : samples.back()) / 1e3);
+	}
+	fprintf(stderr, "Total: %llu ops, %.0f ops/s, %llu LED writes\n", total_ops, total_ops / seconds, getStandinBackend().getWriteCount());
+	print_lock_stats("indicator", LOCK_CLASS_INDICATOR, seconds);
+	print_lock_stats("ledMgrBase", LOCK_CLASS_LEDMGRBASE, seconds);
+	print_lock_stats("patternStore", LOCK_CLASS_PATTERNSTORE, seconds);
+	print_lock_stats("syncGroup", LOCK_CLASS_SYNCGROUP, seconds);
+	print_lock_stats("indicatorGroup", LOCK_CLASS_INDICATORGROUP, seconds);
+	return 0;
+}
@@ -0,0 +1,34 @@
+#!/bin/sh
+##########################################################################
+# If not stated otherwise in this file or this component's Licenses.txt
+# file the following copyright and licenses apply:
+#
+# Copyright 2016 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# Runs the main loop comparison: the same blink scenario on each loopbench binary given, one line each.
+# A few runs per binary, as startup time in particular is noisy.
+#
+# Usage: loopcompare.sh <seconds> <binary>...
+
+SECONDS_PER_RUN=$1
+shift
+
+header=--header
+for run in 1 2 3; do
+	for binary in "$@"; do
+		output=$("$binary" --seconds "$SECONDS_PER_RUN" --started-ns "$(date +%s%N)" $header) || exit 1
+		echo "$output" | grep -E '^(loop|glib|epoll) '	# Leaves out the engine's log
+		header=
+	done
+done
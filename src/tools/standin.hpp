@@ -0,0 +1,95 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef STANDIN_H
+#define STANDIN_H
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+#include <string>
+#include <pthread.h>
+#include "libIBus.h"
+#include "ledbackend.hpp"
+
+/*Stand-ins for the IARM bus and the front panel, used by the offline tools so that the event
+ * handlers, ledMgrBase, indicator and the OEM logic can run without iarmbusd, sysmgr, pwrmgr,
+ * irmgr or dsmgr.*/
+
+/**
+ * @addtogroup LED_TYPES
+ * @{
+ */
+typedef enum
+{
+	LED_ATTRIBUTE_STATE = 0,
+	LED_ATTRIBUTE_BRIGHTNESS,
+	LED_ATTRIBUTE_COLOR,
+}ledAttribute_t;
+
+typedef struct
+{
+	uint64_t timestamp_us;
+	int handle;
+	ledAttribute_t attribute;
+	unsigned int value;
+}ledTransition_t;
+
+/* @} */ // End of group LED_TYPES
+
+/* Delivers an event to the handler registered for it. Returns the number of handlers invoked,
+ * i.e. 0 when the event class is not subscribed.*/
+int standin_bus_deliver(const char *owner, IARM_EventId_t event_id, void *data, size_t len);
+/* Invokes a registered RPC. Returns -1 if nothing is registered under that name.*/
+int standin_bus_call(const char *method, void *arg);
+void standin_bus_set_power_state(int state);
+
+class standinBackend : public ledBackend
+{
+	private:
+		pthread_mutex_t m_mutex;
+		int m_num_handles;
+		std::string m_names[MAX_LED_HANDLES];
+		bool m_state[MAX_LED_HANDLES];
+		unsigned int m_brightness[MAX_LED_HANDLES];
+		unsigned int m_color[MAX_LED_HANDLES];
+		bool m_record_timeline;
+		std::vector <ledTransition_t> m_timeline;
+		unsigned long long m_num_writes;
+
+	public:
+		standinBackend();
+		~standinBackend();
+		virtual int open(const std::string &name);
+		virtual int setState(int handle, bool enable);
+		virtual int setBrightness(int handle, unsigned int intensity);
+		virtual int getBrightness(int handle, unsigned int &intensity);
+		virtual int setColor(int handle, unsigned int color);
+		virtual int getColor(int handle, unsigned int &color);
+
+		void recordTimeline(bool enable);
+		void printTimeline(FILE *out, uint64_t origin_us);
+		void getTimeline(std::vector <ledTransition_t> &timeline);
+		unsigned long long getWriteCount();
+	private:
+		bool isValid(int handle) const;
+		void record(int handle, ledAttribute_t attribute, unsigned int value);
+};
+
+standinBackend& getStandinBackend();
+
+#endif /*STANDIN_H*/
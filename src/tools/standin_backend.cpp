@@ -0,0 +1,200 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "ledmgr_types.hpp"
+#include "eventrecorder.hpp"
+#include "standin.hpp"
+
+/*Front panel stand-in. Keeps the last written value of every attribute and, when enabled,
+ * a timeline of every write.*/
+
+standinBackend::standinBackend()
+{
+	m_num_handles = 0;
+	m_record_timeline = false;
+	m_num_writes = 0;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_init(&m_mutex, NULL));
+}
+
+standinBackend::~standinBackend()
+{
+	pthread_mutex_destroy(&m_mutex);
+}
+
+bool standinBackend::isValid(int handle) const
+{
+	return ((0 <= handle) && (m_num_handles > handle));
+}
+
+void standinBackend::record(int handle, ledAttribute_t attribute, unsigned int value)
+{
+	m_num_writes++;
+	if(m_record_timeline)
+	{
+		ledTransition_t transition = {get_monotonic_time_us(), handle, attribute, value};
+		m_timeline.push_back(transition);
+	}
+}
+
+int standinBackend::open(const std::string &name)
+{
+	int handle = -1;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	for(int i = 0; i < m_num_handles; i++)
+	{
+		if(name == m_names[i])
+		{
+			handle = i;
+			break;
+		}
+	}
+	if((-1 == handle) && (MAX_LED_HANDLES > m_num_handles))
+	{
+		handle = m_num_handles++;
+		m_names[handle] = name;
+		m_state[handle] = false;
+		m_brightness[handle] = 100;
+		m_color[handle] = 0;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return handle;
+}
+
+int standinBackend::setState(int handle, bool enable)
+{
+	int ret = -1;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	if(isValid(handle))
+	{
+		m_state[handle] = enable;
+		record(handle, LED_ATTRIBUTE_STATE, enable);
+		ret = 0;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return ret;
+}
+
+int standinBackend::setBrightness(int handle, unsigned int intensity)
+{
+	int ret = -1;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	if(isValid(handle))
+	{
+		m_brightness[handle] = intensity;
+		record(handle, LED_ATTRIBUTE_BRIGHTNESS, intensity);
+		ret = 0;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return ret;
+}
+
+int standinBackend::getBrightness(int handle, unsigned int &intensity)
+{
+	int ret = -1;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	if(isValid(handle))
+	{
+		intensity = m_brightness[handle];
+		ret = 0;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return ret;
+}
+
+int standinBackend::setColor(int handle, unsigned int color)
+{
+	int ret = -1;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	if(isValid(handle))
+	{
+		m_color[handle] = color;
+		record(handle, LED_ATTRIBUTE_COLOR, color);
+		ret = 0;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return ret;
+}
+
+int standinBackend::getColor(int handle, unsigned int &color)
+{
+	int ret = -1;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	if(isValid(handle))
+	{
+		color = m_color[handle];
+		ret = 0;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return ret;
+}
+
+void standinBackend::recordTimeline(bool enable)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	m_record_timeline = enable;
+	if(enable)
+	{
+		m_timeline.reserve(1 << 16);
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+/**
+ * @brief Prints every recorded write relative to the given origin.
+ */
+void standinBackend::printTimeline(FILE *out, uint64_t origin_us)
+{
+	static const char * const attribute_names[] = {"state", "brightness", "color"};
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	fprintf(out, "LED timeline (%zu transitions):\n", m_timeline.size());
+	for(size_t i = 0; i < m_timeline.size(); i++)
+	{
+		const ledTransition_t &transition = m_timeline[i];
+		uint64_t offset_us = transition.timestamp_us - origin_us;
+		fprintf(out, "  +%llu.%06llus %-12s %-10s 0x%x\n", (unsigned long long)(offset_us / 1000000),
+				(unsigned long long)(offset_us % 1000000), m_names[transition.handle].c_str(),
+				attribute_names[transition.attribute], transition.value);
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+void standinBackend::getTimeline(std::vector <ledTransition_t> &timeline)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	timeline = m_timeline;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+}
+
+unsigned long long standinBackend::getWriteCount()
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&m_mutex));
+	unsigned long long writes = m_num_writes;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&m_mutex));
+	return writes;
+}
+
+standinBackend& getStandinBackend()
+{
+	static standinBackend backend;
+	return backend;
+}
+
+ledBackend& getDefaultLedBackend()
+{
+	return getStandinBackend();
+}
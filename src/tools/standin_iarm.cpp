@@ -0,0 +1,170 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2016 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <string.h>
+#include "pwrMgr.h"
+#include "ledmgr_types.hpp"
+#include "standin.hpp"
+
+/*Link-time replacement for libIBus. Handlers are kept in a small table and invoked directly.*/
+
+#define MAX_STANDIN_HANDLERS 32
+
+typedef struct
+{
+	const char *owner;
+	IARM_EventId_t event_id;
+	IARM_EventHandler_t handler;
+}standinEventHandler_t;
+
+typedef struct
+{
+	const char *method;
+	IARM_BusCall_t handler;
+}standinCall_t;
+
+static pthread_mutex_t g_standin_mutex = PTHREAD_MUTEX_INITIALIZER;
+static standinEventHandler_t g_handlers[MAX_STANDIN_HANDLERS];
+static int g_num_handlers = 0;
+static standinCall_t g_calls[MAX_STANDIN_HANDLERS];
+static int g_num_calls = 0;
+static int g_power_state = IARM_BUS_PWRMGR_POWERSTATE_ON;
+
+IARM_Result_t IARM_Bus_Init(const char *name)
+{
+	return IARM_RESULT_SUCCESS;
+}
+
+IARM_Result_t IARM_Bus_Connect(void)
+{
+	return IARM_RESULT_SUCCESS;
+}
+
+IARM_Result_t IARM_Bus_Disconnect(void)
+{
+	return IARM_RESULT_SUCCESS;
+}
+
+IARM_Result_t IARM_Bus_Term(void)
+{
+	return IARM_RESULT_SUCCESS;
+}
+
+IARM_Result_t IARM_Bus_RegisterEventHandler(const char *ownerName, IARM_EventId_t eventId, IARM_EventHandler_t handler)
+{
+	IARM_Result_t ret = IARM_RESULT_OOM;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_standin_mutex));
+	if(MAX_STANDIN_HANDLERS > g_num_handlers)
+	{
+		g_handlers[g_num_handlers].owner = ownerName;
+		g_handlers[g_num_handlers].event_id = eventId;
+		g_handlers[g_num_handlers].handler = handler;
+		g_num_handlers++;
+		ret = IARM_RESULT_SUCCESS;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_standin_mutex));
+	return ret;
+}
+
+IARM_Result_t IARM_Bus_UnRegisterEventHandler(const char *ownerName, IARM_EventId_t eventId)
+{
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_standin_mutex));
+	for(int i = 0; i < g_num_handlers; i++)
+	{
+		if((0 == strcmp(ownerName, g_handlers[i].owner)) && (eventId == g_handlers[i].event_id))
+		{
+			g_handlers[i] = g_handlers[--g_num_handlers];
+			break;
+		}
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_standin_mutex));
+	return IARM_RESULT_SUCCESS;
+}
+
+IARM_Result_t IARM_Bus_RegisterCall(const char *methodName, IARM_BusCall_t handler)
+{
+	IARM_Result_t ret = IARM_RESULT_OOM;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_standin_mutex));
+	if(MAX_STANDIN_HANDLERS > g_num_calls)
+	{
+		g_calls[g_num_calls].method = methodName;
+		g_calls[g_num_calls].handler = handler;
+		g_num_calls++;
+		ret = IARM_RESULT_SUCCESS;
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_standin_mutex));
+	return ret;
+}
+
+IARM_Result_t IARM_Bus_Call(const char *ownerName, const char *methodName, void *arg, size_t argLen)
+{
+	if((0 == strcmp(ownerName, IARM_BUS_PWRMGR_NAME)) && (0 == strcmp(methodName, "GetPowerState")))
+	{
+		((IARM_Bus_PWRMgr_GetPowerState_Param_t *)arg)->curState = (IARM_Bus_PowerState_t)g_power_state;
+		return IARM_RESULT_SUCCESS;
+	}
+	return IARM_RESULT_INVALID_STATE;
+}
+
+int standin_bus_deliver(const char *owner, IARM_EventId_t event_id, void *data, size_t len)
+{
+	IARM_EventHandler_t handler = NULL;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_standin_mutex));
+	for(int i = 0; i < g_num_handlers; i++)
+	{
+		if((0 == strcmp(owner, g_handlers[i].owner)) && (event_id == g_handlers[i].event_id))
+		{
+			handler = g_handlers[i].handler;
+			break;
+		}
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_standin_mutex));
+
+	if(NULL == handler)
+	{
+		return 0;
+	}
+	handler(owner, event_id, data, len);
+	return 1;
+}
+
+int standin_bus_call(const char *method, void *arg)
+{
+	IARM_BusCall_t handler = NULL;
+	REPORT_IF_UNEQUAL(0, pthread_mutex_lock(&g_standin_mutex));
+	for(int i = 0; i < g_num_calls; i++)
+	{
+		if(0 == strcmp(method, g_calls[i].method))
+		{
+			handler = g_calls[i].handler;
+			break;
+		}
+	}
+	REPORT_IF_UNEQUAL(0, pthread_mutex_unlock(&g_standin_mutex));
+
+	if(NULL == handler)
+	{
+		return -1;
+	}
+	return (IARM_RESULT_SUCCESS == handler(arg) ? 0 : -1);
+}
+
+void standin_bus_set_power_state(int state)
+{
+	g_power_state = state;
+}